@@ -10,9 +10,84 @@
 #include "hud_elements.h"
 #include "logging.h"
 #include "mesa/util/macros.h"
+#include "mesa/util/os_time.h"
 
 
 #define IS_VALID_METRIC(FIELD) (FIELD != 0xffff)
+#define VALID_METRIC_OR_ZERO(FIELD) (IS_VALID_METRIC(FIELD) ? FIELD : 0)
+
+// needs_dividing comes from amdgpu_get_activity_unit(), it's only
+// detected from the readings for firmwares of unknown unit
+static uint16_t activity_percent(uint16_t value, bool &needs_dividing, amdgpu_activity_unit unit) {
+	if (!IS_VALID_METRIC(value))
+		return 0;
+	if (unit == AMDGPU_ACTIVITY_UNKNOWN && value > 100)
+		needs_dividing = true;
+	return needs_dividing ? value / 100 : value;
+}
+
+// The tables carry the activities as the SMU firmware reports them. The
+// kernel divides them by 100 for its own sensors on the firmwares below
+// that report centipercent, but not in gpu_metrics.
+static amdgpu_activity_unit amdgpu_get_activity_unit(const struct metrics_table_header &header,
+                                                     uint32_t device_id) {
+	switch (header.format_revision) {
+	case 1:
+		// dGPU firmwares
+		return AMDGPU_ACTIVITY_PERCENT;
+	case 2:
+		// Yellow Carp and SMU 13.0.4/13.0.5 are the only v2.1 tables
+		if (header.content_revision == 1)
+			return AMDGPU_ACTIVITY_CENTIPERCENT;
+
+		switch (device_id) {
+		case 0x1636: // Renoir
+		case 0x1638: // Cezanne
+		case 0x164c: // Lucienne
+			return AMDGPU_ACTIVITY_CENTIPERCENT;
+		case 0x1435: // Van Gogh
+		case 0x163f:
+			return AMDGPU_ACTIVITY_PERCENT;
+		}
+		break;
+	}
+
+	return AMDGPU_ACTIVITY_UNKNOWN;
+}
+
+template<typename T, size_t N>
+static uint16_t amdgpu_get_apu_cores(struct amdgpu_common_metrics *metrics,
+                                     const T (&temps)[N], const T (&clocks)[N]) {
+	uint16_t count = 0;
+	for (size_t i = 0; i < N && i < GPU_METRICS_MAX_APU_CORES; i++) {
+		if (!IS_VALID_METRIC(temps[i]) && !IS_VALID_METRIC(clocks[i]))
+			break;
+
+		metrics->apu_core_temp_c[i] = VALID_METRIC_OR_ZERO(temps[i]) / 100;
+		metrics->apu_core_clock_mhz[i] = VALID_METRIC_OR_ZERO(clocks[i]);
+		count++;
+	}
+	return count;
+}
+
+static bool amdgpu_read_metrics_header(const std::string& path, struct metrics_table_header *header) {
+	FILE *f = fopen(path.c_str(), "rb");
+	if (!f)
+		return false;
+
+	size_t nread = fread(header, sizeof(*header), 1, f);
+	fclose(f);
+	return nread == 1;
+}
+
+bool amdgpu_metrics_is_apu(const std::string& pci_dev) {
+	struct metrics_table_header header {};
+	const std::string path = "/sys/bus/pci/devices/" + pci_dev + "/gpu_metrics";
+
+	return amdgpu_read_metrics_header(path, &header) &&
+	       (header.format_revision == 2 || header.format_revision == 3);
+}
+
 void AMDGPU::get_instant_metrics(struct amdgpu_common_metrics *metrics) {
 	FILE *f;
 	uint8_t buf[sizeof(struct gpu_metrics_v3_0)+1];  // big enough for v1.3/v2.4/v3.0
@@ -43,6 +118,7 @@ void AMDGPU::get_instant_metrics(struct amdgpu_common_metrics *metrics) {
 		// Desktop GPUs
 		struct gpu_metrics_v1_3 *amdgpu_metrics = (struct gpu_metrics_v1_3 *) buf;
 		metrics->gpu_load_percent = amdgpu_metrics->average_gfx_activity;
+		metrics->has_accumulators = amdgpu_get_accumulators(buf, nread, &metrics->accumulators);
 
 		metrics->average_gfx_power_w = amdgpu_metrics->average_socket_power;
 
@@ -52,6 +128,14 @@ void AMDGPU::get_instant_metrics(struct amdgpu_common_metrics *metrics) {
 		metrics->gpu_temp_c = amdgpu_metrics->temperature_edge;
 		metrics->fan_speed = amdgpu_metrics->current_fan_speed;
 
+		metrics->hotspot_temp_c = VALID_METRIC_OR_ZERO(amdgpu_metrics->temperature_hotspot);
+		metrics->mem_temp_c = VALID_METRIC_OR_ZERO(amdgpu_metrics->temperature_mem);
+		metrics->mem_load_percent = activity_percent(amdgpu_metrics->average_umc_activity, mem_load_needs_dividing, activity_unit);
+		metrics->mm_activity_percent = activity_percent(amdgpu_metrics->average_mm_activity, mm_activity_needs_dividing, activity_unit);
+		metrics->pcie_link_width = VALID_METRIC_OR_ZERO(amdgpu_metrics->pcie_link_width);
+		metrics->pcie_link_speed = VALID_METRIC_OR_ZERO(amdgpu_metrics->pcie_link_speed);
+		metrics->indep_throttle_status = amdgpu_metrics->indep_throttle_status;
+
 		uint64_t indep = amdgpu_metrics->indep_throttle_status;
 		// RDNA 3 almost always shows the TEMP_HOTSPOT throtting flag,
 		// so clear that bit
@@ -61,14 +145,15 @@ void AMDGPU::get_instant_metrics(struct amdgpu_common_metrics *metrics) {
 		is_current = ((indep >> 16) & 0xFF) != 0;
 		is_temp    = ((indep >> 32) & 0xFFFF) != 0;
 		is_other   = ((indep >> 56) & 0xFF) != 0;
-		if (throttling)
-			throttling->indep_throttle_status = indep;
 	} else if (header->format_revision == 2) {
 		// APUs
 		this->is_apu = true;
 		struct gpu_metrics_v2_3 *amdgpu_metrics = (struct gpu_metrics_v2_3 *) buf;
 
 		metrics->gpu_load_percent = amdgpu_metrics->average_gfx_activity;
+		metrics->mm_activity_percent = activity_percent(amdgpu_metrics->average_mm_activity, mm_activity_needs_dividing, activity_unit);
+		metrics->apu_core_count = amdgpu_get_apu_cores(metrics, amdgpu_metrics->temperature_core,
+		                                               amdgpu_metrics->current_coreclk);
 
 		metrics->average_gfx_power_w = amdgpu_metrics->average_gfx_power / 1000.f;
 
@@ -145,8 +230,7 @@ void AMDGPU::get_instant_metrics(struct amdgpu_common_metrics *metrics) {
 			is_current = ((indep >> 16) & 0xFF) != 0;
 			is_temp    = ((indep >> 32) & 0xFFFF) != 0;
 			is_other   = ((indep >> 56) & 0xFF) != 0;
-		if (throttling)
-				throttling->indep_throttle_status = indep;
+			metrics->indep_throttle_status = indep;
 		}
 	} else if (header->format_revision == 3) {
 		this->is_apu = true;
@@ -164,8 +248,11 @@ void AMDGPU::get_instant_metrics(struct amdgpu_common_metrics *metrics) {
 			cpu_temp = MAX(cpu_temp, amdgpu_metrics->temperature_core[i]);
 		}
 		metrics->apu_cpu_temp_c = cpu_temp / 100;
+		metrics->apu_core_count = amdgpu_get_apu_cores(metrics, amdgpu_metrics->temperature_core,
+		                                               amdgpu_metrics->current_coreclk);
 
 		metrics->gpu_load_percent = amdgpu_metrics->average_gfx_activity;
+		metrics->mm_activity_percent = activity_percent(amdgpu_metrics->average_vcn_activity, mm_activity_needs_dividing, activity_unit);
 		// average_apu_power includes gfx_power so remove that from cpu_power
 		int64_t apu_power = amdgpu_metrics->average_apu_power;
 		int64_t gfx_power = amdgpu_metrics->average_gfx_power;
@@ -174,44 +261,10 @@ void AMDGPU::get_instant_metrics(struct amdgpu_common_metrics *metrics) {
 		metrics->average_gfx_power_w = amdgpu_metrics->average_gfx_power / 1000.0;
 		metrics->current_gfxclk_mhz = amdgpu_metrics->average_gfxclk_frequency;
 		metrics->current_uclk_mhz = amdgpu_metrics->average_uclk_frequency;
-		
-		if (previous_metrics.common_header.structure_size == 0) {
-			previous_metrics = *amdgpu_metrics;
-			is_temp = false;
-			is_power = false;
-			is_current = false;
-			is_other = false;
-			if (throttling) {
-				throttling->use_v3 = true;
-				throttling->v3_power.store(false);
-				throttling->v3_thermal.store(false);
-			}
-			return;	
-		} else {
-			uint32_t d_thm_core = V3_THROTTLING_DELTA(thm_core);
-			uint32_t d_thm_gfx  = V3_THROTTLING_DELTA(thm_gfx);
-			uint32_t d_thm_soc  = V3_THROTTLING_DELTA(thm_soc);
-			uint32_t d_spl      = V3_THROTTLING_DELTA(spl);
-			uint32_t d_fppt     = V3_THROTTLING_DELTA(fppt);
-			uint32_t d_sppt     = V3_THROTTLING_DELTA(sppt);
-			uint32_t d_prochot  = V3_THROTTLING_DELTA(prochot);
-			is_temp = (d_thm_core | d_thm_gfx | d_thm_soc | d_prochot) > 0;
-			is_power = (d_spl | d_fppt | d_sppt) > 0;
-			// there is no current throttling flags in v3_0
-			is_current = false;
-			// also no "other" throttling in v3_0
-			is_other = false;
-
-			previous_metrics = *amdgpu_metrics;
-
-			if (throttling) {
-				throttling->use_v3 = true;
-				// we only check spl, this attempts to match how we handle it in v1 and v2
-				// as close as we can
-				throttling->v3_power.store(d_spl > 0);
-				throttling->v3_thermal.store(is_temp);
-			}
-		}
+
+		// throttling is decided from the residency counters over the whole
+		// update period, see amdgpu_apply_accumulated()
+		metrics->has_accumulators = amdgpu_get_accumulators(buf, nread, &metrics->accumulators);
 	}
 
 	/* Throttling: See
@@ -223,22 +276,37 @@ void AMDGPU::get_instant_metrics(struct amdgpu_common_metrics *metrics) {
 	metrics->is_other_throttled   = is_other;
 }
 
+// Polls until the accumulators are usable, or for one update period when
+// they only failed once
 void AMDGPU::get_samples_and_copy(struct amdgpu_common_metrics metrics_buffer[METRICS_SAMPLE_COUNT], bool &gpu_load_needs_dividing) {
-	while (!stop_thread) {
+	do {
+		sampler.apply_requested_period();
+		const size_t sample_count = sampler.samples_per_update();
+		const int poll_period_ms = sampler.poll_period_ms();
+
 		// Get all the samples
-		for (size_t cur_sample_id=0; cur_sample_id < METRICS_SAMPLE_COUNT; cur_sample_id++) {
+		for (size_t cur_sample_id=0; cur_sample_id < sample_count; cur_sample_id++) {
 			if (gpu_metrics_is_valid)
 				get_instant_metrics(&metrics_buffer[cur_sample_id]);
 
 			// Detect and fix if the gpu load is reported in centipercent
-			if (gpu_load_needs_dividing || metrics_buffer[cur_sample_id].gpu_load_percent > 100){
+			if (gpu_load_needs_dividing ||
+			    (activity_unit == AMDGPU_ACTIVITY_UNKNOWN && metrics_buffer[cur_sample_id].gpu_load_percent > 100)){
 				gpu_load_needs_dividing = true;
 				metrics_buffer[cur_sample_id].gpu_load_percent /= 100;
 			}
 
-			usleep(METRICS_POLLING_PERIOD_MS * 1000);
+			const struct amdgpu_common_metrics &sample = metrics_buffer[cur_sample_id];
+			sampler.add_sample({ float(sample.gpu_load_percent), sample.average_gfx_power_w,
+			                     float(sample.gpu_temp_c),
+			                     uint64_t(sample.is_power_throttled) | sample.is_current_throttled << 1 |
+			                     sample.is_temp_throttled << 2 | sample.is_other_throttled << 3 });
+			usleep(poll_period_ms * 1000);
 		}
 
+		if (sampler.end_update())
+			SPDLOG_DEBUG("amdgpu: polling every {} ms ({:.1f} Hz)", sampler.poll_period_ms(), sampler.rate_hz());
+
 		if (stop_thread) break;
 
         std::unique_lock<std::mutex> lock(metrics_mutex);
@@ -249,10 +317,12 @@ void AMDGPU::get_samples_and_copy(struct amdgpu_common_metrics metrics_buffer[ME
 
 #ifndef TEST_ONLY
 		metrics.proc_vram_used = fdinfo_helper->amdgpu_helper_get_proc_vram();
+		fdinfo_helper->get_engine_loads(&metrics);
 #endif
 
 		if (gpu_metrics_is_valid) {
 			UPDATE_METRIC_AVERAGE(gpu_load_percent);
+			UPDATE_METRIC_AVERAGE(mem_load_percent);
 			UPDATE_METRIC_AVERAGE_FLOAT(average_gfx_power_w);
 			UPDATE_METRIC_AVERAGE_FLOAT(average_cpu_power_w);
 
@@ -269,53 +339,166 @@ void AMDGPU::get_samples_and_copy(struct amdgpu_common_metrics metrics_buffer[ME
 			UPDATE_METRIC_MAX(is_other_throttled);
 
 			UPDATE_METRIC_MAX(fan_speed);
-			metrics.fan_rpm = true;
-
-			metrics.load = amdgpu_common_metrics.gpu_load_percent;
-			metrics.powerUsage = amdgpu_common_metrics.average_gfx_power_w;
-			metrics.MemClock = amdgpu_common_metrics.current_uclk_mhz;
-
-			// Use hwmon instead, see gpu.cpp
-			if ( device_id == 0x1435 || device_id == 0x163f )
-			{
-				// If we are on VANGOGH (Steam Deck), then
-				// always use core clock from GPU metrics.
-				metrics.CoreClock = amdgpu_common_metrics.current_gfxclk_mhz;
-			}
-			metrics.temp = amdgpu_common_metrics.gpu_temp_c;
-			metrics.apu_cpu_power = amdgpu_common_metrics.average_cpu_power_w;
-			metrics.apu_cpu_temp = amdgpu_common_metrics.apu_cpu_temp_c;
 
-			metrics.is_power_throttled = amdgpu_common_metrics.is_power_throttled;
-			metrics.is_current_throttled = amdgpu_common_metrics.is_current_throttled;
-			metrics.is_temp_throttled = amdgpu_common_metrics.is_temp_throttled;
-			metrics.is_other_throttled = amdgpu_common_metrics.is_other_throttled;
+			UPDATE_METRIC_AVERAGE(hotspot_temp_c);
+			UPDATE_METRIC_AVERAGE(mem_temp_c);
+			UPDATE_METRIC_AVERAGE(mm_activity_percent);
+			UPDATE_METRIC_LAST(pcie_link_width);
+			UPDATE_METRIC_LAST(pcie_link_speed);
+			UPDATE_METRIC_OR(indep_throttle_status);
+			UPDATE_METRIC_LAST(apu_core_count);
+			UPDATE_METRIC_LAST(apu_core_temp_c);
+			UPDATE_METRIC_LAST(apu_core_clock_mhz);
+
+			// the counters that are valid still beat the averages, even when
+			// the load isn't accumulated and we had to poll for it
+			const struct amdgpu_common_metrics &last = metrics_buffer[sample_count - 1];
+			if (last.has_accumulators) {
+				struct amdgpu_accumulated_metrics accumulated {};
+				if (amdgpu_diff_accumulators(&previous_accumulators, &last.accumulators, &accumulated))
+					amdgpu_apply_accumulated(&accumulated, &amdgpu_common_metrics);
+				previous_accumulators = last.accumulators;
+			}
 
-			metrics.fan_speed = amdgpu_common_metrics.fan_speed;
+			copy_common_metrics();
 		}
+
+		metrics.sample_rate_hz = 1000.f / poll_period_ms;
+		metrics.timestamp_ns = os_time_get_nano();
+		published_metrics.store(metrics);
+	} while (!stop_thread && !use_accumulators);
+}
+
+bool AMDGPU::get_accumulated_and_copy() {
+	sampler.apply_requested_period();
+	usleep(sampler.update_period_ms() * 1000);
+	if (stop_thread)
+		return true;
+
+	struct amdgpu_common_metrics sample {};
+	struct amdgpu_accumulated_metrics accumulated {};
+	get_instant_metrics(&sample);
+
+	if (!sample.has_accumulators || !sample.accumulators.has_gfx_activity) {
+		SPDLOG_DEBUG("amdgpu: gpu_metrics load accumulator went away, falling back to polling");
+		use_accumulators = false;
+		return false;
+	}
+
+	bool ok = amdgpu_diff_accumulators(&previous_accumulators, &sample.accumulators, &accumulated) &&
+	          accumulated.has_gfx_load;
+	previous_accumulators = sample.accumulators;
+	if (!ok) {
+		// a glitch or the counters got reset, the next period diffs from this read
+		SPDLOG_DEBUG("amdgpu: gpu_metrics load accumulator not usable this period, polling instead");
+		return false;
+	}
+
+	amdgpu_apply_accumulated(&accumulated, &sample);
+
+	std::unique_lock<std::mutex> lock(metrics_mutex);
+	cond_var.wait(lock, [this]() { return !paused || stop_thread; });
+	get_sysfs_metrics();
+
+#ifndef TEST_ONLY
+	metrics.proc_vram_used = fdinfo_helper->amdgpu_helper_get_proc_vram();
+	fdinfo_helper->get_engine_loads(&metrics);
+#endif
+
+	amdgpu_common_metrics = sample;
+	copy_common_metrics();
+	metrics.sample_rate_hz = 1000.f / sampler.update_period_ms();
+	metrics.timestamp_ns = os_time_get_nano();
+	published_metrics.store(metrics);
+	return true;
+}
+
+void AMDGPU::copy_common_metrics() {
+	metrics.fan_rpm = true;
+
+	metrics.load = amdgpu_common_metrics.gpu_load_percent;
+	metrics.powerUsage = amdgpu_common_metrics.average_gfx_power_w;
+	metrics.MemClock = amdgpu_common_metrics.current_uclk_mhz;
+
+	// Use hwmon instead, see gpu.cpp
+	if ( device_id == 0x1435 || device_id == 0x163f )
+	{
+		// If we are on VANGOGH (Steam Deck), then
+		// always use core clock from GPU metrics.
+		metrics.CoreClock = amdgpu_common_metrics.current_gfxclk_mhz;
+	}
+	metrics.temp = amdgpu_common_metrics.gpu_temp_c;
+	metrics.apu_cpu_power = amdgpu_common_metrics.average_cpu_power_w;
+	metrics.apu_cpu_temp = amdgpu_common_metrics.apu_cpu_temp_c;
+
+	metrics.is_power_throttled = amdgpu_common_metrics.is_power_throttled;
+	metrics.is_current_throttled = amdgpu_common_metrics.is_current_throttled;
+	metrics.is_temp_throttled = amdgpu_common_metrics.is_temp_throttled;
+	metrics.is_other_throttled = amdgpu_common_metrics.is_other_throttled;
+	if (throttling)
+		throttling->set_reasons(gpu_throttle_reasons(metrics));
+
+	metrics.fan_speed = amdgpu_common_metrics.fan_speed;
+
+	// hwmon is preferred for temperatures, same as above
+	if (!sysfs_nodes.junction_temp && amdgpu_common_metrics.hotspot_temp_c)
+		metrics.junction_temp = amdgpu_common_metrics.hotspot_temp_c;
+	if (!sysfs_nodes.memory_temp && amdgpu_common_metrics.mem_temp_c)
+		metrics.memory_temp = amdgpu_common_metrics.mem_temp_c;
+
+	// UMC activity is only reported by dGPU tables
+	metrics.mem_load = is_apu ? -1 : amdgpu_common_metrics.mem_load_percent;
+	metrics.video_load = amdgpu_common_metrics.mm_activity_percent;
+	metrics.pcie_link_width = amdgpu_common_metrics.pcie_link_width;
+	metrics.pcie_link_speed = amdgpu_common_metrics.pcie_link_speed / 10.f;
+	metrics.throttle_status = amdgpu_common_metrics.indep_throttle_status;
+
+	metrics.apu_core_count = amdgpu_common_metrics.apu_core_count;
+	for (size_t i = 0; i < GPU_METRICS_MAX_APU_CORES; i++) {
+		metrics.apu_core_temp[i] = amdgpu_common_metrics.apu_core_temp_c[i];
+		metrics.apu_core_clock[i] = amdgpu_common_metrics.apu_core_clock_mhz[i];
 	}
 }
 
 void AMDGPU::metrics_polling_thread() {
 	struct amdgpu_common_metrics metrics_buffer[METRICS_SAMPLE_COUNT];
-	bool gpu_load_needs_dividing = false;  //some GPUs report load as centipercent
+	//some GPUs report load as centipercent
+	bool gpu_load_needs_dividing = activity_unit == AMDGPU_ACTIVITY_CENTIPERCENT;
 
 	// Initial poll of the metrics, so that we have values to display as fast as possible
 	get_instant_metrics(&amdgpu_common_metrics);
-	if (amdgpu_common_metrics.gpu_load_percent > 100){
+	if (gpu_load_needs_dividing ||
+	    (activity_unit == AMDGPU_ACTIVITY_UNKNOWN && amdgpu_common_metrics.gpu_load_percent > 100)){
 		gpu_load_needs_dividing = true;
 		amdgpu_common_metrics.gpu_load_percent /= 100;
 	}
 
+	// Newer dGPU firmwares expose monotonic counters. Each one replaces the average
+	// of its field, and when the load is accumulated a single read per update period
+	// gives exact averages and we don't need to wake up every 25ms
+	if (gpu_metrics_is_valid && amdgpu_common_metrics.has_accumulators) {
+		const struct amdgpu_accumulators &acc = amdgpu_common_metrics.accumulators;
+		previous_accumulators = acc;
+		use_accumulators = acc.has_gfx_activity;
+		SPDLOG_DEBUG("amdgpu: using gpu_metrics accumulators (energy: {}, gfx: {}, mem: {}, throttle: {})",
+		             acc.has_energy, acc.has_gfx_activity, acc.has_mem_activity,
+		             acc.has_throttle_residency);
+	}
+
 	// Set all the fields to 0 by default. Only done once as we're just replacing previous values after
 	memset(metrics_buffer, 0, sizeof(metrics_buffer));
 
 	while (!stop_thread) {
-#ifndef TEST_ONLY
-		if (get_params()->no_display && !logger->is_active())
-			usleep(100000);
-		else
-#endif
+		// paused by the HUD while it's hidden or shows no GPU metrics
+		if (paused) {
+			std::unique_lock<std::mutex> lock(metrics_mutex);
+			cond_var.wait(lock, [this]() { return !paused || stop_thread; });
+			// don't average the counters over the pause
+			previous_accumulators = {};
+			continue;
+		}
+
+		if (!use_accumulators || !get_accumulated_and_copy())
 			get_samples_and_copy(metrics_buffer, gpu_load_needs_dividing);
 	}
 }
@@ -344,7 +527,7 @@ void AMDGPU::get_sysfs_metrics() {
 	// this value is instantaneous and should be averaged over time
 	// probably just average everything in this function to be safe
 #ifndef TEST_ONLY
-	if (get_params()->enabled[OVERLAY_PARAM_ENABLED_gpu_power]) {
+	if (gpu_power_enabled) {
 		// NOTE: Do not read power1_average if it is not enabled, as some
 		// older GPUs may hang when reading the sysfs node.
 		metrics.powerUsage = 0;
@@ -360,7 +543,7 @@ void AMDGPU::get_sysfs_metrics() {
 	}
 
 #ifndef TEST_ONLY
-	if (!get_params()->enabled[OVERLAY_PARAM_ENABLED_gpu_power_limit]) {
+	if (!gpu_power_limit_enabled) {
 		// NOTE: Do not read power1_cap if it is not enabled, as some
 		// older GPUs may hang when reading the sysfs node.
 		metrics.powerLimit = 0;
@@ -461,10 +644,16 @@ AMDGPU::AMDGPU(std::string pci_dev, uint32_t device_id, uint32_t vendor_id) {
 	const std::string device_path = "/sys/bus/pci/devices/" + pci_dev;
 	gpu_metrics_path = device_path + "/gpu_metrics";
     // Just check that the metrics file exists and is readable
-    FILE *f = fopen(gpu_metrics_path.c_str(), "rb");
-    if (f) {
+    struct metrics_table_header header {};
+    if (amdgpu_read_metrics_header(gpu_metrics_path, &header)) {
         gpu_metrics_is_valid = true;
-        fclose(f);
+        activity_unit = amdgpu_get_activity_unit(header, device_id);
+        mem_load_needs_dividing = mm_activity_needs_dividing =
+            activity_unit == AMDGPU_ACTIVITY_CENTIPERCENT;
+        SPDLOG_DEBUG("amdgpu: gpu_metrics v{}.{}, activities in {}", header.format_revision,
+                     header.content_revision,
+                     activity_unit == AMDGPU_ACTIVITY_PERCENT ? "percent" :
+                     activity_unit == AMDGPU_ACTIVITY_CENTIPERCENT ? "centipercent" : "unknown unit");
     } else {
         gpu_metrics_is_valid = false;
         SPDLOG_DEBUG("Failed to open gpu_metrics at '{}'", gpu_metrics_path);
@@ -501,7 +690,7 @@ AMDGPU::AMDGPU(std::string pci_dev, uint32_t device_id, uint32_t vendor_id) {
 		}
 	}
 
-	throttling = std::make_shared<Throttling>(0x1002);
+	throttling = std::make_shared<Throttling>();
 #ifndef TEST_ONLY
 	fdinfo_helper = std::make_unique<GPU_fdinfo>("amdgpu", pci_dev, "", /*called_from_amdgpu_cpp=*/ true);
 #endif
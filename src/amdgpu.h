@@ -19,10 +19,14 @@
 
 #define NUM_HBM_INSTANCES 4
 #define TEMP_HOTSPOT_BIT 36ull
-#define UPDATE_METRIC_AVERAGE(FIELD) do { int value_sum = 0; for (size_t s=0; s < METRICS_SAMPLE_COUNT; s++) { value_sum += metrics_buffer[s].FIELD; } amdgpu_common_metrics.FIELD = value_sum / METRICS_SAMPLE_COUNT; } while(0)
-#define UPDATE_METRIC_AVERAGE_FLOAT(FIELD) do { float value_sum = 0; for (size_t s=0; s < METRICS_SAMPLE_COUNT; s++) { value_sum += metrics_buffer[s].FIELD; } amdgpu_common_metrics.FIELD = value_sum / METRICS_SAMPLE_COUNT; } while(0)
-#define UPDATE_METRIC_MAX(FIELD) do { int cur_max = metrics_buffer[0].FIELD; for (size_t s=1; s < METRICS_SAMPLE_COUNT; s++) { cur_max = MAX(cur_max, metrics_buffer[s].FIELD); }; amdgpu_common_metrics.FIELD = cur_max; } while(0)
-#define UPDATE_METRIC_LAST(FIELD) do { amdgpu_common_metrics.FIELD = metrics_buffer[METRICS_SAMPLE_COUNT - 1].FIELD; } while(0)
+/* energy_accumulator LSB, same unit as the energy1_input hwmon node (15.259 uJ) */
+#define AMDGPU_ENERGY_ACC_UNIT_J 15.259e-6
+// sample_count is the number of valid entries in metrics_buffer
+#define UPDATE_METRIC_AVERAGE(FIELD) do { int value_sum = 0; for (size_t s=0; s < sample_count; s++) { value_sum += metrics_buffer[s].FIELD; } amdgpu_common_metrics.FIELD = value_sum / sample_count; } while(0)
+#define UPDATE_METRIC_AVERAGE_FLOAT(FIELD) do { float value_sum = 0; for (size_t s=0; s < sample_count; s++) { value_sum += metrics_buffer[s].FIELD; } amdgpu_common_metrics.FIELD = value_sum / sample_count; } while(0)
+#define UPDATE_METRIC_MAX(FIELD) do { int cur_max = metrics_buffer[0].FIELD; for (size_t s=1; s < sample_count; s++) { cur_max = MAX(cur_max, metrics_buffer[s].FIELD); }; amdgpu_common_metrics.FIELD = cur_max; } while(0)
+#define UPDATE_METRIC_LAST(FIELD) do { amdgpu_common_metrics.FIELD = metrics_buffer[sample_count - 1].FIELD; } while(0)
+#define UPDATE_METRIC_OR(FIELD) do { amdgpu_common_metrics.FIELD = 0; for (size_t s=0; s < sample_count; s++) { amdgpu_common_metrics.FIELD |= metrics_buffer[s].FIELD; } } while(0)
 #ifdef _WIN32
 #define MAX(x, y) (((x) > (y)) ? (x) : (y))
 #endif
@@ -339,13 +343,65 @@ struct amdgpu_files
     FILE *gpu_voltage_soc;
 };
 
+/* Raw monotonic counters exposed by gpu_metrics. Differencing two
+ * snapshots gives exact averages over the interval between the reads,
+ * instead of averaging instantaneous values polled every few ms. Each
+ * counter is only used when its has_ flag is set: v1.x tables may lack
+ * some of them, v3.0 tables only have the throttle residency.
+ */
+struct amdgpu_accumulators {
+	uint64_t timestamp_ns;     // system_clock_counter
+	bool has_energy;
+	bool has_gfx_activity;
+	bool has_mem_activity;
+	bool has_throttle_residency;
+	uint64_t energy;           // AMDGPU_ENERGY_ACC_UNIT_J units
+	uint32_t gfx_activity;     // busy % accumulated every ms
+	uint32_t mem_activity;     // same as above, for the memory controller
+	uint32_t power_residency;  // sum of the spl/fppt/sppt residency counters
+	uint32_t temp_residency;   // sum of the thermal and prochot residency counters
+};
+
+struct amdgpu_accumulated_metrics {
+	bool has_power;
+	bool has_gfx_load;
+	bool has_mem_load;
+	bool has_throttling;
+	float average_power_w;
+	uint16_t gfx_load_percent;
+	uint16_t mem_load_percent;
+	bool is_power_throttled;
+	bool is_temp_throttled;
+};
+
+struct amdgpu_common_metrics;
+
+/* Unit of the activity fields of a gpu_metrics table */
+enum amdgpu_activity_unit {
+	AMDGPU_ACTIVITY_UNKNOWN,
+	AMDGPU_ACTIVITY_PERCENT,
+	AMDGPU_ACTIVITY_CENTIPERCENT,
+};
+
+/* Returns false when the table has none of the counters, or no timestamp */
+bool amdgpu_get_accumulators(const void *buf, size_t size, struct amdgpu_accumulators *acc);
+/* Returns false when none of the counters valid in both snapshots could be used */
+bool amdgpu_diff_accumulators(const struct amdgpu_accumulators *prev,
+                              const struct amdgpu_accumulators *cur,
+                              struct amdgpu_accumulated_metrics *out);
+/* Replaces the averaged fields that have an accumulated counterpart */
+void amdgpu_apply_accumulated(const struct amdgpu_accumulated_metrics *accumulated,
+                              struct amdgpu_common_metrics *metrics);
+/* APUs use format revision 2 and 3 tables, checked before a backend is created */
+bool amdgpu_metrics_is_apu(const std::string& pci_dev);
+
 /* This structure is used to communicate the latest values of the amdgpu metrics.
  * The direction of communication is amdgpu_polling_thread -> amdgpu_get_metrics().
  */
 struct amdgpu_common_metrics {
 	/* Load level: averaged across the sampling period */
 	uint16_t gpu_load_percent;
-	// uint16_t mem_load_percent;
+	uint16_t mem_load_percent;
 
 	/* Power usage: averaged across the sampling period */
 	float average_gfx_power_w;
@@ -367,6 +423,21 @@ struct amdgpu_common_metrics {
 	bool is_other_throttled;
 
 	uint16_t fan_speed;
+
+	/* Extended fields, averaged unless noted */
+	uint16_t hotspot_temp_c;
+	uint16_t mem_temp_c;
+	uint16_t mm_activity_percent;      // UVD or VCN
+	uint16_t pcie_link_width;          // latest value
+	uint16_t pcie_link_speed;          // latest value, in 0.1 GT/s
+	uint64_t indep_throttle_status;    // OR'ed over the sampling period
+	uint16_t apu_core_count;           // latest value
+	std::array<uint16_t, GPU_METRICS_MAX_APU_CORES> apu_core_temp_c;
+	std::array<uint16_t, GPU_METRICS_MAX_APU_CORES> apu_core_clock_mhz;
+
+	/* Raw counters, see amdgpu_get_accumulators() */
+	bool has_accumulators;
+	struct amdgpu_accumulators accumulators;
 };
 
 extern std::string metrics_path;
@@ -389,8 +460,7 @@ class AMDGPU {
 								  bool &gpu_load_needs_dividing);
 
         gpu_metrics copy_metrics() {
-            std::lock_guard<std::mutex> lock(metrics_mutex);
-            return metrics;
+            return published_metrics.load();
         };
 
         void pause() {
@@ -403,6 +473,13 @@ class AMDGPU {
             cond_var.notify_one();
         }
 
+        // Called on the HUD side, the polling thread only sees the result
+        void request_sampling(const overlay_params& params) {
+            sampler.request_update_period_ms(params.fps_sampling_period / 1'000'000);
+            gpu_power_enabled = params.enabled[OVERLAY_PARAM_ENABLED_gpu_power];
+            gpu_power_limit_enabled = params.enabled[OVERLAY_PARAM_ENABLED_gpu_power_limit];
+        }
+
 	private:
 		std::string pci_dev;
 		std::string gpu_metrics_path;
@@ -415,18 +492,31 @@ class AMDGPU {
 		std::condition_variable cond_var;
 		std::atomic<bool> stop_thread{false};
         std::atomic<bool> paused{false};
+		// see get_sysfs_metrics(), the risky nodes aren't read until requested
+		std::atomic<bool> gpu_power_enabled{true};
+		std::atomic<bool> gpu_power_limit_enabled{false};
 		std::mutex metrics_mutex;
 		gpu_metrics metrics;
+		metrics_snapshot<gpu_metrics> published_metrics;
 		struct amdgpu_common_metrics amdgpu_common_metrics;
-		struct gpu_metrics_v3_0 previous_metrics{};
-		#define V3_THROTTLING_DELTA(name) \
-		((amdgpu_metrics)->throttle_residency_##name - (previous_metrics).throttle_residency_##name)
+		// read once per update period instead of sampling, only when the
+		// load itself is accumulated
+		bool use_accumulators = false;
+		struct amdgpu_accumulators previous_accumulators{};
+		adaptive_sampler sampler;
+		// some firmwares report activities in centipercent, known up front
+		// for most and only detected from the readings for the others
+		amdgpu_activity_unit activity_unit = AMDGPU_ACTIVITY_UNKNOWN;
+		bool mem_load_needs_dividing = false;
+		bool mm_activity_needs_dividing = false;
 
 #ifndef TEST_ONLY
 		std::unique_ptr<GPU_fdinfo> fdinfo_helper;
 #endif
 
 		void get_sysfs_metrics();
+		bool get_accumulated_and_copy();
+		void copy_common_metrics();
 		void metrics_polling_thread();
 };
 
@@ -0,0 +1,126 @@
+#include <cmath>
+#include <cstddef>
+#include <initializer_list>
+#include "amdgpu.h"
+
+// Residency counters the firmware doesn't implement read as UINT32_MAX,
+// the others are summed so any of them advancing means throttling
+static bool amdgpu_sum_residency(std::initializer_list<uint32_t> counters, uint32_t *sum) {
+	bool valid = false;
+	*sum = 0;
+	for (uint32_t counter : counters) {
+		if (counter == UINT32_MAX)
+			continue;
+		*sum += counter;
+		valid = true;
+	}
+	return valid;
+}
+
+bool amdgpu_get_accumulators(const void *buf, size_t size, struct amdgpu_accumulators *acc) {
+	const struct metrics_table_header *header = (const struct metrics_table_header *)buf;
+	*acc = {};
+
+	if (size < sizeof(*header))
+		return false;
+
+	if (header->format_revision == 1) {
+		// all of v1.x have the counters at the same offsets
+		if (size < offsetof(struct gpu_metrics_v1_3, temperature_hbm))
+			return false;
+
+		const struct gpu_metrics_v1_3 *amdgpu_metrics = (const struct gpu_metrics_v1_3 *)buf;
+		acc->timestamp_ns = amdgpu_metrics->system_clock_counter;
+		acc->energy = amdgpu_metrics->energy_accumulator;
+		acc->has_energy = acc->energy != 0 && acc->energy != UINT64_MAX;
+		acc->gfx_activity = amdgpu_metrics->gfx_activity_acc;
+		acc->has_gfx_activity = acc->gfx_activity != UINT32_MAX;
+		acc->mem_activity = amdgpu_metrics->mem_activity_acc;
+		acc->has_mem_activity = acc->mem_activity != UINT32_MAX;
+	} else if (header->format_revision == 3) {
+		// APU tables only accumulate the throttle residency
+		if (size < offsetof(struct gpu_metrics_v3_0, time_filter_alphavalue))
+			return false;
+
+		const struct gpu_metrics_v3_0 *amdgpu_metrics = (const struct gpu_metrics_v3_0 *)buf;
+		acc->timestamp_ns = amdgpu_metrics->system_clock_counter;
+		bool has_power = amdgpu_sum_residency({ amdgpu_metrics->throttle_residency_spl,
+		                                        amdgpu_metrics->throttle_residency_fppt,
+		                                        amdgpu_metrics->throttle_residency_sppt },
+		                                      &acc->power_residency);
+		bool has_temp = amdgpu_sum_residency({ amdgpu_metrics->throttle_residency_thm_core,
+		                                       amdgpu_metrics->throttle_residency_thm_gfx,
+		                                       amdgpu_metrics->throttle_residency_thm_soc,
+		                                       amdgpu_metrics->throttle_residency_prochot },
+		                                     &acc->temp_residency);
+		acc->has_throttle_residency = has_power || has_temp;
+	} else {
+		return false;
+	}
+
+	// nothing can be averaged without the timestamp
+	if (acc->timestamp_ns == 0 || acc->timestamp_ns == UINT64_MAX) {
+		*acc = {};
+		return false;
+	}
+
+	return acc->has_energy || acc->has_gfx_activity || acc->has_mem_activity ||
+	       acc->has_throttle_residency;
+}
+
+static bool amdgpu_diff_activity(uint32_t prev, uint32_t cur, double delta_ms, uint16_t *percent) {
+	// unsigned subtraction handles the counter wrapping around
+	double value = static_cast<uint32_t>(cur - prev) / delta_ms;
+	// firmware that doesn't really accumulate gives nonsense here, let the caller fall back
+	if (value > 100.0)
+		return false;
+
+	*percent = static_cast<uint16_t>(std::lround(value));
+	return true;
+}
+
+bool amdgpu_diff_accumulators(const struct amdgpu_accumulators *prev,
+                              const struct amdgpu_accumulators *cur,
+                              struct amdgpu_accumulated_metrics *out) {
+	*out = {};
+
+	if (prev->timestamp_ns == 0 || cur->timestamp_ns <= prev->timestamp_ns)
+		return false;
+
+	const double delta_ns = static_cast<double>(cur->timestamp_ns - prev->timestamp_ns);
+
+	if (prev->has_energy && cur->has_energy && cur->energy >= prev->energy) {
+		double joules = (cur->energy - prev->energy) * AMDGPU_ENERGY_ACC_UNIT_J;
+		out->average_power_w = joules / (delta_ns / 1e9);
+		out->has_power = true;
+	}
+
+	if (prev->has_gfx_activity && cur->has_gfx_activity)
+		out->has_gfx_load = amdgpu_diff_activity(prev->gfx_activity, cur->gfx_activity,
+		                                         delta_ns / 1e6, &out->gfx_load_percent);
+	if (prev->has_mem_activity && cur->has_mem_activity)
+		out->has_mem_load = amdgpu_diff_activity(prev->mem_activity, cur->mem_activity,
+		                                         delta_ns / 1e6, &out->mem_load_percent);
+
+	if (prev->has_throttle_residency && cur->has_throttle_residency) {
+		out->is_power_throttled = cur->power_residency != prev->power_residency;
+		out->is_temp_throttled = cur->temp_residency != prev->temp_residency;
+		out->has_throttling = true;
+	}
+
+	return out->has_power || out->has_gfx_load || out->has_mem_load || out->has_throttling;
+}
+
+void amdgpu_apply_accumulated(const struct amdgpu_accumulated_metrics *accumulated,
+                              struct amdgpu_common_metrics *metrics) {
+	if (accumulated->has_gfx_load)
+		metrics->gpu_load_percent = accumulated->gfx_load_percent;
+	if (accumulated->has_mem_load)
+		metrics->mem_load_percent = accumulated->mem_load_percent;
+	if (accumulated->has_power)
+		metrics->average_gfx_power_w = accumulated->average_power_w;
+	if (accumulated->has_throttling) {
+		metrics->is_power_throttled = accumulated->is_power_throttled;
+		metrics->is_temp_throttled = accumulated->is_temp_throttled;
+	}
+}
@@ -369,6 +369,8 @@ int main(int, char**)
     // Main loop
     while (!glfwWindowShouldClose(window)){
         check_keybinds(params);
+        if (gpus)
+            gpus->update_sampling(get_params(), logger->is_active());
 
         if (!get_params()->no_display){
             if (mangoapp_paused){
@@ -377,10 +379,6 @@ int main(int, char**)
                 XChangeProperty(x11_display, x11_window, overlay_atom, XA_CARDINAL, 32, PropModeReplace, (unsigned char *)&value, 1);
                 XSync(x11_display, 0);
                 mangoapp_paused = false;
-                // resume all GPU threads
-                if (gpus)
-                    for (auto gpu : gpus->available_gpus)
-                        gpu->resume();
             }
             {
                 std::unique_lock<std::mutex> lk(mangoapp_m);
@@ -418,10 +416,6 @@ int main(int, char**)
             XChangeProperty(x11_display, x11_window, overlay_atom, XA_CARDINAL, 32, PropModeReplace, (unsigned char *)&value, 1);
             XSync(x11_display, 0);
             mangoapp_paused = true;
-            // pause all GPUs threads
-            if (gpus)
-                for (auto gpu : gpus->available_gpus)
-                    gpu->pause();
 
             // If mangoapp is hidden, using mangoapp_cv.wait() causes a hang.
             // Because of this hang, we can't detect if the user presses R_SHIFT + F12,
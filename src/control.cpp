@@ -67,6 +67,7 @@ static void parse_command(overlay_params &params,
       params.enabled[OVERLAY_PARAM_ENABLED_fcat] =
          !params.enabled[OVERLAY_PARAM_ENABLED_fcat];
    }
+   mark_hud_dirty();
 }
 
 #define BUFSIZE 4096
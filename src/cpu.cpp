@@ -13,6 +13,7 @@
 #include "string_utils.h"
 #include "gpu.h"
 #include "file_utils.h"
+#include "mesa/util/os_time.h"
 #include <cctype> // std::tolower
 
 #if defined(__ANDROID__)
@@ -921,7 +922,7 @@ bool CPUStats::UpdateCpuTemp() {
     if (gpus) {
         for (auto gpu : gpus->available_gpus) {
             if (gpu->is_apu()) {
-                m_cpuDataTotal.temp = gpu->metrics.apu_cpu_temp;
+                m_cpuDataTotal.temp = gpu->metrics().apu_cpu_temp;
 #if defined(__ANDROID__)
                 last_ret = true;
 #endif
@@ -1070,7 +1071,7 @@ static bool get_cpu_power_amdgpu(float& power) {
     if (gpus)
         for (auto gpu : gpus->available_gpus)
             if (gpu->is_apu()) {
-                power = gpu->metrics.apu_cpu_power;
+                power = gpu->metrics().apu_cpu_power;
                 return true;
             }
 
@@ -1314,6 +1315,7 @@ bool CPUStats::UpdateCPUData()
         m_cpuDataTotal.totalPeriod = 100;
         m_cpuPeriod   = 1.0;
         m_updatedCPUs = true;
+        m_sampleTimeNs = os_time_get_nano();
 
         if (!g_logged_corectl_summary) {
             SPDLOG_INFO(
@@ -1338,6 +1340,7 @@ bool CPUStats::UpdateCPUData()
     if (android_update_total_cpu_fallback(m_cpuDataTotal, m_cpuData)) {
         m_cpuPeriod   = 1.0;
         m_updatedCPUs = true;
+        m_sampleTimeNs = os_time_get_nano();
 
         if (!g_logged_fallback_switch) {
             SPDLOG_INFO("Android CPU: core_ctl unusable, using /proc/self/stat fallback (total-only)");
@@ -1405,6 +1408,9 @@ bool CPUStats::UpdateCPUData()
         }
     } while(true);
 
+    if (ret)
+        m_sampleTimeNs = os_time_get_nano();
+
     if (cpu_count < m_cpuData.size())
         m_cpuData.resize(cpu_count);
 
@@ -1616,7 +1622,7 @@ bool CPUStats::InitCpuPowerData() {
     if (!cpuPowerData) {
         if (gpus) {
             for (auto gpu : gpus->available_gpus) {
-                if (gpu->vendor_id == 0x1002 && gpu->is_apu() && gpu->get_metrics().apu_cpu_power > 0) {
+                if (gpu->vendor_id == 0x1002 && gpu->is_apu() && gpu->metrics().apu_cpu_power > 0) {
                     auto powerData = std::make_unique<CPUPowerData_amdgpu>();
                     cpuPowerData = (CPUPowerData*)powerData.release();
                 }
@@ -182,6 +182,8 @@ public:
    bool GetCpuFile();
    bool InitCpuPowerData();
    double GetCPUPeriod() { return m_cpuPeriod; }
+   // os_time_get_nano() of the last successful UpdateCPUData() read
+   uint64_t GetSampleTimeNs() const { return m_sampleTimeNs; }
    void get_cpu_cores_types();
    void get_cpu_cores_types_intel();
    void get_cpu_cores_types_arm();
@@ -198,6 +200,7 @@ private:
    CPUData m_cpuDataTotal {};
    std::vector<int> m_coreMhz;
    double m_cpuPeriod = 0;
+   uint64_t m_sampleTimeNs = 0;
    bool m_updatedCPUs = false; // TODO use caching or just update?
    bool m_inited = false;
    FILE *m_cpuTempFile = nullptr;
@@ -44,6 +44,7 @@ struct mutexed_metadata {
         float longest;
         int dir = -1;
         bool needs_recalc = true;
+        uint32_t glyphs_generation = 0;
 
         std::vector<mp_fmt> formatted;
     } ticker;
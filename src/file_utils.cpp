@@ -13,6 +13,8 @@
 #include <algorithm>
 #include <cctype>
 #include <cerrno>
+#include <cstdio>
+#include <thread>
 
 #include <spdlog/spdlog.h>
 
@@ -214,6 +216,42 @@ std::string get_config_dir()
     return path;
 }
 
+std::string get_cache_dir()
+{
+    if (const char* p = std::getenv("XDG_CACHE_HOME"))
+        return p;
+
+    std::string path = get_home_dir();
+    if (!path.empty())
+        path += "/.cache";
+    return path;
+}
+
+bool replace_file(const std::string& path, const void* data, size_t size)
+{
+    std::error_code ec;
+    fs::create_directories(fs::path(path).parent_path(), ec);
+
+    std::string tmp = path + "." + std::to_string(getpid()) + "." +
+        std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+    {
+        std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+        file.write(static_cast<const char*>(data), size);
+        if (!file.good()) {
+            SPDLOG_DEBUG("Failed to write {}", tmp);
+            file.close();
+            std::remove(tmp.c_str());
+            return false;
+        }
+    }
+
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
 bool lib_loaded(const std::string& lib, pid_t pid)
 {
     // 검색 대상은 한 번만 lowercase
@@ -36,6 +36,10 @@ std::string get_wine_exe_name(bool keep_ext = false);
 std::string get_home_dir();
 std::string get_data_dir();
 std::string get_config_dir();
+std::string get_cache_dir();
+// Writes `path` through a temporary file, so that other processes reading
+// it see either the old or the new contents. Creates missing directories.
+bool replace_file(const std::string& path, const void* data, size_t size);
 bool lib_loaded(const std::string& lib, pid_t pid);
 std::string remove_parentheses(const std::string&);
 std::string to_lower(const std::string& str);
@@ -46,3 +46,14 @@ std::string get_config_dir()
     std::string path;
     return path;
 }
+
+std::string get_cache_dir()
+{
+    std::string path;
+    return path;
+}
+
+bool replace_file(const std::string& path, const void* data, size_t size)
+{
+    return false;
+}
@@ -1,11 +1,681 @@
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cinttypes>
+#include <cmath>
+#include <algorithm>
+#include <fstream>
+#include <vector>
+#include <set>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <future>
+#include <iterator>
+#include <imgui_internal.h>
+#include <spdlog/spdlog.h>
 #include "overlay.h"
+#include "hud_elements.h"
 #include "file_utils.h"
 #include "font_default.h"
 #include "IconsForkAwesome.h"
 #include "forkawesome.h"
 
-void create_fonts(ImFontAtlas* font_atlas, const overlay_params& params, ImFont*& small_font, ImFont*& text_font, ImFont*& secondary_font)
+// ImGui's copy is private to imgui_draw.cpp, glyphs added after Build()
+// are rasterized with this one
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-function"
+#define STBTT_STATIC
+#define STB_TRUETYPE_IMPLEMENTATION
+#define STBTT_malloc(x, u) ((void)(u), IM_ALLOC(x))
+#define STBTT_free(x, u) ((void)(u), IM_FREE(x))
+#include <imstb_truetype.h>
+#pragma GCC diagnostic pop
+
+/* Signed distance to the closest glyph edge, positive inside, of the w x h
+ * texels at (x0, y0). The edge runs through texels with partial coverage
+ * and between inside and outside neighbours. Each texel takes the closest
+ * edge texel of its 8 neighbours in two passes over the region. Texels
+ * past the region are empty, the atlas padding guarantees it.
+ */
+static void glyph_distances(const uint8_t* coverage, int stride,
+                            int x0, int y0, int w, int h,
+                            std::vector<float>& dist)
+{
+   struct edge { int x, y; float offset; };
+   const float none = 1e6f;
+   std::vector<edge> closest(w * h, edge { 0, 0, none });
+
+   auto alpha = [&](int x, int y) {
+      if (x < 0 || y < 0 || x >= w || y >= h)
+         return 0.f;
+      return coverage[(y0 + y) * stride + x0 + x] / 255.f;
+   };
+   auto distance = [&](int x, int y, const edge& e) {
+      if (e.offset >= none)
+         return none;
+      return std::hypot(float(x - e.x), float(y - e.y)) + e.offset;
+   };
+   auto relax = [&](int x, int y, int dx, int dy) {
+      if (x + dx < 0 || y + dy < 0 || x + dx >= w || y + dy >= h)
+         return;
+      const edge& n = closest[(y + dy) * w + x + dx];
+      edge& e = closest[y * w + x];
+      if (distance(x, y, n) < distance(x, y, e))
+         e = n;
+   };
+
+   for (int y = 0; y < h; y++) {
+      for (int x = 0; x < w; x++) {
+         float a = alpha(x, y);
+         bool inside = a >= 0.5f;
+         if (a > 0.f && a < 1.f)
+            closest[y * w + x] = { x, y, std::fabs(a - 0.5f) };
+         else if ((alpha(x - 1, y) >= 0.5f) != inside || (alpha(x + 1, y) >= 0.5f) != inside ||
+                  (alpha(x, y - 1) >= 0.5f) != inside || (alpha(x, y + 1) >= 0.5f) != inside)
+            closest[y * w + x] = { x, y, 0.5f };
+      }
+   }
+
+   for (int y = 0; y < h; y++) {
+      for (int x = 0; x < w; x++) {
+         relax(x, y, -1, -1);
+         relax(x, y, 0, -1);
+         relax(x, y, 1, -1);
+         relax(x, y, -1, 0);
+      }
+      for (int x = w - 1; x >= 0; x--)
+         relax(x, y, 1, 0);
+   }
+   for (int y = h - 1; y >= 0; y--) {
+      for (int x = w - 1; x >= 0; x--) {
+         relax(x, y, 1, 1);
+         relax(x, y, 0, 1);
+         relax(x, y, -1, 1);
+         relax(x, y, 1, 0);
+      }
+      for (int x = 0; x < w; x++)
+         relax(x, y, -1, 0);
+   }
+
+   dist.resize(w * h);
+   for (int y = 0; y < h; y++)
+      for (int x = 0; x < w; x++) {
+         float d = std::min(distance(x, y, closest[y * w + x]), font_sdf_spread);
+         dist[y * w + x] = alpha(x, y) >= 0.5f ? d : -d;
+      }
+}
+
+/* Replaces the coverage of `glyph` with distances and grows its quad by
+ * font_sdf_spread, so the outline fits in it. Only the texels within
+ * [x_min, x_max) x [y_min, y_max) are written, `coverage` is a copy of
+ * them.
+ */
+static void glyph_sdf(ImFontGlyph& glyph, const uint8_t* coverage,
+                      int x_min, int y_min, int x_max, int y_max,
+                      unsigned char* pixels, int width, int height,
+                      std::vector<float>& dist)
+{
+   const int spread = (int)font_sdf_spread;
+   int tx0 = (int)std::lround(glyph.U0 * width);
+   int ty0 = (int)std::lround(glyph.V0 * height);
+   int tx1 = (int)std::lround(glyph.U1 * width);
+   int ty1 = (int)std::lround(glyph.V1 * height);
+   if (!glyph.Visible || tx1 <= tx0 || ty1 <= ty0)
+      return;
+
+   int x0 = std::max(tx0 - spread, x_min), y0 = std::max(ty0 - spread, y_min);
+   int x1 = std::min(tx1 + spread, x_max), y1 = std::min(ty1 + spread, y_max);
+   int w = x1 - x0, h = y1 - y0;
+   glyph_distances(coverage, x_max - x_min, x0 - x_min, y0 - y_min, w, h, dist);
+   for (int y = 0; y < h; y++)
+      for (int x = 0; x < w; x++) {
+         float v = 0.5f + dist[y * w + x] / (2.f * font_sdf_spread);
+         pixels[(y0 + y) * width + x0 + x] = (unsigned char)std::clamp(std::lround(v * 255.f), 0L, 255L);
+      }
+
+   float scale_x = (glyph.X1 - glyph.X0) / (tx1 - tx0);
+   float scale_y = (glyph.Y1 - glyph.Y0) / (ty1 - ty0);
+   glyph.X0 -= (tx0 - x0) * scale_x;
+   glyph.X1 += (x1 - tx1) * scale_x;
+   glyph.Y0 -= (ty0 - y0) * scale_y;
+   glyph.Y1 += (y1 - ty1) * scale_y;
+   glyph.U0 = (float)x0 / width;
+   glyph.V0 = (float)y0 / height;
+   glyph.U1 = (float)x1 / width;
+   glyph.V1 = (float)y1 / height;
+}
+
+/* glyph_sdf() for every glyph. Everything else in the atlas, like the
+ * white pixel, keeps reading as fully inside.
+ */
+static void build_font_sdf(ImFontAtlas* font_atlas)
+{
+   unsigned char* pixels;
+   int width, height;
+   font_atlas->GetTexDataAsAlpha8(&pixels, &width, &height);
+   const std::vector<uint8_t> coverage(pixels, pixels + width * height);
+   std::vector<float> dist;
+
+   for (ImFont* font : font_atlas->Fonts)
+      for (ImFontGlyph& glyph : font->Glyphs)
+         glyph_sdf(glyph, coverage.data(), 0, 0, width, height, pixels, width, height, dist);
+}
+
+static std::mutex lazy_glyphs_mutex;
+static ImFontGlyphRangesBuilder lazy_ranges;   // font_glyph_ranges
+static std::set<ImWchar> lazy_glyphs;          // the ones HUD text used
+static std::atomic<uint32_t> lazy_glyphs_gen {0};
+
+uint32_t lazy_glyphs_generation()
+{
+   return lazy_glyphs_gen;
+}
+
+void request_glyphs(ImFont* font, const char* text)
+{
+   // most HUD text is ASCII, always in the atlas
+   const char* p = text;
+   while (*p && (unsigned char)*p < 0x80)
+      p++;
+   if (!*p)
+      return;
+
+   bool added = false;
+   {
+      std::lock_guard<std::mutex> lock(lazy_glyphs_mutex);
+      while (*p) {
+         unsigned int c;
+         p += ImTextCharFromUtf8(&c, p, nullptr);
+         if (c > IM_UNICODE_CODEPOINT_MAX || !lazy_ranges.GetBit(c) ||
+             font->FindGlyphNoFallback((ImWchar)c))
+            continue;
+         added |= lazy_glyphs.insert((ImWchar)c).second;
+      }
+   }
+
+   if (added) {
+      lazy_glyphs_gen++;
+      mark_hud_dirty();
+   }
+}
+
+/* Room create_fonts() reserves in an atlas, so that glyphs HUD text asks
+ * for later only need rasterizing into it rather than a new atlas. Slots
+ * are as big as a glyph of the fonts using the lazy ranges can usually
+ * get, plus room for the padding and distances around it. Running out
+ * doubles the slots the next build reserves.
+ */
+struct glyph_slot {
+   uint16_t x, y;
+};
+
+struct lazy_font {
+   ImFont* font;
+   const ImFontConfig* cfg;
+   stbtt_fontinfo info;
+   float scale;
+};
+
+struct glyph_slots {
+   int width = 0, height = 0;
+   int count = 32;
+   std::vector<int> rect_ids;      // until Build() placed them
+   std::vector<glyph_slot> free;
+   std::vector<lazy_font> fonts;
+   bool sdf = false;
+};
+
+static constexpr int max_glyph_slots = 1024;
+
+static std::mutex glyph_slots_mutex;
+static std::map<const ImFontAtlas*, glyph_slots> atlas_glyph_slots;
+
+// texels between a slot's edge and its glyph
+static int glyph_slot_margin(bool sdf)
+{
+   // the distances of a neighbour may reach font_sdf_spread into the slot
+   return sdf ? 2 * (int)font_sdf_spread : 1;
+}
+
+static void reserve_glyph_slots(ImFontAtlas* atlas, glyph_slots& slots,
+                                const ImWchar* lazy_glyph_ranges, bool sdf)
+{
+   slots.width = slots.height = 0;
+   slots.rect_ids.clear();
+   slots.free.clear();
+   slots.fonts.clear();
+   slots.sdf = sdf;
+
+   for (const ImFontConfig& cfg : atlas->ConfigData) {
+      if (cfg.GlyphRanges != lazy_glyph_ranges)
+         continue;
+
+      lazy_font f {};
+      f.font = cfg.DstFont;
+      f.cfg = &cfg;
+      auto data = static_cast<const unsigned char*>(cfg.FontData);
+      if (!stbtt_InitFont(&f.info, data, stbtt_GetFontOffsetForIndex(data, cfg.FontNo)))
+         continue;
+      f.scale = cfg.SizePixels > 0 ? stbtt_ScaleForPixelHeight(&f.info, cfg.SizePixels)
+                                   : stbtt_ScaleForMappingEmToPixels(&f.info, -cfg.SizePixels);
+      slots.fonts.push_back(f);
+
+      // an em and a quarter, CJK glyphs are an em
+      float size = std::fabs(cfg.SizePixels) * 1.25f;
+      int oversample_h = std::max(cfg.OversampleH, 1);
+      int oversample_v = std::max(cfg.OversampleV, 1);
+      slots.width = std::max(slots.width, (int)std::ceil(size * oversample_h) + oversample_h - 1);
+      slots.height = std::max(slots.height, (int)std::ceil(size * oversample_v) + oversample_v - 1);
+   }
+
+   if (slots.fonts.empty())
+      return;
+
+   slots.width += 2 * glyph_slot_margin(sdf);
+   slots.height += 2 * glyph_slot_margin(sdf);
+   for (int i = 0; i < slots.count; i++)
+      slots.rect_ids.push_back(atlas->AddCustomRectRegular(slots.width, slots.height));
+}
+
+// After Build(), the slots are where it packed their rects
+static void place_glyph_slots(ImFontAtlas* atlas, glyph_slots& slots)
+{
+   for (int id : slots.rect_ids) {
+      const ImFontAtlasCustomRect* rect = atlas->GetCustomRectByIndex(id);
+      if (rect->IsPacked())
+         slots.free.push_back({ rect->X, rect->Y });
+   }
+   slots.rect_ids.clear();
+}
+
+// Rasterizes `glyph` of `f` into a free slot the way Build() would have
+static bool add_slot_glyph(ImFontAtlas* atlas, glyph_slots& slots, lazy_font& f,
+                           ImWchar c, int glyph, font_atlas_rect& dirty)
+{
+   const ImFontConfig& cfg = *f.cfg;
+   const int oversample_h = std::max(cfg.OversampleH, 1);
+   const int oversample_v = std::max(cfg.OversampleV, 1);
+   const int margin = glyph_slot_margin(slots.sdf);
+
+   int bx0, by0, bx1, by1;
+   stbtt_GetGlyphBitmapBoxSubpixel(&f.info, glyph, f.scale * oversample_h, f.scale * oversample_v,
+                                   0.f, 0.f, &bx0, &by0, &bx1, &by1);
+   int w = bx1 - bx0 + oversample_h - 1;
+   int h = by1 - by0 + oversample_v - 1;
+   if (slots.free.empty() || w + 2 * margin > slots.width || h + 2 * margin > slots.height)
+      return false;
+
+   const glyph_slot slot = slots.free.back();
+   slots.free.pop_back();
+
+   unsigned char* pixels = atlas->TexPixelsAlpha8;
+   const int width = atlas->TexWidth, height = atlas->TexHeight;
+   const int x = slot.x + margin, y = slot.y + margin;
+   if (w > 0 && h > 0) {
+      float unused_x, unused_y;
+      stbtt_MakeGlyphBitmapSubpixelPrefilter(&f.info, pixels + y * width + x, w, h, width,
+                                             f.scale * oversample_h, f.scale * oversample_v,
+                                             0.f, 0.f, oversample_h, oversample_v,
+                                             &unused_x, &unused_y, glyph);
+      if (cfg.RasterizerMultiply != 1.f)
+         for (int row = 0; row < h; row++)
+            for (int col = 0; col < w; col++) {
+               unsigned char& texel = pixels[(y + row) * width + x + col];
+               texel = (unsigned char)std::min(texel * cfg.RasterizerMultiply, 255.f);
+            }
+   }
+   // stb_truetype's shift for oversampled glyphs
+   const float sub_x = -(float)(oversample_h - 1) / (2.f * oversample_h);
+   const float sub_y = -(float)(oversample_v - 1) / (2.f * oversample_v);
+
+   int advance, lsb;
+   stbtt_GetGlyphHMetrics(&f.info, glyph, &advance, &lsb);
+   const float off_x = cfg.GlyphOffset.x;
+   const float off_y = cfg.GlyphOffset.y + IM_ROUND(f.font->Ascent);
+   const float x0 = (float)bx0 / oversample_h + sub_x, y0 = (float)by0 / oversample_v + sub_y;
+   const float x1 = (float)(bx0 + w) / oversample_h + sub_x, y1 = (float)(by0 + h) / oversample_v + sub_y;
+   // BuildLookupTable() only adds the tab glyph again if it is the last one
+   if (!f.font->Glyphs.empty() && f.font->Glyphs.back().Codepoint == '\t')
+      f.font->Glyphs.pop_back();
+   f.font->AddGlyph(&cfg, c, x0 + off_x, y0 + off_y, x1 + off_x, y1 + off_y,
+                    x * atlas->TexUvScale.x, y * atlas->TexUvScale.y,
+                    (x + w) * atlas->TexUvScale.x, (y + h) * atlas->TexUvScale.y,
+                    f.scale * advance);
+
+   if (slots.sdf) {
+      // leaves the outer font_sdf_spread texels to the neighbours
+      const int spread = (int)font_sdf_spread;
+      const int x_min = slot.x + spread, y_min = slot.y + spread;
+      const int x_max = slot.x + slots.width - spread, y_max = slot.y + slots.height - spread;
+      std::vector<uint8_t> coverage;
+      for (int row = y_min; row < y_max; row++)
+         coverage.insert(coverage.end(), pixels + row * width + x_min, pixels + row * width + x_max);
+      std::vector<float> dist;
+      glyph_sdf(f.font->Glyphs.back(), coverage.data(), x_min, y_min, x_max, y_max,
+                pixels, width, height, dist);
+   }
+
+   if (dirty.x1 <= dirty.x0 || dirty.y1 <= dirty.y0)
+      dirty = { slot.x, slot.y, slot.x, slot.y };
+   dirty.x0 = std::min(dirty.x0, (int)slot.x);
+   dirty.y0 = std::min(dirty.y0, (int)slot.y);
+   dirty.x1 = std::max(dirty.x1, slot.x + slots.width);
+   dirty.y1 = std::max(dirty.y1, slot.y + slots.height);
+   return true;
+}
+
+// The lazy fonts get those of `glyphs` they miss. False when they did not
+// all fit, the atlas then needs building again.
+static bool add_slot_glyphs(ImFontAtlas* atlas, glyph_slots& slots,
+                            const std::vector<ImWchar>& glyphs, font_atlas_rect& dirty)
+{
+   if (!atlas->TexPixelsAlpha8)
+      return false;
+
+   bool fits = true;
+   for (lazy_font& f : slots.fonts) {
+      bool added = false;
+      for (ImWchar c : glyphs) {
+         int glyph = stbtt_FindGlyphIndex(&f.info, c);
+         // Build() skips the ones the font does not have either
+         if (!glyph || f.font->FindGlyphNoFallback(c))
+            continue;
+         if (!add_slot_glyph(atlas, slots, f, c, glyph, dirty)) {
+            if (slots.free.empty())
+               slots.count = std::min(slots.count * 2, max_glyph_slots);
+            fits = false;
+            break;
+         }
+         added = true;
+      }
+      if (added)
+         f.font->BuildLookupTable();
+      if (!fits)
+         return false;
+   }
+   return true;
+}
+
+bool add_requested_glyphs(ImFontAtlas* atlas, font_atlas_rect& dirty)
+{
+   std::vector<ImWchar> requested;
+   {
+      std::lock_guard<std::mutex> lock(lazy_glyphs_mutex);
+      for (ImWchar c : lazy_glyphs)
+         if (lazy_ranges.GetBit(c))
+            requested.push_back(c);
+   }
+
+   std::lock_guard<std::mutex> lock(glyph_slots_mutex);
+   auto it = atlas_glyph_slots.find(atlas);
+   if (it == atlas_glyph_slots.end())
+      return false;
+   return add_slot_glyphs(atlas, it->second, requested, dirty);
+}
+
+float font_sdf_outline(const overlay_params& params, ImVec4& color)
+{
+   color = HUDElements.colors.text_outline;
+   if (!params.enabled[OVERLAY_PARAM_ENABLED_text_outline] || params.text_outline_thickness <= 0.f) {
+      color.w = 0.f;
+      return 0.f;
+   }
+   // past the spread everything reads as far outside
+   return std::min(params.text_outline_thickness, font_sdf_spread - 0.5f);
+}
+
+/* Built atlases are kept in $XDG_CACHE_HOME/MangoHud/fonts, keyed by
+ * everything Build() and build_font_sdf() depend on, so that only the
+ * first process of a game rasterizes anything. Lazily added glyphs are
+ * not part of the key, the file lists the ones it has. Those it misses go
+ * in the glyph slots, the file is replaced when they do not fit.
+ */
+struct font_cache_header {
+   char magic[8];
+   uint64_t key;
+   int32_t tex_width, tex_height;
+   ImVec2 uv_scale, uv_white_pixel;
+   ImVec4 uv_lines[IM_DRAWLIST_TEX_LINES_WIDTH_MAX + 1];
+   uint32_t font_count;
+   uint32_t lazy_glyph_count;
+   uint32_t glyph_slot_count;
+};
+
+// followed by lazy_glyph_count sorted ImWchar and glyph_slot_count
+// glyph_slot, then per font the glyph count and its ImFontGlyph, after the
+// last font the texels
+struct font_cache_font {
+   float size, ascent, descent;
+   uint32_t glyph_count;
+};
+
+static const char font_cache_magic[8] = "MHFONT3";
+static constexpr size_t font_cache_max_files = 16;
+
+static std::mutex font_cache_write_mutex;
+static std::future<void> font_cache_write;
+
+static uint64_t hash_bytes(uint64_t hash, const void* data, size_t size)
+{
+   // FNV-1a over 8 byte words, font files are megabytes
+   auto p = static_cast<const uint8_t*>(data);
+   for (; size >= 8; p += 8, size -= 8) {
+      uint64_t word;
+      memcpy(&word, p, sizeof(word));
+      hash = (hash ^ word) * 0x100000001b3ull;
+      hash ^= hash >> 29;
+   }
+   for (; size; p++, size--)
+      hash = (hash ^ *p) * 0x100000001b3ull;
+   return hash;
+}
+
+// Fonts using `lazy_glyph_ranges` are keyed by the glyphs they may get,
+// `lazy_bits`, rather than by the ones they have now
+static uint64_t font_atlas_key(const ImFontAtlas* atlas, bool sdf,
+                               const ImWchar* lazy_glyph_ranges,
+                               const ImVector<ImU32>& lazy_bits)
+{
+   // the layout differs between 32 and 64-bit processes
+   const int layout[] = {
+      IMGUI_VERSION_NUM, (int)sizeof(void*), (int)sizeof(font_cache_header),
+      (int)sizeof(ImFontGlyph), sdf, (int)font_sdf_spread,
+      atlas->Flags, atlas->TexDesiredWidth, atlas->TexGlyphPadding,
+   };
+   uint64_t key = hash_bytes(0xcbf29ce484222325ull, layout, sizeof(layout));
+
+   for (const ImFontConfig& cfg : atlas->ConfigData) {
+      key = hash_bytes(key, cfg.FontData, cfg.FontDataSize);
+      const float metrics[] = {
+         cfg.SizePixels, cfg.GlyphExtraSpacing.x, cfg.GlyphExtraSpacing.y,
+         cfg.GlyphOffset.x, cfg.GlyphOffset.y, cfg.GlyphMinAdvanceX,
+         cfg.GlyphMaxAdvanceX, cfg.RasterizerMultiply,
+      };
+      key = hash_bytes(key, metrics, sizeof(metrics));
+      const int options[] = {
+         cfg.FontNo, cfg.OversampleH, cfg.OversampleV, cfg.PixelSnapH,
+         cfg.MergeMode, (int)cfg.FontBuilderFlags, (int)cfg.EllipsisChar,
+         cfg.GlyphRanges == lazy_glyph_ranges,
+      };
+      key = hash_bytes(key, options, sizeof(options));
+      if (cfg.GlyphRanges == lazy_glyph_ranges) {
+         key = hash_bytes(key, lazy_bits.Data, lazy_bits.size_in_bytes());
+         continue;
+      }
+      for (const ImWchar* range = cfg.GlyphRanges; range && range[0]; range += 2)
+         key = hash_bytes(key, range, 2 * sizeof(ImWchar));
+   }
+   // the glyph slots
+   for (const ImFontAtlasCustomRect& rect : atlas->CustomRects) {
+      const int size[] = { rect.Width, rect.Height };
+      key = hash_bytes(key, size, sizeof(size));
+   }
+   return key;
+}
+
+static std::string font_cache_path(uint64_t key)
+{
+   std::string dir = get_cache_dir();
+   if (dir.empty())
+      return dir;
+
+   char name[48];
+   snprintf(name, sizeof(name), "/MangoHud/fonts/%016" PRIx64 ".bin", key);
+   return dir + name;
+}
+
+// Reads the header, the lazy glyphs and the glyph slots, leaves `file` at
+// the first font
+static bool read_font_cache_header(std::ifstream& file, uint64_t key,
+                                   font_cache_header& header,
+                                   std::vector<ImWchar>& lazy,
+                                   std::vector<glyph_slot>& slots)
+{
+   if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+       memcmp(header.magic, font_cache_magic, sizeof(header.magic)) ||
+       header.key != key || header.lazy_glyph_count > IM_UNICODE_CODEPOINT_MAX + 1 ||
+       header.glyph_slot_count > (uint32_t)max_glyph_slots)
+      return false;
+
+   lazy.resize(header.lazy_glyph_count);
+   slots.resize(header.glyph_slot_count);
+   return file.read(reinterpret_cast<char*>(lazy.data()), lazy.size() * sizeof(ImWchar)) &&
+          file.read(reinterpret_cast<char*>(slots.data()), slots.size() * sizeof(glyph_slot));
+}
+
+// Sets up `atlas`, with its fonts added, the way Build() would have, and
+// the glyph slots it has. `cached` gets the lazy glyphs the file has, also
+// when it fails, so that the next build can include them.
+static bool load_font_atlas(ImFontAtlas* atlas, const std::string& path, uint64_t key,
+                            std::vector<ImWchar>& cached, std::vector<glyph_slot>& slots)
+{
+   std::ifstream file(path, std::ios::binary);
+   font_cache_header header;
+   if (!read_font_cache_header(file, key, header, cached, slots)) {
+      cached.clear();
+      return false;
+   }
+
+   if (header.font_count != (uint32_t)atlas->Fonts.Size ||
+       header.tex_width <= 0 || header.tex_height <= 0)
+      return false;
+
+   std::vector<font_cache_font> fonts(header.font_count);
+   std::vector<ImVector<ImFontGlyph>> glyphs(header.font_count);
+   for (uint32_t i = 0; i < header.font_count; i++) {
+      if (!file.read(reinterpret_cast<char*>(&fonts[i]), sizeof(fonts[i])) ||
+          fonts[i].glyph_count > IM_UNICODE_CODEPOINT_MAX + 2)
+         return false;
+      glyphs[i].resize(fonts[i].glyph_count);
+      if (!file.read(reinterpret_cast<char*>(glyphs[i].Data), glyphs[i].size_in_bytes()))
+         return false;
+   }
+
+   size_t tex_size = size_t(header.tex_width) * header.tex_height;
+   auto pixels = static_cast<unsigned char*>(IM_ALLOC(tex_size));
+   if (!file.read(reinterpret_cast<char*>(pixels), tex_size)) {
+      IM_FREE(pixels);
+      return false;
+   }
+
+   atlas->ClearTexData();
+   atlas->TexPixelsAlpha8 = pixels;
+   atlas->TexWidth = header.tex_width;
+   atlas->TexHeight = header.tex_height;
+   atlas->TexUvScale = header.uv_scale;
+   atlas->TexUvWhitePixel = header.uv_white_pixel;
+   memcpy(atlas->TexUvLines, header.uv_lines, sizeof(header.uv_lines));
+
+   for (uint32_t i = 0; i < header.font_count; i++) {
+      ImFont* font = atlas->Fonts[i];
+      font->ClearOutputData();
+      font->FontSize = fonts[i].size;
+      font->Ascent = fonts[i].ascent;
+      font->Descent = fonts[i].descent;
+      font->ContainerAtlas = atlas;
+      font->ConfigData = nullptr;
+      font->ConfigDataCount = 0;
+      for (ImFontConfig& cfg : atlas->ConfigData) {
+         if (cfg.DstFont != font)
+            continue;
+         if (!font->ConfigData)
+            font->ConfigData = &cfg;
+         font->ConfigDataCount++;
+      }
+      font->Glyphs.swap(glyphs[i]);
+      font->BuildLookupTable();
+   }
+   atlas->TexReady = true;
+   return true;
+}
+
+// Drops the least recently written atlases past font_cache_max_files,
+// fonts or sizes the user stopped using
+static void prune_font_cache(const std::string& dir)
+{
+   std::error_code ec;
+   std::vector<std::pair<fs::file_time_type, fs::path>> files;
+   for (const auto& entry : fs::directory_iterator(dir, ec)) {
+      if (entry.path().extension() != ".bin")
+         continue;
+      auto time = fs::last_write_time(entry.path(), ec);
+      if (!ec)
+         files.emplace_back(time, entry.path());
+   }
+
+   if (files.size() <= font_cache_max_files)
+      return;
+
+   std::sort(files.begin(), files.end(),
+             [](const auto& a, const auto& b) { return a.first > b.first; });
+   for (size_t i = font_cache_max_files; i < files.size(); i++)
+      fs::remove(files[i].second, ec);
+}
+
+static void save_font_atlas(const ImFontAtlas* atlas, const std::string& path, uint64_t key,
+                            const std::vector<ImWchar>& lazy, const std::vector<glyph_slot>& slots)
+{
+   if (!atlas->TexPixelsAlpha8)
+      return;
+
+   font_cache_header header {};
+   memcpy(header.magic, font_cache_magic, sizeof(header.magic));
+   header.key = key;
+   header.tex_width = atlas->TexWidth;
+   header.tex_height = atlas->TexHeight;
+   header.uv_scale = atlas->TexUvScale;
+   header.uv_white_pixel = atlas->TexUvWhitePixel;
+   memcpy(header.uv_lines, atlas->TexUvLines, sizeof(header.uv_lines));
+   header.font_count = atlas->Fonts.Size;
+   header.lazy_glyph_count = lazy.size();
+   header.glyph_slot_count = slots.size();
+
+   std::string blob(reinterpret_cast<const char*>(&header), sizeof(header));
+   blob.append(reinterpret_cast<const char*>(lazy.data()), lazy.size() * sizeof(ImWchar));
+   blob.append(reinterpret_cast<const char*>(slots.data()), slots.size() * sizeof(glyph_slot));
+   for (const ImFont* font : atlas->Fonts) {
+      font_cache_font f { font->FontSize, font->Ascent, font->Descent, (uint32_t)font->Glyphs.Size };
+      blob.append(reinterpret_cast<const char*>(&f), sizeof(f));
+      blob.append(reinterpret_cast<const char*>(font->Glyphs.Data), font->Glyphs.size_in_bytes());
+   }
+   blob.append(reinterpret_cast<const char*>(atlas->TexPixelsAlpha8),
+               size_t(atlas->TexWidth) * atlas->TexHeight);
+
+   // create_fonts runs on the render thread, the atlas can be megabytes.
+   // Replacing the future waits for the previous write, and so does the
+   // destructor when the layer is unloaded.
+   std::lock_guard<std::mutex> lock(font_cache_write_mutex);
+   font_cache_write = std::async(std::launch::async, [path, blob = std::move(blob)] {
+      if (!replace_file(path, blob.data(), blob.size())) {
+         SPDLOG_DEBUG("Failed to write font cache {}", path);
+         return;
+      }
+      prune_font_cache(fs::path(path).parent_path().string());
+   });
+}
+
+void create_fonts(ImFontAtlas* font_atlas, const overlay_params& params, ImFont*& small_font, ImFont*& text_font, ImFont*& secondary_font, bool sdf)
 {
    auto& io = ImGui::GetIO();
    if (!font_atlas)
@@ -44,31 +714,50 @@ void create_fonts(ImFontAtlas* font_atlas, const overlay_params& params, ImFont*
     config.PixelSnapH = true;
     static const ImWchar icon_ranges[] = { ICON_MIN_FK, ICON_MAX_FK, 0 };
 
-   ImVector<ImWchar> glyph_ranges;
-   ImFontGlyphRangesBuilder builder;
-   builder.AddRanges(font_atlas->GetGlyphRangesDefault());
+   // distances are measured in texels, which have to be as wide as pixels
+   ImFontConfig sdf_config;
+   sdf_config.OversampleH = 1;
+   const ImFontConfig* text_config = sdf ? &sdf_config : nullptr;
+
+   // Rasterizing all of font_glyph_ranges takes long and makes huge atlases
+   // (tens of thousands of CJK glyphs), add the ones HUD text used so far
+   ImFontGlyphRangesBuilder ranges;
    if (params.font_glyph_ranges & FG_KOREAN)
-      builder.AddRanges(font_atlas->GetGlyphRangesKorean());
+      ranges.AddRanges(font_atlas->GetGlyphRangesKorean());
    if (params.font_glyph_ranges & FG_CHINESE_FULL)
-      builder.AddRanges(font_atlas->GetGlyphRangesChineseFull());
+      ranges.AddRanges(font_atlas->GetGlyphRangesChineseFull());
    if (params.font_glyph_ranges & FG_CHINESE_SIMPLIFIED)
-      builder.AddRanges(font_atlas->GetGlyphRangesChineseSimplifiedCommon());
+      ranges.AddRanges(font_atlas->GetGlyphRangesChineseSimplifiedCommon());
    if (params.font_glyph_ranges & FG_JAPANESE)
-      builder.AddRanges(font_atlas->GetGlyphRangesJapanese()); // Not exactly Shift JIS compatible?
+      ranges.AddRanges(font_atlas->GetGlyphRangesJapanese()); // Not exactly Shift JIS compatible?
    if (params.font_glyph_ranges & FG_CYRILLIC)
-      builder.AddRanges(font_atlas->GetGlyphRangesCyrillic());
+      ranges.AddRanges(font_atlas->GetGlyphRangesCyrillic());
    if (params.font_glyph_ranges & FG_THAI)
-      builder.AddRanges(font_atlas->GetGlyphRangesThai());
+      ranges.AddRanges(font_atlas->GetGlyphRangesThai());
    if (params.font_glyph_ranges & FG_VIETNAMESE)
-      builder.AddRanges(font_atlas->GetGlyphRangesVietnamese());
+      ranges.AddRanges(font_atlas->GetGlyphRangesVietnamese());
    if (params.font_glyph_ranges & FG_LATIN_EXT_A) {
       constexpr ImWchar latin_ext_a[] { 0x0100, 0x017F, 0 };
-      builder.AddRanges(latin_ext_a);
+      ranges.AddRanges(latin_ext_a);
    }
    if (params.font_glyph_ranges & FG_LATIN_EXT_B) {
       constexpr ImWchar latin_ext_b[] { 0x0180, 0x024F, 0 };
-      builder.AddRanges(latin_ext_b);
+      ranges.AddRanges(latin_ext_b);
+   }
+
+   ImVector<ImWchar> glyph_ranges;
+   ImFontGlyphRangesBuilder builder;
+   builder.AddRanges(font_atlas->GetGlyphRangesDefault());
+   std::vector<ImWchar> lazy;
+   {
+      std::lock_guard<std::mutex> lock(lazy_glyphs_mutex);
+      lazy_ranges = ranges;
+      for (ImWchar c : lazy_glyphs)
+         if (ranges.GetBit(c))
+            lazy.push_back(c);
    }
+   for (ImWchar c : lazy)
+      builder.AddChar(c);
    builder.BuildRanges(&glyph_ranges);
 
    bool same_font = (params.font_file == params.font_file_text || params.font_file_text.empty());
@@ -77,34 +766,34 @@ void create_fonts(ImFontAtlas* font_atlas, const overlay_params& params, ImFont*
 
    // ImGui takes ownership of the data, no need to free it
    if (!params.font_file.empty() && file_exists(params.font_file)) {
-      font_atlas->AddFontFromFileTTF(params.font_file.c_str(), font_size, nullptr, same_font && text_same_size ? glyph_ranges.Data : default_range);
+      font_atlas->AddFontFromFileTTF(params.font_file.c_str(), font_size, text_config, same_font && text_same_size ? glyph_ranges.Data : default_range);
       font_atlas->AddFontFromMemoryCompressedBase85TTF(forkawesome_compressed_data_base85, font_size, &config, icon_ranges);
       if (params.no_small_font)
          small_font = font_atlas->Fonts[0];
       else {
-         small_font = font_atlas->AddFontFromFileTTF(params.font_file.c_str(), font_size * 0.55f, nullptr, default_range);
+         small_font = font_atlas->AddFontFromFileTTF(params.font_file.c_str(), font_size * 0.55f, text_config, default_range);
          font_atlas->AddFontFromMemoryCompressedBase85TTF(forkawesome_compressed_data_base85, font_size * 0.55f, &config, icon_ranges);
       }
       if (secondary_same_size) {
          secondary_font = font_atlas->Fonts[0];
       } else {
-         secondary_font = font_atlas->AddFontFromFileTTF(params.font_file.c_str(), font_size_secondary, nullptr, default_range);
+         secondary_font = font_atlas->AddFontFromFileTTF(params.font_file.c_str(), font_size_secondary, text_config, default_range);
          font_atlas->AddFontFromMemoryCompressedBase85TTF(forkawesome_compressed_data_base85, font_size_secondary, &config, icon_ranges);
       }
    } else {
       const char* ttf_compressed_base85 = GetDefaultCompressedFontDataTTFBase85();
-      font_atlas->AddFontFromMemoryCompressedBase85TTF(ttf_compressed_base85, font_size, nullptr, default_range);
+      font_atlas->AddFontFromMemoryCompressedBase85TTF(ttf_compressed_base85, font_size, text_config, default_range);
       font_atlas->AddFontFromMemoryCompressedBase85TTF(forkawesome_compressed_data_base85, font_size, &config, icon_ranges);
       if (params.no_small_font)
          small_font = font_atlas->Fonts[0];
       else {
-         small_font = font_atlas->AddFontFromMemoryCompressedBase85TTF(ttf_compressed_base85, font_size * 0.55f, nullptr, default_range);
+         small_font = font_atlas->AddFontFromMemoryCompressedBase85TTF(ttf_compressed_base85, font_size * 0.55f, text_config, default_range);
          font_atlas->AddFontFromMemoryCompressedBase85TTF(forkawesome_compressed_data_base85, font_size * 0.55f, &config, icon_ranges);
       }
       if (secondary_same_size) {
          secondary_font = font_atlas->Fonts[0];
       } else {
-         secondary_font = font_atlas->AddFontFromMemoryCompressedBase85TTF(ttf_compressed_base85, font_size_secondary, nullptr, default_range);
+         secondary_font = font_atlas->AddFontFromMemoryCompressedBase85TTF(ttf_compressed_base85, font_size_secondary, text_config, default_range);
          font_atlas->AddFontFromMemoryCompressedBase85TTF(forkawesome_compressed_data_base85, font_size_secondary, &config, icon_ranges);
       }
    }
@@ -114,9 +803,67 @@ void create_fonts(ImFontAtlas* font_atlas, const overlay_params& params, ImFont*
       font_file_text = params.font_file;
 
    if ((!same_font || !text_same_size) && file_exists(font_file_text))
-      text_font = font_atlas->AddFontFromFileTTF(font_file_text.c_str(), font_size_text, nullptr, glyph_ranges.Data);
+      text_font = font_atlas->AddFontFromFileTTF(font_file_text.c_str(), font_size_text, text_config, glyph_ranges.Data);
    else
       text_font = font_atlas->Fonts[0];
 
-   font_atlas->Build();
+   // the distances need room around the glyphs, and the baked lines would
+   // be decoded as distances too
+   font_atlas->TexGlyphPadding = sdf ? 2 * (int)font_sdf_spread : 1;
+   if (sdf)
+      font_atlas->Flags |= ImFontAtlasFlags_NoBakedLines;
+   else
+      font_atlas->Flags &= ~ImFontAtlasFlags_NoBakedLines;
+
+   std::unique_lock<std::mutex> slots_lock(glyph_slots_mutex);
+   glyph_slots& slots = atlas_glyph_slots[font_atlas];
+   reserve_glyph_slots(font_atlas, slots, glyph_ranges.Data, sdf);
+
+   uint64_t key = font_atlas_key(font_atlas, sdf, glyph_ranges.Data, ranges.UsedChars);
+   std::string cache_path = font_cache_path(key);
+   std::vector<ImWchar> cached, missing;
+   bool loaded = !cache_path.empty() &&
+                 load_font_atlas(font_atlas, cache_path, key, cached, slots.free);
+   if (loaded) {
+      std::set_difference(lazy.begin(), lazy.end(), cached.begin(), cached.end(),
+                          std::back_inserter(missing));
+      // the whole texture gets uploaded anyway
+      font_atlas_rect dirty;
+      loaded = add_slot_glyphs(font_atlas, slots, missing, dirty);
+   }
+
+   if (loaded) {
+      SPDLOG_DEBUG("Loaded font atlas from {}, added {} glyphs", cache_path, missing.size());
+      slots.rect_ids.clear();
+   } else {
+      slots.free.clear();
+      // keep what the cached atlas had, so that it only ever grows
+      ImVector<ImWchar> merged_ranges;
+      if (!cached.empty()) {
+         for (ImWchar c : cached)
+            builder.AddChar(c);
+         builder.BuildRanges(&merged_ranges);
+         for (ImFontConfig& cfg : font_atlas->ConfigData)
+            if (cfg.GlyphRanges == glyph_ranges.Data)
+               cfg.GlyphRanges = merged_ranges.Data;
+
+         std::vector<ImWchar> all;
+         std::set_union(lazy.begin(), lazy.end(), cached.begin(), cached.end(),
+                        std::back_inserter(all));
+         lazy.swap(all);
+      }
+
+      font_atlas->Build();
+      place_glyph_slots(font_atlas, slots);
+      if (sdf)
+         build_font_sdf(font_atlas);
+      if (!cache_path.empty())
+         save_font_atlas(font_atlas, cache_path, key, lazy, slots.free);
+      cached = lazy;
+   }
+   slots_lock.unlock();
+
+   // the atlas has these now, later builds should too
+   std::lock_guard<std::mutex> lock(lazy_glyphs_mutex);
+   lazy_glyphs.insert(cached.begin(), cached.end());
 }
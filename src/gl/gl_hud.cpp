@@ -179,8 +179,10 @@ void imgui_create(gl_context *ctx, const gl_wsi plat)
 
     ImGui_ImplOpenGL3_Init(ctx);
 
-    create_fonts(nullptr, params, sw_stats.font_small, sw_stats.font_text, sw_stats.font_secondary);
+    sw_stats.font_sdf = params.enabled[OVERLAY_PARAM_ENABLED_font_sdf];
+    create_fonts(nullptr, params, sw_stats.font_small, sw_stats.font_text, sw_stats.font_secondary, sw_stats.font_sdf);
     sw_stats.font_params_hash = params.font_params_hash;
+    sw_stats.font_glyphs_generation = lazy_glyphs_generation();
     inited = true;
 
     // Restore global context or ours might clash with apps that use Dear ImGui
@@ -225,25 +227,56 @@ void imgui_render(gl_context *ctx, unsigned int width, unsigned int height)
     if (HUDElements.colors.update)
         HUDElements.convert_colors(params);
 
-    if (sw_stats.font_params_hash != params.font_params_hash)
+    uint32_t glyphs_generation = lazy_glyphs_generation();
+    bool rebuild = sw_stats.font_params_hash != params.font_params_hash;
+    if (!rebuild && sw_stats.font_glyphs_generation != glyphs_generation) {
+        font_atlas_rect dirty;
+        rebuild = !add_requested_glyphs(ImGui::GetIO().Fonts, dirty);
+        if (!rebuild)
+            ImGui_ImplOpenGL3_UpdateFontsTexture(ctx, dirty.y0, dirty.y1);
+        sw_stats.font_glyphs_generation = glyphs_generation;
+        // the previous draw data was measured and drawn without them
+        mark_hud_dirty();
+    }
+    if (rebuild)
     {
         sw_stats.font_params_hash = params.font_params_hash;
-        create_fonts(nullptr, params, sw_stats.font_small, sw_stats.font_text, sw_stats.font_secondary);
+        sw_stats.font_glyphs_generation = glyphs_generation;
+        // the previous draw data points into the old atlas
+        mark_hud_dirty();
+        sw_stats.font_sdf = params.enabled[OVERLAY_PARAM_ENABLED_font_sdf];
+        create_fonts(nullptr, params, sw_stats.font_small, sw_stats.font_text, sw_stats.font_secondary, sw_stats.font_sdf);
         ImGui_ImplOpenGL3_CreateFontsTexture(ctx);
     }
 
     ImGui_ImplOpenGL3_NewFrame(ctx);
-    ImGui::NewFrame();
-    {
-        std::lock_guard<std::mutex> lk(notifier.mutex);
-        overlay_new_frame(params);
-        position_layer(sw_stats, params, window_size);
-        render_imgui(sw_stats, params, window_size, false);
-        overlay_end_frame();
-    }
+    // otherwise redraw the previous frame's draw data
+    bool rebuilt = hud_needs_rebuild(sw_stats, ImGui::GetIO().DisplaySize);
+    if (rebuilt) {
+        ImGui::NewFrame();
+        {
+            std::lock_guard<std::mutex> lk(notifier.mutex);
+            overlay_new_frame(params);
+            position_layer(sw_stats, params, window_size);
+            render_imgui(sw_stats, params, window_size, false);
+            overlay_end_frame();
+        }
 
-    ImGui::Render();
-    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        ImGui::Render();
+    }
+    ctx->SdfSpread = 0.0f;
+    if (sw_stats.font_sdf) {
+        ImVec4 outline_color;
+        ctx->SdfSpread = font_sdf_spread;
+        ctx->SdfOutline = font_sdf_outline(params, outline_color);
+        ctx->SdfOutlineColor[0] = outline_color.x;
+        ctx->SdfOutlineColor[1] = outline_color.y;
+        ctx->SdfOutlineColor[2] = outline_color.z;
+        ctx->SdfOutlineColor[3] = outline_color.w;
+    }
+    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData(),
+                                     params.enabled[OVERLAY_PARAM_ENABLED_hud_retained],
+                                     rebuilt);
     ImGui::SetCurrentContext(saved_ctx);
 }
 
@@ -69,7 +69,9 @@
 #include "gl_renderer.h"
 #include <stdio.h>
 #include <stdint.h>     // intptr_t
+#include <float.h>
 #include <sstream>
+#include <algorithm>
 
 #include <spdlog/spdlog.h>
 #include <glad/glad.h>
@@ -85,6 +87,7 @@ static gl_context* g_current_ctx;
 static GLuint      g_GlVersion = 0;                // Extracted at runtime using GL_MAJOR_VERSION, GL_MINOR_VERSION queries.
 static char        g_GlslVersionString[32] = "";   // Specified by user or detected based on compile time GL settings.
 static bool        g_IsGLES = false;
+static bool        g_ClipOriginLowerLeft = true;   // GL_CLIP_ORIGIN, read by ImGui_ImplOpenGL3_BackupState
 
 // Functions
 static void ImGui_ImplOpenGL3_DestroyFontsTexture(gl_context *ctx)
@@ -136,6 +139,34 @@ bool ImGui_ImplOpenGL3_CreateFontsTexture(gl_context *ctx)
     return true;
 }
 
+void ImGui_ImplOpenGL3_UpdateFontsTexture(gl_context *ctx, int y0, int y1)
+{
+    ImGuiIO& io = ImGui::GetIO();
+    unsigned char* pixels;
+    int width, height;
+    io.Fonts->GetTexDataAsAlpha8(&pixels, &width, &height);
+    if (!ctx->FontTexture || y0 >= y1)
+        return;
+
+    GLint last_texture, last_unpack_buffer;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &last_texture);
+    glBindTexture(GL_TEXTURE_2D, ctx->FontTexture);
+    if ((g_IsGLES && g_GlVersion >= 300) || (!g_IsGLES && g_GlVersion >= 210))
+    {
+        glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &last_unpack_buffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    if (g_IsGLES || g_GlVersion >= 200)
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+    // whole rows, GLES 2 has no GL_UNPACK_SKIP_PIXELS
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y0, width, y1 - y0, GL_RED, GL_UNSIGNED_BYTE, pixels + y0 * width);
+
+    glBindTexture(GL_TEXTURE_2D, last_texture);
+    if ((g_IsGLES && g_GlVersion >= 300) || (!g_IsGLES && g_GlVersion >= 210))
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, last_unpack_buffer);
+}
+
 // If you get an error please report on github. You may try different GL context version or GLSL version. See GL<>GLSL version table at the top of this file.
 static bool CheckShader(GLuint handle, const char* desc)
 {
@@ -172,6 +203,31 @@ static bool CheckProgram(GLuint handle, const char* desc)
     return (GLboolean)status == GL_TRUE;
 }
 
+// font_sdf: Texture holds distances to the glyph edges when SdfSpread is not
+// 0, see create_fonts(). Text and outline are drawn in one pass.
+#define SDF_COLOR_GLSL \
+    "uniform float SdfSpread;\n" \
+    "uniform float SdfOutline;\n" \
+    "uniform vec4 SdfOutlineColor;\n" \
+    "vec4 sdf_color(vec4 color, float value)\n" \
+    "{\n" \
+    "    if (SdfSpread == 0.0)\n" \
+    "        return color * vec4(1, 1, 1, value);\n" \
+    "    float dist = (value - 0.5) * 2.0 * SdfSpread;\n" \
+    "#if defined(GL_ES) && __VERSION__ < 300\n" \
+    "    float aa = 1.0;\n" \
+    "#else\n" \
+    "    float aa = max(fwidth(dist), 0.001);\n" \
+    "#endif\n" \
+    "    float fill = clamp(dist / aa + 0.5, 0.0, 1.0);\n" \
+    "    float outline = clamp((dist + SdfOutline) / aa + 0.5, 0.0, 1.0);\n" \
+    "    float fill_alpha = color.a * fill;\n" \
+    "    float outline_alpha = SdfOutlineColor.a * max(outline - fill, 0.0);\n" \
+    "    float alpha = fill_alpha + outline_alpha;\n" \
+    "    vec3 rgb = color.rgb * fill_alpha + SdfOutlineColor.rgb * outline_alpha;\n" \
+    "    return vec4(rgb / max(alpha, 0.0001), alpha);\n" \
+    "}\n"
+
 static bool    ImGui_ImplOpenGL3_CreateDeviceObjects(gl_context *ctx)
 {
     // Parse GLSL version string
@@ -243,9 +299,10 @@ static bool    ImGui_ImplOpenGL3_CreateDeviceObjects(gl_context *ctx)
         "uniform sampler2D Texture;\n"
         "varying vec2 Frag_UV;\n"
         "varying vec4 Frag_Color;\n"
+        SDF_COLOR_GLSL
         "void main()\n"
         "{\n"
-        "    gl_FragColor = Frag_Color * vec4(1, 1, 1, texture2D(Texture, Frag_UV.st).r);\n"
+        "    gl_FragColor = sdf_color(Frag_Color, texture2D(Texture, Frag_UV.st).r);\n"
         "}\n";
 
     const GLchar* fragment_shader_glsl_130 =
@@ -253,9 +310,10 @@ static bool    ImGui_ImplOpenGL3_CreateDeviceObjects(gl_context *ctx)
         "in vec2 Frag_UV;\n"
         "in vec4 Frag_Color;\n"
         "out vec4 Out_Color;\n"
+        SDF_COLOR_GLSL
         "void main()\n"
         "{\n"
-        "    Out_Color = Frag_Color * vec4(1, 1, 1, texture(Texture, Frag_UV.st).r);\n"
+        "    Out_Color = sdf_color(Frag_Color, texture(Texture, Frag_UV.st).r);\n"
         "}\n";
 
     const GLchar* fragment_shader_glsl_300_es =
@@ -264,9 +322,10 @@ static bool    ImGui_ImplOpenGL3_CreateDeviceObjects(gl_context *ctx)
         "in vec2 Frag_UV;\n"
         "in vec4 Frag_Color;\n"
         "layout (location = 0) out vec4 Out_Color;\n"
+        SDF_COLOR_GLSL
         "void main()\n"
         "{\n"
-        "    Out_Color = Frag_Color * vec4(1, 1, 1, texture(Texture, Frag_UV.st).r);\n"
+        "    Out_Color = sdf_color(Frag_Color, texture(Texture, Frag_UV.st).r);\n"
         "}\n";
 
     const GLchar* fragment_shader_glsl_410_core =
@@ -274,9 +333,42 @@ static bool    ImGui_ImplOpenGL3_CreateDeviceObjects(gl_context *ctx)
         "in vec4 Frag_Color;\n"
         "uniform sampler2D Texture;\n"
         "layout (location = 0) out vec4 Out_Color;\n"
+        SDF_COLOR_GLSL
+        "void main()\n"
+        "{\n"
+        "    Out_Color = sdf_color(Frag_Color, texture(Texture, Frag_UV.st).r);\n"
+        "}\n";
+
+    // Copies HudTexture, which holds premultiplied colors
+    const GLchar* composite_fragment_shader_glsl_130 =
+        "uniform sampler2D Texture;\n"
+        "in vec2 Frag_UV;\n"
+        "in vec4 Frag_Color;\n"
+        "out vec4 Out_Color;\n"
         "void main()\n"
         "{\n"
-        "    Out_Color = Frag_Color * vec4(1, 1, 1, texture(Texture, Frag_UV.st).r);\n"
+        "    Out_Color = Frag_Color * texture(Texture, Frag_UV.st);\n"
+        "}\n";
+
+    const GLchar* composite_fragment_shader_glsl_300_es =
+        "precision mediump float;\n"
+        "uniform sampler2D Texture;\n"
+        "in vec2 Frag_UV;\n"
+        "in vec4 Frag_Color;\n"
+        "layout (location = 0) out vec4 Out_Color;\n"
+        "void main()\n"
+        "{\n"
+        "    Out_Color = Frag_Color * texture(Texture, Frag_UV.st);\n"
+        "}\n";
+
+    const GLchar* composite_fragment_shader_glsl_410_core =
+        "in vec2 Frag_UV;\n"
+        "in vec4 Frag_Color;\n"
+        "uniform sampler2D Texture;\n"
+        "layout (location = 0) out vec4 Out_Color;\n"
+        "void main()\n"
+        "{\n"
+        "    Out_Color = Frag_Color * texture(Texture, Frag_UV.st);\n"
         "}\n";
 
     SPDLOG_DEBUG("glsl_version: {}", glsl_version);
@@ -284,6 +376,7 @@ static bool    ImGui_ImplOpenGL3_CreateDeviceObjects(gl_context *ctx)
     // Select shaders matching our GLSL versions
     const GLchar* vertex_shader = NULL;
     const GLchar* fragment_shader = NULL;
+    const GLchar* composite_fragment_shader = NULL;
     if (glsl_version < 130)
     {
         vertex_shader = vertex_shader_glsl_120;
@@ -293,16 +386,19 @@ static bool    ImGui_ImplOpenGL3_CreateDeviceObjects(gl_context *ctx)
     {
         vertex_shader = vertex_shader_glsl_410_core;
         fragment_shader = fragment_shader_glsl_410_core;
+        composite_fragment_shader = composite_fragment_shader_glsl_410_core;
     }
     else if (glsl_version == 300)
     {
         vertex_shader = vertex_shader_glsl_300_es;
         fragment_shader = fragment_shader_glsl_300_es;
+        composite_fragment_shader = composite_fragment_shader_glsl_300_es;
     }
     else
     {
         vertex_shader = vertex_shader_glsl_130;
         fragment_shader = fragment_shader_glsl_130;
+        composite_fragment_shader = composite_fragment_shader_glsl_130;
     }
 
     std::stringstream ss;
@@ -339,22 +435,75 @@ static bool    ImGui_ImplOpenGL3_CreateDeviceObjects(gl_context *ctx)
     ctx->AttribLocationVtxPos = glGetAttribLocation(ctx->ShaderHandle, "Position");
     ctx->AttribLocationVtxUV = glGetAttribLocation(ctx->ShaderHandle, "UV");
     ctx->AttribLocationVtxColor = glGetAttribLocation(ctx->ShaderHandle, "Color");
+    ctx->AttribLocationSdfSpread = glGetUniformLocation(ctx->ShaderHandle, "SdfSpread");
+    ctx->AttribLocationSdfOutline = glGetUniformLocation(ctx->ShaderHandle, "SdfOutline");
+    ctx->AttribLocationSdfOutlineColor = glGetUniformLocation(ctx->ShaderHandle, "SdfOutlineColor");
     SPDLOG_DEBUG("g_AttribLocationTex {}, g_AttribLocationProjMtx {}, g_AttribLocationVtxPos {}, g_AttribLocationVtxUV {}, g_AttribLocationVtxColor {}",
                  ctx->AttribLocationTex, ctx->AttribLocationProjMtx, ctx->AttribLocationVtxPos, ctx->AttribLocationVtxUV, ctx->AttribLocationVtxColor);
 
+    // HudTexture needs framebuffer objects, without them the HUD is always drawn directly
+    if (composite_fragment_shader && g_GlVersion >= 300)
+    {
+        ss.str(""); ss.clear();
+        ss << g_GlslVersionString << composite_fragment_shader;
+        shader = ss.str();
+
+        const GLchar* composite_shader_with_version[1] = { shader.c_str() };
+        ctx->CompositeFragHandle = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(ctx->CompositeFragHandle, 1, composite_shader_with_version, NULL);
+        glCompileShader(ctx->CompositeFragHandle);
+        CheckShader(ctx->CompositeFragHandle, "composite fragment shader");
+
+        ctx->CompositeShaderHandle = glCreateProgram();
+        glAttachShader(ctx->CompositeShaderHandle, ctx->VertHandle);
+        glAttachShader(ctx->CompositeShaderHandle, ctx->CompositeFragHandle);
+        glLinkProgram(ctx->CompositeShaderHandle);
+        if (CheckProgram(ctx->CompositeShaderHandle, "composite shader program"))
+        {
+            ctx->CompositeLocationTex = glGetUniformLocation(ctx->CompositeShaderHandle, "Texture");
+            ctx->CompositeLocationProjMtx = glGetUniformLocation(ctx->CompositeShaderHandle, "ProjMtx");
+            ctx->CompositeLocationVtxPos = glGetAttribLocation(ctx->CompositeShaderHandle, "Position");
+            ctx->CompositeLocationVtxUV = glGetAttribLocation(ctx->CompositeShaderHandle, "UV");
+            ctx->CompositeLocationVtxColor = glGetAttribLocation(ctx->CompositeShaderHandle, "Color");
+        }
+        else
+        {
+            glDetachShader(ctx->CompositeShaderHandle, ctx->VertHandle);
+            glDetachShader(ctx->CompositeShaderHandle, ctx->CompositeFragHandle);
+            glDeleteProgram(ctx->CompositeShaderHandle);
+            ctx->CompositeShaderHandle = 0;
+        }
+    }
+
     // Create buffers
     glGenBuffers(1, &ctx->VboHandle);
     glGenBuffers(1, &ctx->ElementsHandle);
+    if (g_GlVersion >= 300)
+        glGenVertexArrays(1, &ctx->VaoHandle);
 
     ImGui_ImplOpenGL3_CreateFontsTexture(ctx);
 
     return true;
 }
 
+static void ImGui_ImplOpenGL3_DestroyHudTexture(gl_context *ctx)
+{
+    if (ctx->HudFramebuffer)   { glDeleteFramebuffers(1, &ctx->HudFramebuffer); ctx->HudFramebuffer = 0; }
+    if (ctx->HudTexture)       { glDeleteTextures(1, &ctx->HudTexture); ctx->HudTexture = 0; }
+    ctx->HudWidth = ctx->HudHeight = 0;
+}
+
 static void    ImGui_ImplOpenGL3_DestroyDeviceObjects(gl_context *ctx)
 {
+    ImGui_ImplOpenGL3_DestroyHudTexture(ctx);
+    if (ctx->CompositeShaderHandle && ctx->VertHandle) { glDetachShader(ctx->CompositeShaderHandle, ctx->VertHandle); }
+    if (ctx->CompositeShaderHandle && ctx->CompositeFragHandle) { glDetachShader(ctx->CompositeShaderHandle, ctx->CompositeFragHandle); }
+    if (ctx->CompositeFragHandle)   { glDeleteShader(ctx->CompositeFragHandle); ctx->CompositeFragHandle = 0; }
+    if (ctx->CompositeShaderHandle) { glDeleteProgram(ctx->CompositeShaderHandle); ctx->CompositeShaderHandle = 0; }
+
     if (ctx->VboHandle)        { glDeleteBuffers(1, &ctx->VboHandle); ctx->VboHandle = 0; }
     if (ctx->ElementsHandle)   { glDeleteBuffers(1, &ctx->ElementsHandle); ctx->ElementsHandle = 0; }
+    if (ctx->VaoHandle)        { glDeleteVertexArrays(1, &ctx->VaoHandle); ctx->VaoHandle = 0; }
     if (ctx->ShaderHandle && ctx->VertHandle) { glDetachShader(ctx->ShaderHandle, ctx->VertHandle); }
     if (ctx->ShaderHandle && ctx->FragHandle) { glDetachShader(ctx->ShaderHandle, ctx->FragHandle); }
     if (ctx->VertHandle)       { glDeleteShader(ctx->VertHandle); ctx->VertHandle = 0; }
@@ -515,13 +664,7 @@ static void ImGui_ImplOpenGL3_SetupRenderState(ImDrawData* draw_data, int fb_wid
             glDisable(GL_PRIMITIVE_RESTART);
     }
 
-    bool clip_origin_lower_left = true;
-    GLenum last_clip_origin = 0;
-    if (!g_IsGLES && /*g_GlVersion >= 450*/ (glad_glClipControl || glad_glClipControlEXT)) {
-        glGetIntegerv(GL_CLIP_ORIGIN, (GLint*)&last_clip_origin); // Support for GL 4.5's glClipControl(GL_UPPER_LEFT)
-        if (last_clip_origin == GL_UPPER_LEFT)
-            clip_origin_lower_left = false;
-    }
+    bool clip_origin_lower_left = g_ClipOriginLowerLeft; // Support for GL 4.5's glClipControl(GL_UPPER_LEFT)
 
     // Setup viewport, orthographic projection matrix
     // Our visible imgui space lies from draw_data->DisplayPos (top left) to draw_data->DisplayPos+data_data->DisplaySize (bottom right). DisplayPos is (0,0) for single viewport apps.
@@ -541,6 +684,9 @@ static void ImGui_ImplOpenGL3_SetupRenderState(ImDrawData* draw_data, int fb_wid
     glUseProgram(g_current_ctx->ShaderHandle);
     glUniform1i(g_current_ctx->AttribLocationTex, 0);
     glUniformMatrix4fv(g_current_ctx->AttribLocationProjMtx, 1, GL_FALSE, &ortho_projection[0][0]);
+    glUniform1f(g_current_ctx->AttribLocationSdfSpread, g_current_ctx->SdfSpread);
+    glUniform1f(g_current_ctx->AttribLocationSdfOutline, g_current_ctx->SdfOutline);
+    glUniform4fv(g_current_ctx->AttribLocationSdfOutlineColor, 1, g_current_ctx->SdfOutlineColor);
 
     if (g_GlVersion >= 330)
         glBindSampler(0, 0); // We use combined texture/sampler state. Applications using GL 3.3 may set that otherwise.
@@ -561,68 +707,8 @@ static void ImGui_ImplOpenGL3_SetupRenderState(ImDrawData* draw_data, int fb_wid
     glVertexAttribPointer(g_current_ctx->AttribLocationVtxColor, 4, GL_UNSIGNED_BYTE, GL_TRUE,  sizeof(ImDrawVert), (GLvoid*)IM_OFFSETOF(ImDrawVert, col));
 }
 
-// OpenGL3 Render function.
-// (this used to be set in io.RenderDrawListsFn and called by ImGui::Render(), but you can now call this directly from your main loop)
-// Note that this implementation is little overcomplicated because we are saving/setting up/restoring every OpenGL state explicitly, in order to be able to run within any OpenGL engine that doesn't do so.
-void    ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data)
+static void ImGui_ImplOpenGL3_RenderCommandLists(ImDrawData* draw_data, int fb_width, int fb_height, GLuint vertex_array_object)
 {
-    // Avoid rendering when minimized, scale coordinates for retina displays (screen coordinates != framebuffer coordinates)
-    int fb_width = (int)(draw_data->DisplaySize.x * draw_data->FramebufferScale.x);
-    int fb_height = (int)(draw_data->DisplaySize.y * draw_data->FramebufferScale.y);
-    if (fb_width <= 0 || fb_height <= 0 || draw_data->TotalVtxCount == 0)
-        return;
-
-    // Backup GL state
-    GLint last_fb = -1;
-    if (params.gl_bind_framebuffer >= 0 && (g_IsGLES || g_GlVersion >= 300))
-        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &last_fb);
-    GLenum last_active_texture; glGetIntegerv(GL_ACTIVE_TEXTURE, (GLint*)&last_active_texture);
-    glActiveTexture(GL_TEXTURE0);
-    GLint last_program; glGetIntegerv(GL_CURRENT_PROGRAM, &last_program);
-    GLint last_texture; glGetIntegerv(GL_TEXTURE_BINDING_2D, &last_texture);
-
-    // GL_SAMPLER_BINDING
-    GLint last_sampler;
-    if (!g_IsGLES && g_GlVersion >= 330)
-        glGetIntegerv(GL_SAMPLER_BINDING, &last_sampler);
-
-    GLint last_array_buffer; glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &last_array_buffer);
-
-//#ifndef IMGUI_IMPL_OPENGL_ES2
-    GLint last_vertex_array_object;
-    if (g_GlVersion >= 300)
-        glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &last_vertex_array_object);
-
-    GLint last_polygon_mode[2];
-    if (!g_IsGLES && g_GlVersion >= 200)
-        glGetIntegerv(GL_POLYGON_MODE, last_polygon_mode);
-
-    GLint last_viewport[4]; glGetIntegerv(GL_VIEWPORT, last_viewport);
-    GLint last_scissor_box[4]; glGetIntegerv(GL_SCISSOR_BOX, last_scissor_box);
-    GLenum last_blend_src_rgb; glGetIntegerv(GL_BLEND_SRC_RGB, (GLint*)&last_blend_src_rgb);
-    GLenum last_blend_dst_rgb; glGetIntegerv(GL_BLEND_DST_RGB, (GLint*)&last_blend_dst_rgb);
-    GLenum last_blend_src_alpha; glGetIntegerv(GL_BLEND_SRC_ALPHA, (GLint*)&last_blend_src_alpha);
-    GLenum last_blend_dst_alpha; glGetIntegerv(GL_BLEND_DST_ALPHA, (GLint*)&last_blend_dst_alpha);
-    GLenum last_blend_equation_rgb; glGetIntegerv(GL_BLEND_EQUATION_RGB, (GLint*)&last_blend_equation_rgb);
-    GLenum last_blend_equation_alpha; glGetIntegerv(GL_BLEND_EQUATION_ALPHA, (GLint*)&last_blend_equation_alpha);
-    GLboolean last_enable_blend = glIsEnabled(GL_BLEND);
-    GLboolean last_enable_cull_face = glIsEnabled(GL_CULL_FACE);
-    GLboolean last_enable_depth_test = glIsEnabled(GL_DEPTH_TEST);
-    GLboolean last_enable_stencil_test = glIsEnabled(GL_STENCIL_TEST);
-    GLboolean last_enable_scissor_test = glIsEnabled(GL_SCISSOR_TEST);
-    // Disable and store SRGB state.
-    GLboolean last_srgb_enabled = glIsEnabled(GL_FRAMEBUFFER_SRGB);
-    GLboolean last_enable_primitive_restart = (!g_IsGLES && g_GlVersion >= 310) ? glIsEnabled(GL_PRIMITIVE_RESTART) : GL_FALSE;
-
-    // Setup desired GL state
-    // Recreate the VAO every time (this is to easily allow multiple GL contexts to be rendered to. VAO are not shared among GL contexts)
-    // The renderer would actually work without any VAO bound, but then our VertexAttrib calls would overwrite the default one currently bound.
-    GLuint vertex_array_object = 0;
-    if (g_GlVersion >= 300)
-        glGenVertexArrays(1, &vertex_array_object);
-
-    ImGui_ImplOpenGL3_SetupRenderState(draw_data, fb_width, fb_height, vertex_array_object);
-
     // Will project scissor/clipping rectangles into framebuffer space
     ImVec2 clip_off = draw_data->DisplayPos;         // (0,0) unless using multi-viewports
     ImVec2 clip_scale = draw_data->FramebufferScale; // (1,1) unless using retina display which are often (2,2)
@@ -677,43 +763,275 @@ void    ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data)
             }
         }
     }
+}
 
-    // Destroy the temporary VAO
-    if (g_GlVersion >= 300)
-        glDeleteVertexArrays(1, &vertex_array_object);
+static bool ImGui_ImplOpenGL3_CreateHudTexture(gl_context* ctx, int width, int height)
+{
+    ImGui_ImplOpenGL3_DestroyHudTexture(ctx);
 
-    // Restore modified GL state
-    glUseProgram(last_program);
+    GLint last_texture, last_fb, last_unpack_buffer;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &last_texture);
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &last_fb);
+    glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &last_unpack_buffer);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    glGenTextures(1, &ctx->HudTexture);
+    glBindTexture(GL_TEXTURE_2D, ctx->HudTexture);
+    // Sampled 1:1 over the framebuffer
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+
+    glGenFramebuffers(1, &ctx->HudFramebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, ctx->HudFramebuffer);
+    glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, ctx->HudTexture, 0);
+    bool complete = glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, last_fb);
     glBindTexture(GL_TEXTURE_2D, last_texture);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, last_unpack_buffer);
+
+    if (!complete)
+    {
+        SPDLOG_DEBUG("HUD framebuffer is incomplete, drawing the HUD directly");
+        ImGui_ImplOpenGL3_DestroyHudTexture(ctx);
+        ctx->HudTextureFailed = true;
+        return false;
+    }
+
+    ctx->HudWidth = width;
+    ctx->HudHeight = height;
+    return true;
+}
+
+// Everything ImGui drew is inside the windows' clip rectangles, projected like the scissor boxes
+static void ImGui_ImplOpenGL3_UpdateHudRect(gl_context* ctx, ImDrawData* draw_data, int fb_width, int fb_height)
+{
+    ImVec2 clip_off = draw_data->DisplayPos;
+    ImVec2 clip_scale = draw_data->FramebufferScale;
+    ImVec4 box(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for (int n = 0; n < draw_data->CmdListsCount; n++)
+    {
+        const ImDrawList* cmd_list = draw_data->CmdLists[n];
+        for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; cmd_i++)
+        {
+            const ImVec4& clip = cmd_list->CmdBuffer[cmd_i].ClipRect;
+            box.x = std::min(box.x, clip.x);
+            box.y = std::min(box.y, clip.y);
+            box.z = std::max(box.z, clip.z);
+            box.w = std::max(box.w, clip.w);
+        }
+    }
+
+    float x = std::clamp((box.x - clip_off.x) * clip_scale.x, 0.0f, (float)fb_width);
+    float y = std::clamp((box.y - clip_off.y) * clip_scale.y, 0.0f, (float)fb_height);
+    float z = std::clamp((box.z - clip_off.x) * clip_scale.x, 0.0f, (float)fb_width);
+    float w = std::clamp((box.w - clip_off.y) * clip_scale.y, 0.0f, (float)fb_height);
+
+    ctx->HudRect[0] = (int)x;
+    ctx->HudRect[1] = params.gl_dont_flip ? (int)y : (int)(fb_height - w);
+    ctx->HudRect[2] = (int)(z - x);
+    ctx->HudRect[3] = (int)(w - y);
+}
+
+static void ImGui_ImplOpenGL3_CompositeHudTexture(gl_context* ctx)
+{
+    if (ctx->HudRect[2] <= 0 || ctx->HudRect[3] <= 0)
+        return;
+
+    // Already in clip space, the texture covers the whole framebuffer
+    static const ImDrawVert quad_vtx[4] =
+    {
+        { ImVec2(-1.0f, -1.0f), ImVec2(0.0f, 0.0f), IM_COL32_WHITE },
+        { ImVec2( 1.0f, -1.0f), ImVec2(1.0f, 0.0f), IM_COL32_WHITE },
+        { ImVec2( 1.0f,  1.0f), ImVec2(1.0f, 1.0f), IM_COL32_WHITE },
+        { ImVec2(-1.0f,  1.0f), ImVec2(0.0f, 1.0f), IM_COL32_WHITE },
+    };
+    static const ImDrawIdx quad_idx[6] = { 0, 1, 2, 0, 2, 3 };
+
+    // glClipControl(GL_UPPER_LEFT) flips clip space, flip it back to copy texels 1:1
+    float flip_y = g_ClipOriginLowerLeft ? 1.0f : -1.0f;
+    const float projection[4][4] =
+    {
+        { 1.0f, 0.0f,   0.0f, 0.0f },
+        { 0.0f, flip_y, 0.0f, 0.0f },
+        { 0.0f, 0.0f,   1.0f, 0.0f },
+        { 0.0f, 0.0f,   0.0f, 1.0f },
+    };
+    glUseProgram(ctx->CompositeShaderHandle);
+    glUniform1i(ctx->CompositeLocationTex, 0);
+    glUniformMatrix4fv(ctx->CompositeLocationProjMtx, 1, GL_FALSE, &projection[0][0]);
+
+    glEnableVertexAttribArray(ctx->CompositeLocationVtxPos);
+    glEnableVertexAttribArray(ctx->CompositeLocationVtxUV);
+    glEnableVertexAttribArray(ctx->CompositeLocationVtxColor);
+    glVertexAttribPointer(ctx->CompositeLocationVtxPos,   2, GL_FLOAT,         GL_FALSE, sizeof(ImDrawVert), (GLvoid*)IM_OFFSETOF(ImDrawVert, pos));
+    glVertexAttribPointer(ctx->CompositeLocationVtxUV,    2, GL_FLOAT,         GL_FALSE, sizeof(ImDrawVert), (GLvoid*)IM_OFFSETOF(ImDrawVert, uv));
+    glVertexAttribPointer(ctx->CompositeLocationVtxColor, 4, GL_UNSIGNED_BYTE, GL_TRUE,  sizeof(ImDrawVert), (GLvoid*)IM_OFFSETOF(ImDrawVert, col));
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quad_vtx), (const GLvoid*)quad_vtx, GL_STREAM_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(quad_idx), (const GLvoid*)quad_idx, GL_STREAM_DRAW);
+
+    glBlendFuncSeparate(GL_ONE, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    glScissor(ctx->HudRect[0], ctx->HudRect[1], ctx->HudRect[2], ctx->HudRect[3]);
+    glBindTexture(GL_TEXTURE_2D, ctx->HudTexture);
+    glDrawElements(GL_TRIANGLES, 6, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (void*)0);
+}
+
+// GL state RenderDrawData changes, restored afterwards
+struct gl_state
+{
+    GLint fb = -1;
+    GLenum active_texture;
+    GLint program, texture, sampler, array_buffer, vertex_array_object;
+    GLint polygon_mode[2];
+    GLint viewport[4], scissor_box[4];
+    GLenum blend_src_rgb, blend_dst_rgb, blend_src_alpha, blend_dst_alpha;
+    GLenum blend_equation_rgb, blend_equation_alpha;
+    GLboolean enable_blend, enable_cull_face, enable_depth_test, enable_stencil_test, enable_scissor_test;
+    GLboolean enable_srgb, enable_primitive_restart;
+    GLfloat clear_color[4];
+};
+
+// Every query is issued before the first command. With threaded dispatch
+// (mesa_glthread) a query waits for the app's queued commands to be
+// executed, so only the first one has anything to wait for.
+// Leaves GL_TEXTURE0 active.
+static void ImGui_ImplOpenGL3_BackupState(gl_state& state, bool clear)
+{
+    if (g_IsGLES || g_GlVersion >= 300)
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &state.fb);
+    glGetIntegerv(GL_ACTIVE_TEXTURE, (GLint*)&state.active_texture);
+    glGetIntegerv(GL_CURRENT_PROGRAM, &state.program);
+    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &state.array_buffer);
+    if (g_GlVersion >= 300)
+        glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &state.vertex_array_object);
+    if (!g_IsGLES && g_GlVersion >= 200)
+        glGetIntegerv(GL_POLYGON_MODE, state.polygon_mode);
+    glGetIntegerv(GL_VIEWPORT, state.viewport);
+    glGetIntegerv(GL_SCISSOR_BOX, state.scissor_box);
+    glGetIntegerv(GL_BLEND_SRC_RGB, (GLint*)&state.blend_src_rgb);
+    glGetIntegerv(GL_BLEND_DST_RGB, (GLint*)&state.blend_dst_rgb);
+    glGetIntegerv(GL_BLEND_SRC_ALPHA, (GLint*)&state.blend_src_alpha);
+    glGetIntegerv(GL_BLEND_DST_ALPHA, (GLint*)&state.blend_dst_alpha);
+    glGetIntegerv(GL_BLEND_EQUATION_RGB, (GLint*)&state.blend_equation_rgb);
+    glGetIntegerv(GL_BLEND_EQUATION_ALPHA, (GLint*)&state.blend_equation_alpha);
+    state.enable_blend = glIsEnabled(GL_BLEND);
+    state.enable_cull_face = glIsEnabled(GL_CULL_FACE);
+    state.enable_depth_test = glIsEnabled(GL_DEPTH_TEST);
+    state.enable_stencil_test = glIsEnabled(GL_STENCIL_TEST);
+    state.enable_scissor_test = glIsEnabled(GL_SCISSOR_TEST);
+    state.enable_srgb = glIsEnabled(GL_FRAMEBUFFER_SRGB);
+    state.enable_primitive_restart = (!g_IsGLES && g_GlVersion >= 310) ? glIsEnabled(GL_PRIMITIVE_RESTART) : GL_FALSE;
+    if (clear)
+        glGetFloatv(GL_COLOR_CLEAR_VALUE, state.clear_color);
+
+    g_ClipOriginLowerLeft = true;
+    if (!g_IsGLES && /*g_GlVersion >= 450*/ (glad_glClipControl || glad_glClipControlEXT)) {
+        GLenum clip_origin = 0;
+        glGetIntegerv(GL_CLIP_ORIGIN, (GLint*)&clip_origin);
+        g_ClipOriginLowerLeft = clip_origin != GL_UPPER_LEFT;
+    }
+
+    // Texture and sampler bindings of unit 0, the one we use. Apps mostly
+    // leave it active, otherwise these two wait again.
+    if (state.active_texture != GL_TEXTURE0)
+        glActiveTexture(GL_TEXTURE0);
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &state.texture);
+    if (!g_IsGLES && g_GlVersion >= 330)
+        glGetIntegerv(GL_SAMPLER_BINDING, &state.sampler);
+}
+
+static void ImGui_ImplOpenGL3_RestoreState(const gl_state& state)
+{
+    glUseProgram(state.program);
+    glBindTexture(GL_TEXTURE_2D, state.texture);
 
     if (!g_IsGLES && g_GlVersion >= 330)
-        glBindSampler(0, last_sampler);
+        glBindSampler(0, state.sampler);
 
-    glActiveTexture(last_active_texture);
+    glActiveTexture(state.active_texture);
 
     if (g_GlVersion >= 300)
-        glBindVertexArray(last_vertex_array_object);
-
-    glBindBuffer(GL_ARRAY_BUFFER, last_array_buffer);
-    glBlendEquationSeparate(last_blend_equation_rgb, last_blend_equation_alpha);
-    glBlendFuncSeparate(last_blend_src_rgb, last_blend_dst_rgb, last_blend_src_alpha, last_blend_dst_alpha);
-    if (last_enable_blend) glEnable(GL_BLEND); else glDisable(GL_BLEND);
-    if (last_enable_cull_face) glEnable(GL_CULL_FACE); else glDisable(GL_CULL_FACE);
-    if (last_enable_depth_test) glEnable(GL_DEPTH_TEST); else glDisable(GL_DEPTH_TEST);
-    if (last_enable_stencil_test) glEnable(GL_STENCIL_TEST); else glDisable(GL_STENCIL_TEST);
-    if (last_enable_scissor_test) glEnable(GL_SCISSOR_TEST); else glDisable(GL_SCISSOR_TEST);
-    if (!g_IsGLES && g_GlVersion >= 310) { if (last_enable_primitive_restart) glEnable(GL_PRIMITIVE_RESTART); }
+        glBindVertexArray(state.vertex_array_object);
+
+    glBindBuffer(GL_ARRAY_BUFFER, state.array_buffer);
+    glBlendEquationSeparate(state.blend_equation_rgb, state.blend_equation_alpha);
+    glBlendFuncSeparate(state.blend_src_rgb, state.blend_dst_rgb, state.blend_src_alpha, state.blend_dst_alpha);
+    if (state.enable_blend) glEnable(GL_BLEND); else glDisable(GL_BLEND);
+    if (state.enable_cull_face) glEnable(GL_CULL_FACE); else glDisable(GL_CULL_FACE);
+    if (state.enable_depth_test) glEnable(GL_DEPTH_TEST); else glDisable(GL_DEPTH_TEST);
+    if (state.enable_stencil_test) glEnable(GL_STENCIL_TEST); else glDisable(GL_STENCIL_TEST);
+    if (state.enable_scissor_test) glEnable(GL_SCISSOR_TEST); else glDisable(GL_SCISSOR_TEST);
+    if (!g_IsGLES && g_GlVersion >= 310) { if (state.enable_primitive_restart) glEnable(GL_PRIMITIVE_RESTART); }
 
     if (!g_IsGLES && g_GlVersion >= 200)
-        glPolygonMode(GL_FRONT_AND_BACK, (GLenum)last_polygon_mode[0]);
+        glPolygonMode(GL_FRONT_AND_BACK, (GLenum)state.polygon_mode[0]);
 
-    glViewport(last_viewport[0], last_viewport[1], (GLsizei)last_viewport[2], (GLsizei)last_viewport[3]);
-    glScissor(last_scissor_box[0], last_scissor_box[1], (GLsizei)last_scissor_box[2], (GLsizei)last_scissor_box[3]);
+    glViewport(state.viewport[0], state.viewport[1], (GLsizei)state.viewport[2], (GLsizei)state.viewport[3]);
+    glScissor(state.scissor_box[0], state.scissor_box[1], (GLsizei)state.scissor_box[2], (GLsizei)state.scissor_box[3]);
 
-    if (last_srgb_enabled)
+    if (state.enable_srgb)
         glEnable(GL_FRAMEBUFFER_SRGB);
-    if (last_fb >= 0)
-        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, last_fb);
+    if (state.fb >= 0)
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, state.fb);
+}
+
+// OpenGL3 Render function.
+// (this used to be set in io.RenderDrawListsFn and called by ImGui::Render(), but you can now call this directly from your main loop)
+// Note that this implementation is little overcomplicated because we are saving/setting up/restoring every OpenGL state explicitly, in order to be able to run within any OpenGL engine that doesn't do so.
+void    ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data, bool use_texture, bool changed)
+{
+    // Avoid rendering when minimized, scale coordinates for retina displays (screen coordinates != framebuffer coordinates)
+    int fb_width = (int)(draw_data->DisplaySize.x * draw_data->FramebufferScale.x);
+    int fb_height = (int)(draw_data->DisplaySize.y * draw_data->FramebufferScale.y);
+    if (fb_width <= 0 || fb_height <= 0 || draw_data->TotalVtxCount == 0)
+        return;
+
+    gl_context* ctx = g_current_ctx;
+    bool hud_texture = use_texture && g_GlVersion >= 300 && ctx->CompositeShaderHandle && !ctx->HudTextureFailed;
+    if (hud_texture && (ctx->HudWidth != fb_width || ctx->HudHeight != fb_height))
+        changed = true;
+
+    // Backup GL state
+    gl_state state;
+    ImGui_ImplOpenGL3_BackupState(state, hud_texture && changed);
+
+    // Setup desired GL state
+    if (hud_texture && (ctx->HudWidth != fb_width || ctx->HudHeight != fb_height))
+        hud_texture = ImGui_ImplOpenGL3_CreateHudTexture(ctx, fb_width, fb_height);
+
+    // The renderer would actually work without any VAO bound, but then our VertexAttrib calls would overwrite the default one currently bound.
+    ImGui_ImplOpenGL3_SetupRenderState(draw_data, fb_width, fb_height, ctx->VaoHandle);
+
+    if (!hud_texture)
+    {
+        ImGui_ImplOpenGL3_RenderCommandLists(draw_data, fb_width, fb_height, ctx->VaoHandle);
+    }
+    else
+    {
+        if (changed)
+        {
+            GLint target_fb = state.fb;
+            if (params.gl_bind_framebuffer >= 0)
+                target_fb = params.gl_bind_framebuffer;
+
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, ctx->HudFramebuffer);
+            glDisable(GL_SCISSOR_TEST);
+            glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+            glClearColor(state.clear_color[0], state.clear_color[1], state.clear_color[2], state.clear_color[3]);
+            glEnable(GL_SCISSOR_TEST);
+
+            // Blending into a cleared texture leaves premultiplied colors
+            ImGui_ImplOpenGL3_RenderCommandLists(draw_data, fb_width, fb_height, ctx->VaoHandle);
+            ImGui_ImplOpenGL3_UpdateHudRect(ctx, draw_data, fb_width, fb_height);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target_fb);
+        }
+        ImGui_ImplOpenGL3_CompositeHudTexture(ctx);
+    }
+
+    // Restore modified GL state
+    ImGui_ImplOpenGL3_RestoreState(state);
 }
 
 }} // namespace
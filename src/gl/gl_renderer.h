@@ -37,7 +37,22 @@ struct gl_context
     int AttribLocationTex = 0, AttribLocationProjMtx = 0;                                // Uniforms location
     int AttribLocationVtxPos = 0, AttribLocationVtxUV = 0, AttribLocationVtxColor = 0; // Vertex attributes location
     unsigned int VboHandle = 0, ElementsHandle = 0;
+    GLuint VaoHandle = 0; // VAOs aren't shared between contexts, but each has a gl_context
+    // font_sdf: SdfSpread is 0 for a coverage atlas, see SDF_COLOR_GLSL
+    int AttribLocationSdfSpread = -1, AttribLocationSdfOutline = -1, AttribLocationSdfOutlineColor = -1;
+    float SdfSpread = 0.0f, SdfOutline = 0.0f;
+    float SdfOutlineColor[4] = {};
     bool swap_interval_set = false;
+
+    // hud_retained: the HUD is drawn into HudTexture when it changes and
+    // composited with one quad over HudRect (glScissor box) otherwise
+    GLuint HudFramebuffer = 0, HudTexture = 0;
+    bool HudTextureFailed = false;
+    int HudWidth = 0, HudHeight = 0;
+    int HudRect[4] = {};
+    GLuint CompositeShaderHandle = 0, CompositeFragHandle = 0;
+    int CompositeLocationTex = 0, CompositeLocationProjMtx = 0;
+    int CompositeLocationVtxPos = 0, CompositeLocationVtxUV = 0, CompositeLocationVtxColor = 0;
 };
 
 
@@ -47,8 +62,11 @@ void GetOpenGLVersion(int& major, int& minor, bool& isGLES);
 IMGUI_IMPL_API bool     ImGui_ImplOpenGL3_Init(gl_context* ctx, const char* glsl_version = nullptr);
 IMGUI_IMPL_API void     ImGui_ImplOpenGL3_Shutdown(gl_context* ctx);
 IMGUI_IMPL_API void     ImGui_ImplOpenGL3_NewFrame(gl_context* ctx);
-IMGUI_IMPL_API void     ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data);
+// use_texture: go through ctx->HudTexture, only redrawn if draw_data changed
+IMGUI_IMPL_API void     ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data, bool use_texture = false, bool changed = true);
 IMGUI_IMPL_API bool     ImGui_ImplOpenGL3_CreateFontsTexture(gl_context* ctx);
+// uploads the rows [y0, y1) of the atlas again
+IMGUI_IMPL_API void     ImGui_ImplOpenGL3_UpdateFontsTexture(gl_context* ctx, int y0, int y1);
 
 // (Optional) Called by Init/NewFrame/Shutdown
 //IMGUI_IMPL_API bool     ImGui_ImplOpenGL3_CreateFontsTexture();
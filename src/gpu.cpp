@@ -25,6 +25,7 @@ GPUS::GPUS() {
 
     // Android: 항상 이 하나만 활성 GPU로 취급
     ptr->is_active = true;
+    ptr->start_sampling();
     available_gpus.emplace_back(ptr);
 
     SPDLOG_INFO(
@@ -145,6 +146,14 @@ GPUS::GPUS() {
         }
     }
 
+    // AMD APUs also report the CPU temperature and power, sample them even
+    // when only the dGPU is shown
+    for (auto& gpu : available_gpus)
+        if (gpu->vendor_id == 0x1002 && amdgpu_metrics_is_apu(gpu->pci_dev))
+            gpu->start_sampling();
+
+    start_sampling();
+
     if (total_active < 2)
         return;
 
@@ -154,8 +163,8 @@ GPUS::GPUS() {
 
         SPDLOG_WARN(
             "You have more than 1 active GPU, check if you use both pci_dev "
-            "and gpu_list. If you use fps logging, MangoHud will log only "
-            "this GPU: name = {}, driver = {}, vendor = {:x}, pci_dev = {}",
+            "and gpu_list. If you use fps logging, the main gpu_* columns "
+            "will come from this GPU: name = {}, driver = {}, vendor = {:x}, pci_dev = {}",
             gpu->drm_node,
             gpu->driver,
             gpu->vendor_id,
@@ -232,6 +241,92 @@ std::string GPUS::get_pci_device_address(const std::string& drm_card_path) {
 #endif
 }
 
+void GPU::start_sampling() {
+    if (sampling.load(std::memory_order_relaxed))
+        return;
+
+    if (vendor_id == 0x10de)
+        nvidia = std::make_unique<NVIDIA>(pci_dev.c_str());
+
+    if (vendor_id == 0x1002)
+        amdgpu = std::make_unique<AMDGPU>(pci_dev, device_id, vendor_id);
+
+#if defined(__ANDROID__)
+    // ANDROID:
+    // - GPUS::GPUS()에서 synthetic node:
+    //     drm_node = "android-vulkan"
+    //     driver   = "vulkan_timestamp"
+    //
+    // - VKP_DISABLE=0  : Vulkan timestamp backend 전용 (fdinfo/KGSL 사용 안 함)
+    // - VKP_DISABLE!=0 : Vulkan backend 비활성, fdinfo + KGSL fallback 활성
+    if (driver == "vulkan_timestamp") {
+        const char* env = std::getenv("VKP_DISABLE");
+        bool vkp_disabled =
+            env && env[0] != '\0' && env[0] != '0';
+
+        if (vkp_disabled) {
+            // GPU_fdinfo 쪽에는 "msm_drm" 모듈로 넘겨서:
+            // - find_fd(): Android 브랜치에서 module 무시하고 fdinfo 스캔
+            // - init_kgsl(): /sys/class/kgsl/kgsl-3d0 기반 gpubusy 폴백 활성
+            fdinfo = std::make_unique<GPU_fdinfo>("msm_drm", "", drm_node);
+        }
+    } else
+#endif
+    if (
+        driver == "i915" || driver == "xe" || driver == "panfrost" ||
+        driver == "msm_dpu" || driver == "msm_drm"
+    ) {
+        fdinfo = std::make_unique<GPU_fdinfo>(driver, pci_dev, drm_node);
+    }
+
+    // the backends are never replaced after this
+    sampling.store(true, std::memory_order_release);
+
+    SPDLOG_DEBUG("Started sampling {} (driver={}, pci_dev={})", drm_node, driver, pci_dev);
+}
+
+void GPUS::start_sampling() {
+    auto selected = selected_gpus();
+    auto active = active_gpu();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& gpu : available_gpus) {
+        if (gpu->is_sampling())
+            continue;
+
+        if (gpu == active || std::find(selected.begin(), selected.end(), gpu) != selected.end()) {
+            gpu->start_sampling();
+            if (sampling_params)
+                gpu->request_sampling(*sampling_params);
+            if (!sampling_wanted)
+                gpu->pause();
+        }
+    }
+}
+
+void GPUS::update_sampling(std::shared_ptr<const overlay_params> params, bool logging) {
+    bool wanted = logging || (!params->no_display && params->enabled[OVERLAY_PARAM_ENABLED_gpu_stats]);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (params == sampling_params && wanted == sampling_wanted)
+        return;
+
+    for (auto& gpu : available_gpus) {
+        if (params != sampling_params)
+            gpu->request_sampling(*params);
+
+        if (wanted != sampling_wanted) {
+            if (wanted)
+                gpu->resume();
+            else
+                gpu->pause();
+        }
+    }
+
+    sampling_params = std::move(params);
+    sampling_wanted = wanted;
+}
+
 int GPU::index_in_selected_gpus() {
     auto selected_gpus = gpus->selected_gpus();
     auto it = std::find_if(selected_gpus.begin(), selected_gpus.end(),
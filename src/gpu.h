@@ -20,7 +20,6 @@
 
 class GPU {
     public:
-        gpu_metrics metrics;
         std::string drm_node;
         std::unique_ptr<NVIDIA> nvidia = nullptr;
         std::unique_ptr<AMDGPU> amdgpu = nullptr;
@@ -36,63 +35,53 @@ GPU(
     std::string driver
 )
     : drm_node(drm_node), pci_dev(pci_dev), vendor_id(vendor_id), device_id(device_id),
-      driver(driver)
-{
-    if (vendor_id == 0x10de)
-        nvidia = std::make_unique<NVIDIA>(pci_dev);
-
-    if (vendor_id == 0x1002)
-        amdgpu = std::make_unique<AMDGPU>(pci_dev, device_id, vendor_id);
-
-#if defined(__ANDROID__)
-    // ANDROID:
-    // - GPUS::GPUS()에서 synthetic node:
-    //     drm_node = "android-vulkan"
-    //     driver   = "vulkan_timestamp"
-    //
-    // - VKP_DISABLE=0  : Vulkan timestamp backend 전용 (fdinfo/KGSL 사용 안 함)
-    // - VKP_DISABLE!=0 : Vulkan backend 비활성, fdinfo + KGSL fallback 활성
-    if (driver == "vulkan_timestamp") {
-        const char* env = std::getenv("VKP_DISABLE");
-        bool vkp_disabled =
-            env && env[0] != '\0' && env[0] != '0';
-
-        if (vkp_disabled) {
-            // GPU_fdinfo 쪽에는 "msm_drm" 모듈로 넘겨서:
-            // - find_fd(): Android 브랜치에서 module 무시하고 fdinfo 스캔
-            // - init_kgsl(): /sys/class/kgsl/kgsl-3d0 기반 gpubusy 폴백 활성
-            fdinfo = std::make_unique<GPU_fdinfo>("msm_drm", "", drm_node);
-        }
-    } else
-#endif
-    if (
-        driver == "i915" || driver == "xe" || driver == "panfrost" ||
-        driver == "msm_dpu" || driver == "msm_drm"
-    ) {
-        fdinfo = std::make_unique<GPU_fdinfo>(driver, pci_dev, drm_node);
-    }
-}
+      driver(driver) {}
 
+        // Latest metrics of the backend, the HUD and the logger read them
+        // from their own threads
+        gpu_metrics metrics() const { return published_metrics.load(); }
+
+        // Takes the backend's latest snapshot, on the hwinfo thread
         gpu_metrics get_metrics() {
-            if (nvidia) {
-                metrics = nvidia->copy_metrics();
-            } else if (amdgpu) {
-                metrics = amdgpu->copy_metrics();
-            } else if (fdinfo) {
-                metrics = fdinfo->copy_metrics();
-            }
-            return metrics;
+            if (!is_sampling())
+                return metrics();
+
+            gpu_metrics m;
+            if (nvidia)
+                m = nvidia->copy_metrics();
+            else if (amdgpu)
+                m = amdgpu->copy_metrics();
+            else if (fdinfo)
+                m = fdinfo->copy_metrics();
+            else
+                return metrics();
+
+            std::lock_guard<std::mutex> lock(publish_mutex);
+            published_metrics.store(m);
+            return m;
         };
 
+        // For loads measured outside of the backends, like the Vulkan
+        // timestamps on Android
+        void set_load(int load) {
+            std::lock_guard<std::mutex> lock(publish_mutex);
+            gpu_metrics m = published_metrics.load();
+            m.load = load;
+            published_metrics.store(m);
+        }
+
         std::vector<int> nvidia_pids() {
 #ifdef HAVE_NVML
-            if (nvidia)
+            if (is_sampling() && nvidia)
                 return nvidia->pids();
 #endif
             return std::vector<int>();
         }
 
         void pause() {
+            if (!is_sampling())
+                return;
+
             if (nvidia)
                 nvidia->pause();
 
@@ -104,6 +93,9 @@ GPU(
         }
 
         void resume() {
+            if (!is_sampling())
+                return;
+
             if (nvidia)
                 nvidia->resume();
 
@@ -114,14 +106,30 @@ GPU(
                 fdinfo->resume();
         }
 
-        bool is_apu() {
+        // Passes what the HUD asks for on to the backend threads, so they
+        // never read the params themselves
+        void request_sampling(const overlay_params& params) {
+            if (!is_sampling())
+                return;
+
             if (amdgpu)
+                amdgpu->request_sampling(params);
+
+            if (fdinfo)
+                fdinfo->request_update_period_ms(params.fps_sampling_period / 1'000'000);
+        }
+
+        bool is_apu() {
+            if (is_sampling() && amdgpu)
                 return amdgpu->is_apu;
             else
                 return false;
         }
 
         std::shared_ptr<Throttling> throttling() {
+            if (!is_sampling())
+                return nullptr;
+
             if (nvidia)
                 return nvidia->throttling;
 
@@ -131,11 +139,22 @@ GPU(
             return nullptr;
         }
 
+        // Creates the backend and its polling thread, only done for GPUs
+        // that are shown or logged. This happens on the hwinfo thread while
+        // the render thread already uses the GPU, so the backends are only
+        // looked at once is_sampling() has seen them published.
+        void start_sampling();
+        bool is_sampling() const { return sampling.load(std::memory_order_acquire); }
+
         std::string gpu_text();
         std::string vram_text();
 
     private:
         std::thread thread;
+        std::atomic<bool> sampling { false };
+        // the snapshot takes one writer at a time
+        metrics_snapshot<gpu_metrics> published_metrics;
+        std::mutex publish_mutex;
 
         int index_in_selected_gpus();
 };
@@ -160,6 +179,11 @@ class GPUS {
                 gpu->resume();
         }
 
+        // Called by the HUD every frame. Passes new params on to the backends
+        // and pauses them while nothing shows or logs GPU metrics, which is
+        // when update_hw_info() stops reading them
+        void update_sampling(std::shared_ptr<const overlay_params> params, bool logging);
+
         std::shared_ptr<GPU> active_gpu() {
             if (available_gpus.empty())
                 return nullptr;
@@ -169,8 +193,12 @@ class GPUS {
                     return gpu;
             }
 
-            // if no GPU is marked as active, just set it to the last one
-            // because integrated gpus are usually first
+            // if no GPU is marked as active, just set it to the last selected
+            // one because integrated gpus are usually first
+            auto selected = selected_gpus();
+            if (!selected.empty())
+                return selected.back();
+
             return available_gpus.back();
         }
 
@@ -181,11 +209,16 @@ class GPUS {
         }
 
         void get_metrics() {
+            // gpu_list or pci_dev may have changed since the last update
+            start_sampling();
+
             std::lock_guard<std::mutex> lock(mutex);
             for (auto gpu : available_gpus)
                 gpu->get_metrics();
         }
 
+        void start_sampling();
+
         std::vector<std::shared_ptr<GPU>> selected_gpus() {
             std::lock_guard<std::mutex> lock(mutex);
             std::vector<std::shared_ptr<GPU>> vec;
@@ -219,6 +252,10 @@ class GPUS {
         }
 
     private:
+        // last ones passed on by update_sampling(), under mutex
+        std::shared_ptr<const overlay_params> sampling_params;
+        bool sampling_wanted = true;
+
         std::string get_pci_device_address(const std::string& drm_card_path);
         std::string get_driver(const std::string& node);
 
@@ -4,6 +4,7 @@
 #include "hud_elements.h"
 #endif
 
+#include <climits>
 #include <cstdlib>
 #include <cerrno>
 #include <cstring>
@@ -57,149 +58,396 @@ namespace {
 }
 #endif
 
-void GPU_fdinfo::find_fd()
+static const struct {
+    const char *prefix;
+    size_t len;
+    fdinfo_counter_kind kind;
+} fdinfo_prefixes[] = {
+#define FDINFO_PREFIX(str, kind) { str, sizeof(str) - 1, kind }
+    // drm-total-cycles- must come before drm-total-
+    FDINFO_PREFIX("drm-engine-",       FDINFO_ENGINE),
+    FDINFO_PREFIX("drm-cycles-",       FDINFO_CYCLES),
+    FDINFO_PREFIX("drm-total-cycles-", FDINFO_TOTAL_CYCLES),
+    FDINFO_PREFIX("drm-total-",        FDINFO_TOTAL),
+    FDINFO_PREFIX("drm-resident-",     FDINFO_RESIDENT),
+    FDINFO_PREFIX("drm-memory-",       FDINFO_MEMORY),
+    FDINFO_PREFIX("drm-curfreq-",      FDINFO_CURFREQ),
+#undef FDINFO_PREFIX
+};
+
+static fdinfo_counter_kind fdinfo_match_key(const char *key, size_t len,
+                                            const char **name, size_t *name_len)
 {
-    fdinfo.clear();
-    fdinfo_data.clear();
+    for (const auto& p : fdinfo_prefixes) {
+        if (len <= p.len || memcmp(key, p.prefix, p.len) != 0)
+            continue;
 
-    auto dir = std::string("/proc/") + std::to_string(pid) + "/fdinfo";
-    auto path = fs::path(dir);
+        *name = key + p.len;
+        *name_len = len - p.len;
+        return p.kind;
+    }
 
-    SPDLOG_TRACE("fdinfo_dir = {}", dir);
+    return FDINFO_NONE;
+}
 
-    if (!fs::exists(path)) {
-        SPDLOG_DEBUG("{} does not exist", path.string());
-        return;
+fdinfo_key fdinfo_make_key(const std::string& key)
+{
+    const char *name;
+    size_t name_len;
+    auto kind = fdinfo_match_key(key.c_str(), key.size(), &name, &name_len);
+
+    if (kind == FDINFO_NONE || name_len >= FDINFO_NAME_MAX)
+        return {};
+
+    return { kind, std::string(name, name_len) };
+}
+
+// Parses "<number>[ <unit>]", returns false if there is no number
+static bool fdinfo_parse_value(const char *p, const char *end, uint64_t *out)
+{
+    while (p < end && (*p == ' ' || *p == '\t'))
+        p++;
+
+    if (p == end || *p < '0' || *p > '9')
+        return false;
+
+    uint64_t val = 0;
+    while (p < end && *p >= '0' && *p <= '9')
+        val = val * 10 + (*p++ - '0');
+
+    while (p < end && *p == ' ')
+        p++;
+
+    if (end - p >= 3 && p[1] == 'i' && p[2] == 'B') {
+        if (p[0] == 'K')
+            val *= 1024;
+        else if (p[0] == 'M')
+            val *= 1024 * 1024;
+        else if (p[0] == 'G')
+            val *= 1024 * 1024 * 1024;
     }
 
-    // Here we store client-ids, if ids match, we dont open this file,
-    // because it will have same readings and it becomes a duplicate
-    std::set<std::string> client_ids;
-    int total = 0;
+    *out = val;
+    return true;
+}
 
-    for (const auto& entry : fs::directory_iterator(path)) {
-        auto fd_path = entry.path().string();
-        auto file = std::ifstream(fd_path);
+void fdinfo_parse(const char *buf, size_t len, fdinfo_counters& out)
+{
+    static const char client_id_key[] = "drm-client-id";
 
-        if (!file.is_open())
-            continue;
+    out.counters.clear();
+    out.has_client_id = false;
+    out.client_id = 0;
 
-        std::string driver, pdev, client_id;
+    const char *end = buf + len;
 
-        for (std::string line; std::getline(file, line);) {
-            size_t colon = line.find(":");
+    for (const char *line = buf, *eol; line < end; line = eol + 1) {
+        eol = static_cast<const char *>(memchr(line, '\n', end - line));
+        if (!eol)
+            eol = end;
 
-            if (line[0] == ' ' || line[0] == '\t')
-                continue;
+        // only top level drm-* keys are interesting
+        if (eol - line < 4 || memcmp(line, "drm-", 4) != 0)
+            continue;
 
-            if (colon == std::string::npos || colon + 2 >= line.length())
-                continue;
+        auto colon = static_cast<const char *>(memchr(line, ':', eol - line));
+        if (!colon)
+            continue;
 
-            auto key = line.substr(0, colon);
-            auto val = line.substr(key.length() + 2);
+        size_t key_len = colon - line;
+        uint64_t val;
 
-            if (key == "drm-driver")
-                driver = val;
-            else if (key == "drm-pdev")
-                pdev = val;
-            else if (key == "drm-client-id")
-                client_id = val;
-        }
+        if (!fdinfo_parse_value(colon + 1, eol, &val))
+            continue;
 
-        if (!driver.empty() && driver == module) {
-            total++;
-            SPDLOG_TRACE(
-                "driver = \"{}\", pdev = \"{}\", "
-                "client_id = \"{}\", client_id_exists = \"{}\"",
-                driver, pdev,
-                client_id, client_ids.find(client_id) != client_ids.end()
-            );
+        if (key_len == sizeof(client_id_key) - 1 &&
+            memcmp(line, client_id_key, key_len) == 0) {
+            out.has_client_id = true;
+            out.client_id = val;
+            continue;
         }
 
-#if defined(__ANDROID__)
-        if (driver.empty() || client_id.empty() ||
-            client_ids.find(client_id) != client_ids.end())
+        const char *name;
+        size_t name_len;
+        auto kind = fdinfo_match_key(line, key_len, &name, &name_len);
+
+        if (kind == FDINFO_NONE || name_len >= FDINFO_NAME_MAX)
             continue;
-#else
-        if (
-            driver.empty() || client_id.empty() ||
-            driver != module || pdev != pci_dev ||
-            client_ids.find(client_id) != client_ids.end()
-        )
+
+        fdinfo_counter c;
+        c.kind = kind;
+        memcpy(c.name, name, name_len);
+        c.name[name_len] = '\0';
+        c.value = val;
+        out.counters.push_back(c);
+    }
+}
+
+const fdinfo_counter* fdinfo_counters::find(fdinfo_counter_kind kind, const char *name) const
+{
+    for (const auto& c : counters) {
+        if (c.kind == kind && strcmp(c.name, name) == 0)
+            return &c;
+    }
+
+    return nullptr;
+}
+
+void GPU_fdinfo::close_fdinfo_fds()
+{
+    for (int fd : fdinfo)
+        ::close(fd);
+
+    fdinfo.clear();
+    fdinfo_client_ids.clear();
+}
+
+// Returns the value of a top level "key:\tvalue" line, empty if missing
+static std::string_view fdinfo_find_value(std::string_view buf, std::string_view key)
+{
+    for (size_t pos = 0; pos < buf.size();) {
+        size_t eol = buf.find('\n', pos);
+        if (eol == std::string_view::npos)
+            eol = buf.size();
+
+        auto line = buf.substr(pos, eol - pos);
+        pos = eol + 1;
+
+        if (line.size() <= key.size() || line[key.size()] != ':' ||
+            line.compare(0, key.size(), key) != 0)
             continue;
+
+        auto val = line.substr(key.size() + 1);
+        size_t first = val.find_first_not_of(" \t");
+
+        return first == std::string_view::npos ? std::string_view() : val.substr(first);
+    }
+
+    return {};
+}
+
+// Returns false if fd is not open. Opens its fdinfo if it is a new DRM
+// client of our device.
+bool GPU_fdinfo::check_fd(int fd)
+{
+    char path[PATH_MAX], target[64];
+
+    snprintf(path, sizeof(path), "%s/%d/fd/%d", proc_root.c_str(), pid, fd);
+    ssize_t len = readlink(path, target, sizeof(target) - 1);
+
+    if (len < 0)
+        return false;
+
+    target[len] = '\0';
+
+    // cheap filter, most fds are files, sockets, pipes and eventfds
+    if (strncmp(target, "/dev/dri/", 9) != 0)
+        return true;
+
+    snprintf(path, sizeof(path), "%s/%d/fdinfo/%d", proc_root.c_str(), pid, fd);
+    int info = ::open(path, O_RDONLY | O_CLOEXEC);
+
+    if (info < 0)
+        return true;
+
+    ssize_t n = pread(info, fdinfo_buf.data(), fdinfo_buf.size(), 0);
+    ::close(info);
+
+    if (n <= 0)
+        return true;
+
+    std::string_view buf(fdinfo_buf.data(), n);
+    auto driver = fdinfo_find_value(buf, "drm-driver");
+    auto pdev = fdinfo_find_value(buf, "drm-pdev");
+    auto client_id_str = fdinfo_find_value(buf, "drm-client-id");
+
+    SPDLOG_TRACE(
+        "fd = {}, driver = \"{}\", pdev = \"{}\", client_id = \"{}\"",
+        fd, driver, pdev, client_id_str
+    );
+
+#if defined(__ANDROID__)
+    if (driver.empty() || client_id_str.empty())
+        return true;
+#else
+    if (driver.empty() || client_id_str.empty() ||
+        driver != module || pdev != pci_dev)
+        return true;
 #endif
 
-        client_ids.insert(client_id);
-        open_fdinfo_fd(fd_path);
+    // Here we store client-ids, if ids match, we dont open this file,
+    // because it will have same readings and it becomes a duplicate
+    uint64_t client_id = strtoull(std::string(client_id_str).c_str(), nullptr, 10);
+    if (!client_ids.insert(client_id).second)
+        return true;
+
+    open_fdinfo_fd(path, client_id);
+    return true;
+}
+
+void GPU_fdinfo::find_fd()
+{
+    close_fdinfo_fds();
+    fdinfo_data.clear();
+    client_ids.clear();
+    fd_holes.clear();
+    fd_highest = -1;
+    fdinfo_rescan = false;
+
+    auto dir = proc_root + "/" + std::to_string(pid) + "/fd";
+    auto path = fs::path(dir);
+
+    SPDLOG_TRACE("fd_dir = {}", dir);
+
+    if (!fs::exists(path)) {
+        SPDLOG_DEBUG("{} does not exist", path.string());
+        return;
+    }
+
+    std::set<int> fds;
+
+    for (const auto& entry : fs::directory_iterator(path)) {
+        int fd = atoi(entry.path().filename().c_str());
+
+        if (check_fd(fd))
+            fds.insert(fd);
+    }
+
+    if (!fds.empty())
+        fd_highest = *fds.rbegin();
+
+    for (int fd = 0; fd < fd_highest; fd++) {
+        if (fds.find(fd) == fds.end())
+            fd_holes.insert(fd);
     }
 
     SPDLOG_TRACE(
-        "Found {} total fds. Opened {} unique fds.",
-        total,
+        "Found {} fds. Opened {} unique DRM fds.",
+        fds.size(),
         fdinfo.size()
     );
 }
 
-void GPU_fdinfo::open_fdinfo_fd(std::string path) {
-    fdinfo.push_back(std::ifstream(path));
+// The kernel hands out the lowest free fd number, so new fds can only
+// show up in the holes we saw below the highest fd or right above it.
+// Holes are checked from the lowest one up to the first that is still
+// free, the ones above it can't have been taken since the last poll.
+// A tracked fd number reused by another file or client shows up as a
+// missing or different drm-client-id in gather_fdinfo_data(), which is
+// what triggers a full rescan.
+void GPU_fdinfo::poll_new_fds()
+{
+    if (fdinfo_rescan) {
+        SPDLOG_DEBUG("fdinfo read failed or fd reused, rescanning fds");
+        find_fd();
+        return;
+    }
+
+    for (auto it = fd_holes.begin(); it != fd_holes.end();) {
+        if (!check_fd(*it))
+            break;
+
+        it = fd_holes.erase(it);
+    }
+
+    for (int fd = fd_highest + 1; check_fd(fd); fd++)
+        fd_highest = fd;
+}
+
+void GPU_fdinfo::open_fdinfo_fd(std::string path, uint64_t client_id) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0) {
+        SPDLOG_DEBUG("Failed to open {}: {}", path, strerror(errno));
+        return;
+    }
+
+    fdinfo.push_back(fd);
+    fdinfo_client_ids.push_back(client_id);
     fdinfo_data.push_back({});
 }
 
 void GPU_fdinfo::gather_fdinfo_data() {
     for (size_t i = 0; i < fdinfo.size(); i++) {
-        fdinfo[i].clear();
-        fdinfo[i].seekg(0);
-
-        for (std::string line; std::getline(fdinfo[i], line);) {
-            size_t colon = line.find(":");
-
-            if (line[0] == ' ' || line[0] == '\t')
-                continue;
+        ssize_t n;
+
+        // fdinfo is a seq_file, reading from offset 0 regenerates it
+        while ((n = pread(fdinfo[i], fdinfo_buf.data(), fdinfo_buf.size(), 0)) ==
+               static_cast<ssize_t>(fdinfo_buf.size()))
+            fdinfo_buf.resize(fdinfo_buf.size() * 2);
+
+        if (n < 0) {
+            // fd got closed by the app, keep the slot until the next rescan
+            fdinfo_data[i].counters.clear();
+            fdinfo_data[i].has_client_id = false;
+            fdinfo_rescan = true;
+            continue;
+        }
 
-            if (colon == std::string::npos || colon + 2 >= line.length())
-                continue;
+        fdinfo_parse(fdinfo_buf.data(), n, fdinfo_data[i]);
 
-            auto key = line.substr(0, line.find(":"));
-            auto val = line.substr(key.length() + 2);
-            fdinfo_data[i][key] = val;
+        // the fd number now belongs to another file or DRM client
+        if (!fdinfo_data[i].has_client_id ||
+            fdinfo_data[i].client_id != fdinfo_client_ids[i]) {
+            fdinfo_data[i].counters.clear();
+            fdinfo_data[i].has_client_id = false;
+            fdinfo_rescan = true;
         }
     }
 }
 
-uint64_t GPU_fdinfo::get_gpu_time()
+template<typename K>
+uint64_t GPU_fdinfo::client_counter_delta(std::map<K, client_counter>& counters,
+                                          const K& key, uint64_t value, uint64_t poll)
 {
-    uint64_t total = 0;
-
-    if (module == "panfrost")
-        return get_gpu_time_panfrost();
+    auto it = counters.find(key);
 
-    for (auto& fd : fdinfo_data) {
-        auto time = fd[drm_engine_type];
+    if (it == counters.end()) {
+        counters[key] = { value, poll };
+        return 0;
+    }
 
-        if (time.empty())
-            continue;
+    uint64_t delta = value > it->second.value ? value - it->second.value : 0;
+    it->second = { value, poll };
+    return delta;
+}
 
-        total += std::stoull(time);
+template<typename K>
+void GPU_fdinfo::drop_gone_clients(std::map<K, client_counter>& counters, uint64_t poll)
+{
+    for (auto it = counters.begin(); it != counters.end();) {
+        if (it->second.poll != poll)
+            it = counters.erase(it);
+        else
+            ++it;
     }
+}
 
-    return total;
+uint64_t GPU_fdinfo::get_gpu_time(const fdinfo_counters& fd)
+{
+    if (module == "panfrost")
+        return fd.value(FDINFO_ENGINE, "fragment") +
+               fd.value(FDINFO_ENGINE, "vertex-tiler");
+
+    return fd.value(engine_key.kind, engine_key.name.c_str());
 }
 
-uint64_t GPU_fdinfo::get_gpu_time_panfrost() {
-    uint64_t total = 0;
+// Busy time the clients added since the last call
+uint64_t GPU_fdinfo::get_gpu_time_delta()
+{
+    uint64_t delta = 0;
+    gpu_time_polls++;
 
     for (auto& fd : fdinfo_data) {
-        auto frag = fd["drm-engine-fragment"];
-        auto vert = fd["drm-engine-vertex-tiler"];
-
-        if (!frag.empty())
-            total += std::stoull(frag);
+        if (!fd.has_client_id)
+            continue;
 
-        if (!vert.empty())
-            total += std::stoull(vert);
+        delta += client_counter_delta(client_gpu_time, fd.client_id,
+                                      get_gpu_time(fd), gpu_time_polls);
     }
 
-    return total;
+    drop_gone_clients(client_gpu_time, gpu_time_polls);
+    return delta;
 }
 
 float GPU_fdinfo::get_memory_used()
@@ -207,22 +455,10 @@ float GPU_fdinfo::get_memory_used()
     uint64_t total = 0;
 
     for (auto& fd : fdinfo_data) {
-        auto mem = fd[drm_memory_type];
-
-        if (mem.empty())
-            continue;
-
-        std::string unit = mem.substr(mem.rfind(" ") + 1);
-        uint64_t val = std::stoull(mem);
-
-        if (unit == "KiB")
-            val *= 1024;
-        else if (unit == "MiB")
-            val *= 1024 * 1024;
-        else if (unit == "GiB")
-            val *= 1024 * 1024 * 1024;
+        auto mem = fd.find(memory_key);
 
-        total += val;
+        if (mem)
+            total += mem->value;
     }
 
     return static_cast<float>(total) / 1024 / 1024 / 1024;
@@ -385,16 +621,24 @@ float GPU_fdinfo::get_power_usage()
         return static_cast<float>(hwmon_sensors["power"].val) / 1'000'000;
 
     float now = hwmon_sensors["energy"].val;
+    uint64_t now_time = os_time_get_nano();
 
     // Initialize value for the first time, otherwise delta will be very large
     // and your gpu power usage will be like 1 million watts for a second.
-    if (this->last_power == 0.f)
+    if (this->last_power == 0.f) {
         this->last_power = now;
+        this->last_power_time = now_time;
+    }
 
+    // the update interval isn't fixed, see next_interval_ms()
     float delta = now - this->last_power;
-    delta /= METRICS_UPDATE_PERIOD_MS / 1000.f;
+    if (now_time > this->last_power_time)
+        delta /= (now_time - this->last_power_time) / 1'000'000'000.f;
+    else
+        delta = 0.f;
 
     this->last_power = now;
+    this->last_power_time = now_time;
 
     return delta / 1'000'000;
 }
@@ -404,18 +648,15 @@ int GPU_fdinfo::get_xe_load()
     double load = 0;
 
     for (auto& fd : fdinfo_data) {
-        std::string client_id = fd["drm-client-id"];
-        std::string cur_cycles_str = fd["drm-cycles-rcs"];
-        std::string cur_total_cycles_str = fd["drm-total-cycles-rcs"];
-
-        if (
-            client_id.empty() || cur_cycles_str.empty() ||
-            cur_total_cycles_str.empty()
-        )
+        auto client_id = fd.client_id;
+        auto cycles = fd.find(FDINFO_CYCLES, "rcs");
+        auto total_cycles = fd.find(FDINFO_TOTAL_CYCLES, "rcs");
+
+        if (!fd.has_client_id || !cycles || !total_cycles)
             continue;
 
-        auto cur_cycles = std::stoull(cur_cycles_str);
-        auto cur_total_cycles = std::stoull(cur_total_cycles_str);
+        auto cur_cycles = cycles->value;
+        auto cur_total_cycles = total_cycles->value;
 
         if (prev_xe_cycles.find(client_id) == prev_xe_cycles.end()) {
             prev_xe_cycles[client_id] = { cur_cycles, cur_total_cycles };
@@ -462,16 +703,15 @@ int GPU_fdinfo::get_gpu_load()
         return get_xe_load();
 
     uint64_t now = os_time_get_nano();
-    uint64_t gpu_time_now = get_gpu_time();
+    uint64_t gpu_time_delta = get_gpu_time_delta();
 
     if (previous_time == 0) {
-        previous_gpu_time = gpu_time_now;
         previous_time = now;
         return 0;
     }
 
     float delta_time = static_cast<float>(now - previous_time);
-    float delta_gpu_time = static_cast<float>(gpu_time_now - previous_gpu_time);
+    float delta_gpu_time = static_cast<float>(gpu_time_delta);
 
     float result = 0.0f;
 
@@ -483,12 +723,147 @@ int GPU_fdinfo::get_gpu_load()
     if (result < 0.0f)
         result = 0.0f;
 
-    previous_gpu_time = gpu_time_now;
     previous_time = now;
 
     return std::round(result);
 }
 
+static gpu_engine_class fdinfo_engine_class(const std::string& name)
+{
+    static const struct {
+        const char *name;
+        gpu_engine_class engine_class;
+    } classes[] = {
+        // amdgpu
+        { "gfx",            GPU_ENGINE_RENDER },
+        { "compute",        GPU_ENGINE_COMPUTE },
+        { "dma",            GPU_ENGINE_COPY },
+        { "dec",            GPU_ENGINE_VIDEO },
+        { "enc",            GPU_ENGINE_VIDEO },
+        { "enc_1",          GPU_ENGINE_VIDEO },
+        { "jpeg",           GPU_ENGINE_VIDEO },
+        // i915
+        { "render",         GPU_ENGINE_RENDER },
+        { "copy",           GPU_ENGINE_COPY },
+        { "video",          GPU_ENGINE_VIDEO },
+        { "video-enhance",  GPU_ENGINE_VIDEO },
+        // xe
+        { "rcs",            GPU_ENGINE_RENDER },
+        { "ccs",            GPU_ENGINE_COMPUTE },
+        { "bcs",            GPU_ENGINE_COPY },
+        { "vcs",            GPU_ENGINE_VIDEO },
+        { "vecs",           GPU_ENGINE_VIDEO },
+        // msm, panfrost
+        { "gpu",            GPU_ENGINE_RENDER },
+        { "fragment",       GPU_ENGINE_RENDER },
+        { "vertex-tiler",   GPU_ENGINE_RENDER },
+    };
+
+    for (const auto& c : classes) {
+        if (name == c.name)
+            return c.engine_class;
+    }
+
+    return GPU_ENGINE_OTHER;
+}
+
+size_t GPU_fdinfo::get_engine_sample(const char *name)
+{
+    for (size_t i = 0; i < engine_samples.size(); i++) {
+        if (engine_samples[i].name == name)
+            return i;
+    }
+
+    engine_samples.push_back({});
+    engine_samples.back().name = name;
+    return engine_samples.size() - 1;
+}
+
+void GPU_fdinfo::get_engine_loads(struct gpu_metrics *out)
+{
+    static const char capacity_prefix[] = "capacity-";
+    uint64_t now = os_time_get_nano();
+    uint64_t delta_time = now - engine_samples_time;
+
+    engine_polls++;
+
+    for (auto& s : engine_samples) {
+        s.ns = s.cycles = s.total_cycles = 0;
+        s.capacity = 1;
+        s.has_ns = s.has_cycles = false;
+    }
+
+    for (const auto& fd : fdinfo_data) {
+        if (!fd.has_client_id)
+            continue;
+
+        for (const auto& c : fd.counters) {
+            switch (c.kind) {
+                case FDINFO_ENGINE:
+                    // drm-engine-capacity-<engine> is a count, not a time
+                    if (strncmp(c.name, capacity_prefix, sizeof(capacity_prefix) - 1) == 0) {
+                        auto& s = engine_samples[get_engine_sample(c.name + sizeof(capacity_prefix) - 1)];
+                        s.capacity = std::max<uint64_t>(c.value, 1);
+                    } else {
+                        size_t i = get_engine_sample(c.name);
+                        engine_samples[i].ns += client_counter_delta(
+                            client_engine_counters, { fd.client_id, i, c.kind }, c.value, engine_polls);
+                        engine_samples[i].has_ns = true;
+                    }
+                    break;
+                case FDINFO_CYCLES: {
+                    size_t i = get_engine_sample(c.name);
+                    engine_samples[i].cycles += client_counter_delta(
+                        client_engine_counters, { fd.client_id, i, c.kind }, c.value, engine_polls);
+                    engine_samples[i].has_cycles = true;
+                    break;
+                }
+                case FDINFO_TOTAL_CYCLES: {
+                    // GPU timestamp, the same for every client
+                    size_t i = get_engine_sample(c.name);
+                    uint64_t delta = client_counter_delta(
+                        client_engine_counters, { fd.client_id, i, c.kind }, c.value, engine_polls);
+                    engine_samples[i].total_cycles = std::max(engine_samples[i].total_cycles, delta);
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+    }
+
+    drop_gone_clients(client_engine_counters, engine_polls);
+
+    int count = 0;
+
+    for (auto& s : engine_samples) {
+        if (!s.has_ns && !s.has_cycles)
+            continue;
+
+        float load = 0.f;
+
+        if (s.has_ns) {
+            if (engine_samples_time != 0 && delta_time > 0)
+                load = static_cast<float>(s.ns) / delta_time * 100.f;
+        } else if (s.total_cycles > 0) {
+            load = static_cast<float>(s.cycles) / s.total_cycles * 100.f;
+        }
+
+        load /= s.capacity;
+
+        if (count >= GPU_METRICS_MAX_ENGINES)
+            continue;
+
+        auto& e = out->engine_load[count++];
+        snprintf(e.name, sizeof(e.name), "%s", s.name.c_str());
+        e.engine_class = fdinfo_engine_class(s.name);
+        e.load = std::min(static_cast<int>(std::lround(load)), 100);
+    }
+
+    out->engine_count = count;
+    engine_samples_time = now;
+}
+
 void GPU_fdinfo::find_i915_gt_dir()
 {
     std::string device = "/sys/bus/pci/devices/" + pci_dev + "/drm";
@@ -511,6 +886,9 @@ void GPU_fdinfo::find_i915_gt_dir()
 
     // Assuming gt0 since all recent GPUs have the RCS engine on gt0,
     // and latest GPUs need Xe anyway
+    if (fs::exists(device + "/gt/gt0"))
+        gt = std::make_unique<intel_gt>(module, device + "/gt/gt0");
+
     auto throttle_folder = device + "/gt/gt0/throttle_";
     auto throttle_status_path = throttle_folder + "reason_status";
 
@@ -575,6 +953,8 @@ void GPU_fdinfo::find_xe_gt_dir()
         return;
     }
 
+    gt = std::make_unique<intel_gt>(module, device);
+
     auto gpu_clock_path = device + "/freq0/act_freq";
     gpu_clock_stream.open(gpu_clock_path);
 
@@ -649,12 +1029,12 @@ int GPU_fdinfo::get_gpu_clock_panfrost() {
     if (fdinfo_data.empty())
         return 0;
 
-    auto freq_str = fdinfo_data[0]["drm-curfreq-fragment"];
+    auto freq_hz = fdinfo_data[0].find(FDINFO_CURFREQ, "fragment");
 
-    if (freq_str.empty())
+    if (!freq_hz)
         return 0;
 
-    float freq = std::stoull(freq_str) / 1'000'000;
+    float freq = freq_hz->value / 1'000'000;
 
     return std::round(freq);
 }
@@ -706,14 +1086,8 @@ float GPU_fdinfo::amdgpu_helper_get_proc_vram() {
     }
 #endif
 
-    // Recheck fds every 10secs, fixes Mass Effect 1, maybe some others too
-    {
-        auto t = os_time_get_nano() / 1'000'000;
-        if (t - fdinfo_last_update_ms >= 10'000) {
-            find_fd();
-            fdinfo_last_update_ms = t;
-        }
-    }
+    // Pick up new fds, fixes Mass Effect 1, maybe some others too
+    poll_new_fds();
 
     gather_fdinfo_data();
 
@@ -849,10 +1223,19 @@ int GPU_fdinfo::get_kgsl_load_raw() {
     }
 }
 
-void GPU_fdinfo::main_thread()
+int GPU_fdinfo::next_interval_ms()
 {
     constexpr int MIN_INTERVAL_MS = 500;
-    const int interval_ms = std::max(METRICS_UPDATE_PERIOD_MS, MIN_INTERVAL_MS);
+
+    sampler.apply_requested_period();
+    int interval_ms = std::max(sampler.update_period_ms(), MIN_INTERVAL_MS);
+    metrics.sample_rate_hz = 1000.f / interval_ms;
+
+    return interval_ms;
+}
+
+void GPU_fdinfo::main_thread()
+{
 
 #if defined(__ANDROID__)
     const bool use_vkp_backend = mango_vkp_enabled(); // MANGO_VKP=1 → Vulkan backend
@@ -872,7 +1255,7 @@ void GPU_fdinfo::main_thread()
                     break;
             }
 
-            std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+            std::this_thread::sleep_for(std::chrono::milliseconds(next_interval_ms()));
         }
         return;
     }
@@ -899,14 +1282,7 @@ void GPU_fdinfo::main_thread()
         }
 #endif
 
-        // 10초마다 fdinfo 리스캔
-        {
-            auto t = os_time_get_nano() / 1'000'000;
-            if (t - fdinfo_last_update_ms >= 10'000) {
-                find_fd();
-                fdinfo_last_update_ms = t;
-            }
-        }
+        poll_new_fds();
 
         // fdinfo 파싱 (VRAM, 일부 드라이버용 load에 필요)
         gather_fdinfo_data();
@@ -932,6 +1308,7 @@ void GPU_fdinfo::main_thread()
 
         metrics.load           = load;
         metrics.proc_vram_used = get_memory_used();
+        get_engine_loads(&metrics);
         metrics.CoreClock      = get_gpu_clock(); // KGSL clock 있으면 내부에서 처리 가능
 
         // Android: power는 get_power_usage()가 이미 0 리턴
@@ -954,13 +1331,16 @@ void GPU_fdinfo::main_thread()
         metrics.is_current_throttled = throttling & GPU_throttle_status::CURRENT;
         metrics.is_temp_throttled    = throttling & GPU_throttle_status::TEMP;
         metrics.is_other_throttled   = throttling & GPU_throttle_status::OTHER;
+        metrics.timestamp_ns         = os_time_get_nano();
+
+        published_metrics.store(metrics);
 
         SPDLOG_DEBUG(
             "Android GPU_fdinfo: pid = {}, module = {}, load = {}, kgsl_inited = {}",
             pid, module, metrics.load, kgsl_inited
         );
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+        std::this_thread::sleep_for(std::chrono::milliseconds(next_interval_ms()));
     }
 #else
     // 기존 non-Android 경로 그대로 유지
@@ -979,19 +1359,14 @@ void GPU_fdinfo::main_thread()
         }
 #endif
 
-        {
-            auto t = os_time_get_nano() / 1'000'000;
-            if (t - fdinfo_last_update_ms >= 10'000) {
-                find_fd();
-                fdinfo_last_update_ms = t;
-            }
-        }
+        poll_new_fds();
 
         gather_fdinfo_data();
         get_current_hwmon_readings();
 
         metrics.load           = get_gpu_load();
         metrics.proc_vram_used = get_memory_used();
+        get_engine_loads(&metrics);
 
         metrics.powerUsage = get_power_usage();
         metrics.powerLimit =
@@ -1000,6 +1375,11 @@ void GPU_fdinfo::main_thread()
         metrics.CoreClock = get_gpu_clock();
         metrics.voltage   = hwmon_sensors["voltage"].val;
 
+        if (gt) {
+            metrics.requested_clock = gt->requested_freq();
+            metrics.idle_residency  = gt->idle_residency(os_time_get_nano());
+        }
+
         if (module == "msm_drm") {
             metrics.temp = 0.0f;
         } else {
@@ -1016,6 +1396,9 @@ void GPU_fdinfo::main_thread()
         metrics.is_current_throttled = throttling & GPU_throttle_status::CURRENT;
         metrics.is_temp_throttled    = throttling & GPU_throttle_status::TEMP;
         metrics.is_other_throttled   = throttling & GPU_throttle_status::OTHER;
+        metrics.timestamp_ns         = os_time_get_nano();
+
+        published_metrics.store(metrics);
 
         SPDLOG_DEBUG(
             "pci_dev = {}, pid = {}, module = {}, "
@@ -1028,7 +1411,7 @@ void GPU_fdinfo::main_thread()
             metrics.voltage
         );
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+        std::this_thread::sleep_for(std::chrono::milliseconds(next_interval_ms()));
     }
 #endif
 }
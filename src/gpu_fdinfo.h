@@ -9,16 +9,19 @@
 
 #include <cstdint>
 #include <thread>
+#include <tuple>
 #include <atomic>
 #include <map>
 #include <set>
 #include <regex>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <mutex>
 #include <condition_variable>
 #include <fstream>
+#include <memory>
 
 #ifdef TEST_ONLY
 #include <../src/mesa/util/os_time.h>
@@ -30,6 +33,7 @@
 #include <filesystem.h>
 
 #include "gpu_metrics_util.h"
+#include "intel_gt.h"
 
 struct hwmon_sensor {
     std::regex rx;
@@ -39,6 +43,53 @@ struct hwmon_sensor {
     uint64_t val = 0;
 };
 
+// Counters parsed out of /proc/pid/fdinfo/N, see
+// Documentation/gpu/drm-usage-stats.rst. Values are normalized to
+// ns (engine), cycles, bytes (memory) and Hz (curfreq).
+enum fdinfo_counter_kind : uint8_t {
+    FDINFO_NONE = 0,
+    FDINFO_ENGINE,          // drm-engine-<engine>
+    FDINFO_CYCLES,          // drm-cycles-<engine>
+    FDINFO_TOTAL_CYCLES,    // drm-total-cycles-<engine>
+    FDINFO_TOTAL,           // drm-total-<region>
+    FDINFO_RESIDENT,        // drm-resident-<region>
+    FDINFO_MEMORY,          // drm-memory-<region>, legacy amdgpu
+    FDINFO_CURFREQ,         // drm-curfreq-<engine>
+};
+
+#define FDINFO_NAME_MAX 32
+
+struct fdinfo_counter {
+    fdinfo_counter_kind kind;
+    char name[FDINFO_NAME_MAX];
+    uint64_t value;
+};
+
+struct fdinfo_key {
+    fdinfo_counter_kind kind = FDINFO_NONE;
+    std::string name;
+};
+
+struct fdinfo_counters {
+    bool has_client_id = false;
+    uint64_t client_id = 0;
+    // cleared, not freed, on every parse so polling doesn't allocate
+    std::vector<fdinfo_counter> counters;
+
+    const fdinfo_counter* find(fdinfo_counter_kind kind, const char *name) const;
+    const fdinfo_counter* find(const fdinfo_key& key) const {
+        return find(key.kind, key.name.c_str());
+    }
+    uint64_t value(fdinfo_counter_kind kind, const char *name) const {
+        auto c = find(kind, name);
+        return c ? c->value : 0;
+    }
+};
+
+// "drm-engine-gfx" -> { FDINFO_ENGINE, "gfx" }, unknown keys give FDINFO_NONE
+fdinfo_key fdinfo_make_key(const std::string& key);
+void fdinfo_parse(const char *buf, size_t len, fdinfo_counters& out);
+
 enum GPU_throttle_status : int {
     POWER   = 0b0001,
     CURRENT = 0b0010,
@@ -53,6 +104,7 @@ private:
     const std::string module;
     const std::string pci_dev;
     const std::string drm_node;
+    const std::string proc_root;
 
     std::thread thread;
     std::condition_variable cond_var;
@@ -60,32 +112,79 @@ private:
     std::atomic<bool> stop_thread { false };
     std::atomic<bool> paused { false };
 
+    // metrics is only touched by main_thread, readers get published_metrics
     struct gpu_metrics metrics;
+    metrics_snapshot<gpu_metrics> published_metrics;
     mutable std::mutex metrics_mutex;
 
-    std::vector<std::ifstream> fdinfo;
-    uint64_t fdinfo_last_update_ms = 0;
+    // fds of the opened /proc/pid/fdinfo/N files, read with pread, and
+    // the drm-client-id each one had when it was opened
+    std::vector<int> fdinfo;
+    std::vector<uint64_t> fdinfo_client_ids;
+    std::vector<char> fdinfo_buf = std::vector<char>(4096);
+
+    // Incremental discovery state, see poll_new_fds()
+    int fd_highest = -1;
+    std::set<int> fd_holes;
+    std::set<uint64_t> client_ids;
+    bool fdinfo_rescan = false;
 
     std::map<std::string, hwmon_sensor> hwmon_sensors;
 
     std::string drm_engine_type = "EMPTY";
     std::string drm_memory_type = "EMPTY";
 
-    std::vector<std::map<std::string, std::string>> fdinfo_data;
+    fdinfo_key engine_key;
+    fdinfo_key memory_key;
+
+    std::vector<fdinfo_counters> fdinfo_data;
     void gather_fdinfo_data();
+    void close_fdinfo_fds();
 
     void main_thread();
 
     void find_fd();
-    void open_fdinfo_fd(std::string path);
+    void poll_new_fds();
+    bool check_fd(int fd);
+    void open_fdinfo_fd(std::string path, uint64_t client_id);
+
+    // Last value of a counter of one drm-client-id. Deltas are taken per
+    // client so one showing up or going away doesn't move the sums, a
+    // client only adds to them from its second read.
+    struct client_counter {
+        uint64_t value = 0;
+        uint64_t poll = 0;          // last poll the client was seen in
+    };
+    template<typename K>
+    static uint64_t client_counter_delta(std::map<K, client_counter>& counters,
+                                         const K& key, uint64_t value, uint64_t poll);
+    template<typename K>
+    static void drop_gone_clients(std::map<K, client_counter>& counters, uint64_t poll);
 
     int get_gpu_load();
-    uint64_t get_gpu_time();
-
-    uint64_t previous_gpu_time = 0, previous_time = 0;
+    uint64_t get_gpu_time(const fdinfo_counters& fd);
+    uint64_t get_gpu_time_delta();
+
+    uint64_t previous_time = 0;
+    uint64_t gpu_time_polls = 0;
+    std::map<uint64_t, client_counter> client_gpu_time;
+
+    // Per engine busy time (ns) or cycles the clients added since the last poll
+    struct engine_sample {
+        std::string name;
+        uint64_t ns = 0, cycles = 0, total_cycles = 0;
+        uint64_t capacity = 1;
+        bool has_ns = false, has_cycles = false;
+    };
+    std::vector<engine_sample> engine_samples;
+    uint64_t engine_samples_time = 0;
+    uint64_t engine_polls = 0;
+    // { drm-client-id, engine_samples index, counter kind }
+    std::map<std::tuple<uint64_t, size_t, fdinfo_counter_kind>, client_counter> client_engine_counters;
+    size_t get_engine_sample(const char *name);
 
     std::vector<uint64_t> xe_fdinfo_last_cycles;
-    std::map<std::string, std::pair<uint64_t, uint64_t>> prev_xe_cycles;
+    std::map<uint64_t, std::pair<uint64_t, uint64_t>> prev_xe_cycles;
     int get_xe_load();
 
     float get_memory_used();
@@ -97,13 +196,18 @@ private:
 
     float get_power_usage();
     float last_power = 0;
+    uint64_t last_power_time = 0;
+
+    // only follows fps_sampling_period here, fdinfo is read once per update
+    adaptive_sampler sampler;
+    int next_interval_ms();
 
     std::ifstream gpu_clock_stream;
+    std::unique_ptr<intel_gt> gt;
     void find_i915_gt_dir();
     void find_xe_gt_dir();
     int get_gpu_clock();
 
-    uint64_t get_gpu_time_panfrost();
     int get_gpu_clock_panfrost();
 
     std::ifstream throttle_status_stream;
@@ -129,11 +233,13 @@ private:
 public:
     GPU_fdinfo(
         const std::string module, const std::string pci_dev, const std::string drm_node,
-        const bool called_from_amdgpu_cpp=false
+        const bool called_from_amdgpu_cpp=false,
+        const std::string proc_root="/proc"
     )
         : module(module)
         , pci_dev(pci_dev)
         , drm_node(drm_node)
+        , proc_root(proc_root)
     {
         SPDLOG_INFO("GPU_fdinfo: module=\"{}\" pci_dev=\"{}\" drm_node=\"{}\"",
             module, pci_dev, drm_node);
@@ -163,7 +269,7 @@ public:
         }
 
         if (fdinfo_data.size() > 0 &&
-            fdinfo_data[0].find(drm_memory_type) == fdinfo_data[0].end())
+            !fdinfo_data[0].find(fdinfo_make_key(drm_memory_type)))
         {
             auto old_type = drm_memory_type;
 
@@ -178,6 +284,9 @@ public:
             );
         }
 
+        engine_key = fdinfo_make_key(drm_engine_type);
+        memory_key = fdinfo_make_key(drm_memory_type);
+
         SPDLOG_DEBUG(
             "drm_engine_type = {}, drm_memory_type = {}",
             drm_engine_type, drm_memory_type
@@ -239,12 +348,12 @@ public:
         cond_var.notify_all();
         if (thread.joinable())
             thread.join();
+        close_fdinfo_fds();
     }
 
     gpu_metrics copy_metrics() const
     {
-        std::lock_guard<std::mutex> lock(metrics_mutex);
-        return metrics;
+        return published_metrics.load();
     }
 
     void pause()
@@ -259,7 +368,15 @@ public:
         cond_var.notify_one();
     }
 
+    // fps_sampling_period as requested by the HUD
+    void request_update_period_ms(int ms)
+    {
+        sampler.request_update_period_ms(ms);
+    }
+
     float amdgpu_helper_get_proc_vram();
+    // Uses the fdinfo data of the last poll
+    void get_engine_loads(struct gpu_metrics *out);
 };
 
 #endif // MANGOHUD_GPU_FDINFO_H
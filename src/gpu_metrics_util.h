@@ -1,5 +1,31 @@
 #pragma once
+#include <algorithm>
 #include <atomic>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+#include "mesa/util/os_time.h"
+
+#define GPU_METRICS_MAX_APU_CORES 16
+#define GPU_METRICS_MAX_ENGINES 8
+
+enum gpu_engine_class : uint8_t {
+    GPU_ENGINE_RENDER,
+    GPU_ENGINE_COMPUTE,
+    GPU_ENGINE_COPY,
+    GPU_ENGINE_VIDEO,
+    GPU_ENGINE_OTHER,
+};
+
+struct gpu_engine_load {
+    char name[16];
+    gpu_engine_class engine_class;
+    int load;                         // percent, summed over clients
+};
 
 struct gpu_metrics {
     int load;
@@ -24,6 +50,23 @@ struct gpu_metrics {
     int voltage;
     bool fan_rpm;
 
+    /* Only filled by backends that expose them, -1 or 0 otherwise */
+    int mem_load {-1};                // memory controller activity
+    int video_load {-1};              // VCN/UVD activity
+    int proc_load {-1};               // this process' share of the GPU (NVML)
+    int requested_clock {-1};         // MHz the driver asked for (Intel)
+    int idle_residency {-1};          // percent of the last update spent in RC6 (Intel)
+    int pcie_link_width {0};
+    float pcie_link_speed {0.0f};     // GT/s
+    uint64_t throttle_status {0};     // ASIC independent throttle bits, see amdgpu_smu.h
+    int apu_core_count {0};
+    std::array<int, GPU_METRICS_MAX_APU_CORES> apu_core_temp {};
+    std::array<int, GPU_METRICS_MAX_APU_CORES> apu_core_clock {};
+    int engine_count {0};             // fdinfo drm-engine-*/drm-cycles-*
+    std::array<gpu_engine_load, GPU_METRICS_MAX_ENGINES> engine_load {};
+    float sample_rate_hz {0.0f};      // how often the backend reads the hardware
+    uint64_t timestamp_ns {0};        // os_time_get_nano() of the last read, 0 before the first one
+
     gpu_metrics()
         : load(0), temp(0), junction_temp(0), memory_temp(0),
           sys_vram_used(0.0f), proc_vram_used(0.0f), memoryTotal(0.0f), MemClock(0), CoreClock(0),
@@ -33,6 +76,74 @@ struct gpu_metrics {
           gtt_used(0.0f), fan_speed(0), voltage(0), fan_rpm(false) {}
 };
 
+/* Age in milliseconds of a sample stamped with os_time_get_nano(),
+ * -1 if it was never stamped. Samples stamped after `now_ns` was taken
+ * on another thread count as fresh.
+ */
+static inline float sample_age_ms(uint64_t now_ns, uint64_t timestamp_ns) {
+    if (!timestamp_ns)
+        return -1.0f;
+    if (timestamp_ns >= now_ns)
+        return 0.0f;
+    return (now_ns - timestamp_ns) / 1'000'000.0f;
+}
+
+/* Single writer, multiple reader seqlock used by the GPU backends to
+ * publish their metrics. The writer never waits and readers retry
+ * instead of blocking the sampling thread. The payload is kept in relaxed
+ * atomics so a torn read is only ever thrown away, never undefined.
+ */
+template <typename T>
+class metrics_snapshot {
+    static_assert(std::is_trivially_copyable<T>::value, "snapshot payload must be trivially copyable");
+
+    static constexpr size_t words = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<uint32_t> seq {0};
+    std::array<std::atomic<uint64_t>, words> data;
+
+public:
+    metrics_snapshot() { store(T {}); }
+
+    void store(const T& val)
+    {
+        uint64_t buf[words] = {};
+        memcpy(buf, &val, sizeof(T));
+
+        uint32_t s = seq.load(std::memory_order_relaxed);
+        seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (size_t i = 0; i < words; i++)
+            data[i].store(buf[i], std::memory_order_relaxed);
+
+        seq.store(s + 2, std::memory_order_release);
+    }
+
+    T load() const
+    {
+        uint64_t buf[words];
+        uint32_t before, after;
+
+        do {
+            before = seq.load(std::memory_order_acquire);
+
+            for (size_t i = 0; i < words; i++)
+                buf[i] = data[i].load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = seq.load(std::memory_order_relaxed);
+        } while ((before & 1) || before != after);
+
+        T val;
+        memcpy(static_cast<void *>(&val), buf, sizeof(T));
+        return val;
+    }
+
+    // Number of completed stores, lets readers skip unchanged snapshots
+    uint32_t version() const { return seq.load(std::memory_order_acquire) / 2; }
+};
+
 #define METRICS_UPDATE_PERIOD_MS 500
 #define METRICS_POLLING_PERIOD_MS 25
 #define METRICS_SAMPLE_COUNT (METRICS_UPDATE_PERIOD_MS/METRICS_POLLING_PERIOD_MS)
@@ -42,46 +153,242 @@ struct gpu_metrics {
 #define GPU_UPDATE_METRIC_MAX(FIELD) do { int cur_max = metrics_buffer[0].FIELD; for (size_t s=1; s < METRICS_SAMPLE_COUNT; s++) { cur_max = MAX(cur_max, metrics_buffer[s].FIELD); }; metrics.FIELD = cur_max; } while(0)
 #define GPU_UPDATE_METRIC_LAST(FIELD) do { metrics.FIELD = metrics_buffer[METRICS_SAMPLE_COUNT - 1].FIELD; } while(0)
 
+/* One poll of the values the sampler bases its decision on */
+struct sampler_reading {
+    float load = 0.f;           // percent
+    float power = 0.f;          // W
+    float temp = 0.f;           // C
+    uint64_t throttle = 0;      // any throttle status bits
+};
+
+/* Picks how often a backend polls the hardware within one update period.
+ * The update period follows fps_sampling_period, as requested by the HUD.
+ * When load, power and temperature are all flat the poll period grows up
+ * to a single read per update, a jump in any of them drops it back to
+ * METRICS_POLLING_PERIOD_MS. Throttle bits are instantaneous and OR'ed
+ * over the period, so the rate stays full while any are set or they
+ * changed since the last period.
+ */
+class adaptive_sampler {
+public:
+    // flat and busy spread, and jump of the mean between periods
+    struct thresholds {
+        float flat_stddev;
+        float busy_stddev;
+        float jump;
+    };
+    static constexpr thresholds load_thresholds  { 2.f, 8.f, 10.f };  // percent
+    static constexpr thresholds power_thresholds { 2.f, 8.f, 10.f };  // W
+    static constexpr thresholds temp_thresholds  { 1.f, 3.f, 3.f };   // C
+
+    void set_update_period_ms(int ms)
+    {
+        update_period = std::clamp(ms, METRICS_POLLING_PERIOD_MS, 10 * METRICS_UPDATE_PERIOD_MS);
+        clamp_poll_period();
+    }
+
+    // The HUD side requests the period, the sampler thread picks it up
+    // with apply_requested_period() so it never reads the params itself
+    void request_update_period_ms(int ms) { requested_period.store(ms, std::memory_order_relaxed); }
+    void apply_requested_period() { set_update_period_ms(requested_period.load(std::memory_order_relaxed)); }
+
+    int update_period_ms() const { return update_period; }
+    int poll_period_ms() const { return poll_period; }
+    size_t samples_per_update() const { return std::max(1, update_period / poll_period); }
+    float rate_hz() const { return 1000.f / poll_period; }
+
+    void add_sample(const sampler_reading& reading)
+    {
+        load.add(reading.load);
+        power.add(reading.power);
+        temp.add(reading.temp);
+        throttle |= reading.throttle;
+        count++;
+    }
+
+    // Call once per update period, returns true if the poll period changed
+    bool end_update()
+    {
+        if (count == 0)
+            return false;
+
+        int prev_poll_period = poll_period;
+        bool busy = false, flat = true;
+        load.end(count, load_thresholds, busy, flat);
+        power.end(count, power_thresholds, busy, flat);
+        temp.end(count, temp_thresholds, busy, flat);
+
+        if (throttle || throttle != last_throttle)
+            busy = true;
+        last_throttle = throttle;
+        throttle = 0;
+        count = 0;
+
+        if (busy)
+            poll_period = METRICS_POLLING_PERIOD_MS;
+        else if (flat)
+            poll_period *= 2;
+
+        clamp_poll_period();
+        return poll_period != prev_poll_period;
+    }
+
+private:
+    struct channel {
+        float sum = 0.f, sum_sq = 0.f, last_mean = -1.f;
+
+        void add(float value)
+        {
+            sum += value;
+            sum_sq += value * value;
+        }
+
+        void end(int count, const thresholds& t, bool& busy, bool& flat)
+        {
+            float mean = sum / count;
+            float stddev = std::sqrt(std::max(0.f, sum_sq / count - mean * mean));
+            float delta = last_mean < 0.f ? 0.f : std::fabs(mean - last_mean);
+
+            last_mean = mean;
+            sum = sum_sq = 0.f;
+
+            if (stddev > t.busy_stddev || delta > t.jump)
+                busy = true;
+            if (stddev >= t.flat_stddev || delta >= t.flat_stddev)
+                flat = false;
+        }
+    };
+
+    int update_period = METRICS_UPDATE_PERIOD_MS;
+    int poll_period = METRICS_POLLING_PERIOD_MS;
+    std::atomic<int> requested_period { METRICS_UPDATE_PERIOD_MS };
+    channel load, power, temp;
+    uint64_t throttle = 0, last_throttle = 0;
+    int count = 0;
+
+    // at most METRICS_SAMPLE_COUNT samples and at least one per update
+    void clamp_poll_period()
+    {
+        int min_poll = std::max(METRICS_POLLING_PERIOD_MS, update_period / METRICS_SAMPLE_COUNT);
+        poll_period = std::clamp(poll_period, min_poll, update_period);
+    }
+};
+
+enum throttle_reason : uint8_t {
+    THROTTLE_POWER,
+    THROTTLE_CURRENT,
+    THROTTLE_THERMAL,
+    THROTTLE_OTHER,
+    THROTTLE_REASON_COUNT,
+};
+
+/* Time spent throttled for one reason, an episode is counted when it starts */
+struct throttle_episodes {
+    uint32_t count = 0;
+    uint64_t total_ns = 0;            // includes the open episode when read through Throttling
+    uint64_t start_ns = 0;            // start of the open episode
+    bool throttled = false;
+};
+
+/* Throttling between two reads of the same reason, an episode already
+ * open at `begin` counts as one
+ */
+static inline throttle_episodes throttle_episodes_since(const throttle_episodes& begin,
+                                                        const throttle_episodes& end) {
+    throttle_episodes e = end;
+    e.count = end.count - begin.count + (begin.throttled ? 1 : 0);
+    e.total_ns = end.total_ns - begin.total_ns;
+    return e;
+}
+
+/* THROTTLE_* bits of the is_*_throttled flags */
+static inline uint8_t gpu_throttle_reasons(const gpu_metrics& m) {
+    return (m.is_power_throttled   ? 1 << THROTTLE_POWER   : 0) |
+           (m.is_current_throttled ? 1 << THROTTLE_CURRENT : 0) |
+           (m.is_temp_throttled    ? 1 << THROTTLE_THERMAL : 0) |
+           (m.is_other_throttled   ? 1 << THROTTLE_OTHER   : 0);
+}
+
 class Throttling {
-	public:
-		std::vector<float> power;
-		std::vector<float> thermal;
-		int64_t indep_throttle_status = 0;
-        bool use_v3;
-        std::atomic<bool> v3_power {false};
-        std::atomic<bool> v3_thermal {false};
-        uint32_t vendor_id;
-        // CORE, HOTSPOT, SOC bits
-        // trying to roughly match the bits that are exposed in v3
-        uint64_t indep_temp_mask = ((1ULL << 33) | (1ULL << 36) | (1ULL << 37));
-
-		Throttling(uint32_t vendor_id)
-			: power(200, 0.0f),
-			thermal(200, 0.0f), vendor_id(vendor_id) {}
-
-		void update(){
-            if (vendor_id == 0x10de) {
-                if (vendor_id == 0x10de && use_v3) {
-                    power.push_back(v3_power.load() ? 0.1f : 0.0f);
-                    thermal.push_back(v3_thermal.load() ? 0.1f : 0.0f);
-                } else {
-                    power.push_back((indep_throttle_status & (1ULL << 4)) != 0 ? 0.1f : 0.0f);
-                    thermal.push_back((indep_throttle_status & indep_temp_mask) != 0 ? 0.1f : 0.0f);
-                }
-            } else if (vendor_id == 0x1002) {
-                power.push_back(((indep_throttle_status >> 0 & 0xFF) != 0) ? 0.1f : 0.0f);
-                thermal.push_back(((indep_throttle_status >> 32 & 0xFFFF) != 0) ? 0.1f : 0.0f );
+public:
+    static constexpr int history_size = 200;
+
+    // Graph history, the oldest entry is at history_offset
+    std::array<float, history_size> power {};
+    std::array<float, history_size> thermal {};
+    int history_offset = 0;
+
+    // Called by the backend thread with the reasons of its last update,
+    // episodes start and end at the backend's own cadence
+    void set_reasons(uint8_t throttle_reasons) {
+        set_reasons(throttle_reasons, os_time_get_nano());
+    }
+
+    void set_reasons(uint8_t throttle_reasons, uint64_t now_ns) {
+        reasons.store(throttle_reasons);
+        seen_reasons.fetch_or(throttle_reasons);
+
+        std::lock_guard<std::mutex> lock(episodes_mutex);
+        for (int i = 0; i < THROTTLE_REASON_COUNT; i++) {
+            auto& e = reason_episodes[i];
+            bool throttled = throttle_reasons & (1 << i);
+
+            if (throttled && !e.throttled) {
+                e.start_ns = now_ns;
+                e.count++;
+            } else if (!throttled && e.throttled) {
+                e.total_ns += now_ns - e.start_ns;
             }
+            e.throttled = throttled;
+        }
+    }
+
+    // THROTTLE_* bits
+    uint8_t current_reasons() const {
+        return reasons.load();
+    }
+
+    // Once per fps_sampling_period from the HUD thread, a reason set at any
+    // point since the last call shows in the graph
+    void update() {
+        uint8_t r = seen_reasons.exchange(0) | reasons.load();
+
+        push_history(power, power_samples, (r & (1 << THROTTLE_POWER)) ? 0.1f : 0.0f);
+        push_history(thermal, thermal_samples, (r & (1 << THROTTLE_THERMAL)) ? 0.1f : 0.0f);
+        history_offset = (history_offset + 1) % history_size;
+    }
+
+    // Totals since the session started, up to `now_ns` for the open episode
+    throttle_episodes episodes(throttle_reason reason, uint64_t now_ns) const {
+        std::lock_guard<std::mutex> lock(episodes_mutex);
+        throttle_episodes e = reason_episodes[reason];
+        if (e.throttled && now_ns > e.start_ns)
+            e.total_ns += now_ns - e.start_ns;
+        return e;
+    }
+
+    // Throttled at any point of the graph history
+    bool power_throttling() const {
+        return power_samples > 0;
+    }
+
+    bool thermal_throttling() const {
+        return thermal_samples > 0;
+    }
+
+private:
+    std::atomic<uint8_t> reasons {0};
+    std::atomic<uint8_t> seen_reasons {0};
+    int power_samples = 0;
+    int thermal_samples = 0;
+
+    mutable std::mutex episodes_mutex;
+    std::array<throttle_episodes, THROTTLE_REASON_COUNT> reason_episodes {};
 
-			power.erase(power.begin());
-			thermal.erase(thermal.begin());
-		}
-        
-		bool power_throttling(){
-            return std::find(power.begin(), power.end(), 0.1f) != power.end();
-		}
-        
-		bool thermal_throttling(){
-            return std::find(thermal.begin(), thermal.end(), 0.1f) != thermal.end();
-		}
+    // overwrites the oldest entry, keeping count of the throttled ones
+    void push_history(std::array<float, history_size>& history, int& samples, float value) {
+        float& oldest = history[history_offset];
+        samples += (value > 0.f) - (oldest > 0.f);
+        oldest = value;
+    }
 };
@@ -188,6 +188,7 @@ R format_units(T value, const char*& unit)
 void HudElements::convert_colors(const struct overlay_params& params)
 {
     HUDElements.colors.update = false;
+    mark_hud_dirty();
     auto convert = [&params](unsigned color) -> ImVec4 {
         ImVec4 fc = ImGui::ColorConvertU32ToFloat4(color);
         fc.w = params.alpha;
@@ -291,6 +292,7 @@ static void ImguiNextColumnOrNewRow(int column = -1)
 }
 
 static bool ImGuiTextOverflow(const char* text) {
+    request_glyphs(ImGui::GetFont(), text);
     return ImGui::CalcTextSize(text).x > ImGui::CalcItemWidth() + HUDElements.ralign_width / 2;
 }
 // This function is only used in battery and battery is not used in windows builds
@@ -329,6 +331,7 @@ void HudElements::gpu_stats(){
     size_t i = 0;
     if (HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_gpu_stats] && gpus){
         for (auto& gpu : gpus->selected_gpus()) {
+            const gpu_metrics metrics = gpu->metrics();
             ImguiNextColumnFirstItem();
             HUDElements.TextColored(HUDElements.colors.gpu, "%s", gpu->gpu_text().c_str());
 
@@ -343,13 +346,13 @@ void HudElements::gpu_stats(){
                     HUDElements.params->gpu_load_value[1]
                 };
 
-                auto load_color = change_on_load_temp(gpu_data, gpu->metrics.load);
-                right_aligned_text(load_color, HUDElements.ralign_width, "%i", gpu->metrics.load);
+                auto load_color = change_on_load_temp(gpu_data, metrics.load);
+                right_aligned_text(load_color, HUDElements.ralign_width, "%i", metrics.load);
                 ImGui::SameLine(0, 1.0f);
                 HUDElements.TextColored(load_color,"%%");
             }
             else {
-                right_aligned_text(text_color, HUDElements.ralign_width, "%i", gpu->metrics.load);
+                right_aligned_text(text_color, HUDElements.ralign_width, "%i", metrics.load);
                 ImGui::SameLine(0, 1.0f);
                 HUDElements.TextColored(text_color,"%%");
                 // ImGui::SameLine(150);
@@ -359,9 +362,9 @@ void HudElements::gpu_stats(){
             if (HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_gpu_temp]){
                 ImguiNextColumnOrNewRow();
                 if (HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_temp_fahrenheit])
-                    right_aligned_text(text_color, HUDElements.ralign_width, "%i", HUDElements.convert_to_fahrenheit(gpu->metrics.temp));
+                    right_aligned_text(text_color, HUDElements.ralign_width, "%i", HUDElements.convert_to_fahrenheit(metrics.temp));
                 else
-                    right_aligned_text(text_color, HUDElements.ralign_width, "%i", gpu->metrics.temp);
+                    right_aligned_text(text_color, HUDElements.ralign_width, "%i", metrics.temp);
                 ImGui::SameLine(0, 1.0f);
                 if (HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_hud_compact])
                     HUDElements.TextColored(HUDElements.colors.text, "°");
@@ -372,12 +375,12 @@ void HudElements::gpu_stats(){
                         HUDElements.TextColored(HUDElements.colors.text, "°C");
             }
 
-            if (gpu->metrics.junction_temp > -1 && HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_gpu_junction_temp]) {
+            if (metrics.junction_temp > -1 && HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_gpu_junction_temp]) {
                 ImguiNextColumnOrNewRow();
                 if (HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_temp_fahrenheit])
-                    right_aligned_text(text_color, HUDElements.ralign_width, "%i", HUDElements.convert_to_fahrenheit(gpu->metrics.junction_temp));
+                    right_aligned_text(text_color, HUDElements.ralign_width, "%i", HUDElements.convert_to_fahrenheit(metrics.junction_temp));
                 else
-                    right_aligned_text(text_color, HUDElements.ralign_width, "%i", gpu->metrics.junction_temp);
+                    right_aligned_text(text_color, HUDElements.ralign_width, "%i", metrics.junction_temp);
                 ImGui::SameLine(0, 1.0f);
                 if (HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_temp_fahrenheit])
                     HUDElements.TextColored(HUDElements.colors.text, "°F");
@@ -391,9 +394,9 @@ void HudElements::gpu_stats(){
 
             if (HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_gpu_fan] && !gpu->is_apu()){
                 ImguiNextColumnOrNewRow();
-                right_aligned_text(text_color, HUDElements.ralign_width, "%i", gpu->metrics.fan_speed);
+                right_aligned_text(text_color, HUDElements.ralign_width, "%i", metrics.fan_speed);
                 ImGui::SameLine(0, 1.0f);
-                if (gpu->metrics.fan_rpm) {
+                if (metrics.fan_rpm) {
                     ImGui::PushFont(HUDElements.sw_stats->font_small);
                     HUDElements.TextColored(HUDElements.colors.text, "RPM");
                 } else {
@@ -407,17 +410,26 @@ void HudElements::gpu_stats(){
 
             if (HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_gpu_core_clock]){
                 ImguiNextColumnOrNewRow();
-                right_aligned_text(text_color, HUDElements.ralign_width, "%i", gpu->metrics.CoreClock);
+                right_aligned_text(text_color, HUDElements.ralign_width, "%i", metrics.CoreClock);
                 ImGui::SameLine(0, 1.0f);
                 ImGui::PushFont(HUDElements.sw_stats->font_small);
                 HUDElements.TextColored(HUDElements.colors.text, "MHz");
                 ImGui::PopFont();
             }
 
+            if (metrics.requested_clock > -1 && HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_gpu_requested_clock]) {
+                ImguiNextColumnOrNewRow();
+                right_aligned_text(text_color, HUDElements.ralign_width, "%i", metrics.requested_clock);
+                ImGui::SameLine(0, 1.0f);
+                ImGui::PushFont(HUDElements.sw_stats->font_small);
+                HUDElements.TextColored(HUDElements.colors.text, "MHz REQ");
+                ImGui::PopFont();
+            }
+
             if (HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_gpu_power]) {
                 ImguiNextColumnOrNewRow();
             
-                const float power = gpu->metrics.powerUsage;
+                const float power = metrics.powerUsage;
                 const char* fmt   = (power >= 100.0f) ? "%.0f" : "%.1f";
             
                 right_aligned_text(text_color,
@@ -427,7 +439,7 @@ void HudElements::gpu_stats(){
                 ImGui::SameLine(0, 1.0f);
                 ImGui::PushFont(HUDElements.sw_stats->font_small);
                 if (HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_gpu_power_limit])
-                    HUDElements.TextColored(HUDElements.colors.text, "/%.0fW", gpu->metrics.powerLimit);
+                    HUDElements.TextColored(HUDElements.colors.text, "/%.0fW", metrics.powerLimit);
                 else
                     HUDElements.TextColored(HUDElements.colors.text, "W");
                 ImGui::PopFont();
@@ -437,7 +449,7 @@ void HudElements::gpu_stats(){
                 ImguiNextColumnOrNewRow();
             
                 const float fps_val = HUDElements.sw_stats->fps;
-                const float power   = gpu->metrics.powerUsage;
+                const float power   = metrics.powerUsage;
                 const bool  flip    = HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_flip_efficiency];
             
                 float efficiency    = 0.0f;
@@ -478,12 +490,74 @@ void HudElements::gpu_stats(){
 
             if (HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_gpu_voltage]) {
                 ImguiNextColumnOrNewRow();
-                right_aligned_text(text_color, HUDElements.ralign_width, "%i", gpu->metrics.voltage);
+                right_aligned_text(text_color, HUDElements.ralign_width, "%i", metrics.voltage);
                 ImGui::SameLine(0, 1.0f);
                 ImGui::PushFont(HUDElements.sw_stats->font_small);
                 HUDElements.TextColored(HUDElements.colors.text, "mV");
                 ImGui::PopFont();
             }
+
+            if (metrics.mem_load > -1 && HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_gpu_mem_load]) {
+                ImguiNextColumnOrNewRow();
+                right_aligned_text(text_color, HUDElements.ralign_width, "%i", metrics.mem_load);
+                ImGui::SameLine(0, 1.0f);
+                HUDElements.TextColored(HUDElements.colors.text, "%%");
+                ImGui::SameLine(0, 1.0f);
+                ImGui::PushFont(HUDElements.sw_stats->font_small);
+                HUDElements.TextColored(HUDElements.colors.text, "MEM");
+                ImGui::PopFont();
+            }
+
+            if (metrics.video_load > -1 && HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_gpu_video_load]) {
+                ImguiNextColumnOrNewRow();
+                right_aligned_text(text_color, HUDElements.ralign_width, "%i", metrics.video_load);
+                ImGui::SameLine(0, 1.0f);
+                HUDElements.TextColored(HUDElements.colors.text, "%%");
+                ImGui::SameLine(0, 1.0f);
+                ImGui::PushFont(HUDElements.sw_stats->font_small);
+                HUDElements.TextColored(HUDElements.colors.text, "VID");
+                ImGui::PopFont();
+            }
+
+            if (metrics.proc_load > -1 && HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_gpu_proc_load]) {
+                ImguiNextColumnOrNewRow();
+                right_aligned_text(text_color, HUDElements.ralign_width, "%i", metrics.proc_load);
+                ImGui::SameLine(0, 1.0f);
+                HUDElements.TextColored(HUDElements.colors.text, "%%");
+                ImGui::SameLine(0, 1.0f);
+                ImGui::PushFont(HUDElements.sw_stats->font_small);
+                HUDElements.TextColored(HUDElements.colors.text, "APP");
+                ImGui::PopFont();
+            }
+
+            if (metrics.idle_residency > -1 && HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_gpu_idle_residency]) {
+                ImguiNextColumnOrNewRow();
+                right_aligned_text(text_color, HUDElements.ralign_width, "%i", metrics.idle_residency);
+                ImGui::SameLine(0, 1.0f);
+                HUDElements.TextColored(HUDElements.colors.text, "%%");
+                ImGui::SameLine(0, 1.0f);
+                ImGui::PushFont(HUDElements.sw_stats->font_small);
+                HUDElements.TextColored(HUDElements.colors.text, "RC6");
+                ImGui::PopFont();
+            }
+
+            if (metrics.pcie_link_width > 0 && HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_gpu_pcie_link]) {
+                ImguiNextColumnOrNewRow();
+                right_aligned_text(text_color, HUDElements.ralign_width, "x%i", metrics.pcie_link_width);
+                ImGui::SameLine(0, 1.0f);
+                ImGui::PushFont(HUDElements.sw_stats->font_small);
+                HUDElements.TextColored(HUDElements.colors.text, "%.1fGT/s", metrics.pcie_link_speed);
+                ImGui::PopFont();
+            }
+            if (metrics.timestamp_ns && HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_sample_age]) {
+                ImguiNextColumnOrNewRow();
+                float age = sample_age_ms(os_time_get_nano(), metrics.timestamp_ns);
+                right_aligned_text(text_color, HUDElements.ralign_width, "%.0f", age);
+                ImGui::SameLine(0, 1.0f);
+                ImGui::PushFont(HUDElements.sw_stats->font_small);
+                HUDElements.TextColored(HUDElements.colors.text, "ms");
+                ImGui::PopFont();
+            }
             if (!HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_horizontal])
                 ImGui::TableNextRow();
             i++;
@@ -751,6 +825,99 @@ void HudElements::core_load(){
     }
 }
 
+void HudElements::apu_cores(){
+    if (!HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_apu_cores] || !gpus)
+        return;
+
+    auto gpu = gpus->active_gpu();
+    if (!gpu)
+        return;
+
+    const gpu_metrics metrics = gpu->metrics();
+    const int core_count = std::min(metrics.apu_core_count, GPU_METRICS_MAX_APU_CORES);
+    for (int i = 0; i < core_count; i++) {
+        ImguiNextColumnFirstItem();
+        HUDElements.TextColored(HUDElements.colors.cpu, "APU");
+        ImGui::SameLine(0, 1.0f);
+        ImGui::PushFont(HUDElements.sw_stats->font_small);
+        HUDElements.TextColored(HUDElements.colors.cpu, "%i", i);
+        ImGui::PopFont();
+
+        ImguiNextColumnOrNewRow();
+        int temp = metrics.apu_core_temp[i];
+        if (HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_temp_fahrenheit])
+            temp = HUDElements.convert_to_fahrenheit(temp);
+        right_aligned_text(HUDElements.colors.text, HUDElements.ralign_width, "%i", temp);
+        ImGui::SameLine(0, 1.0f);
+        if (HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_temp_fahrenheit])
+            HUDElements.TextColored(HUDElements.colors.text, "°F");
+        else
+            HUDElements.TextColored(HUDElements.colors.text, "°C");
+
+        ImguiNextColumnOrNewRow();
+        right_aligned_text(HUDElements.colors.text, HUDElements.ralign_width, "%i", metrics.apu_core_clock[i]);
+        ImGui::SameLine(0, 1.0f);
+        ImGui::PushFont(HUDElements.sw_stats->font_small);
+        HUDElements.TextColored(HUDElements.colors.text, "MHz");
+        ImGui::PopFont();
+    }
+}
+
+void HudElements::gpu_engines(){
+    if (!HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_gpu_engines] || !gpus)
+        return;
+
+    for (auto& gpu : gpus->selected_gpus()) {
+        const gpu_metrics metrics = gpu->metrics();
+        const int engine_count = std::min(metrics.engine_count, GPU_METRICS_MAX_ENGINES);
+        for (int i = 0; i < engine_count; i++) {
+            const auto& engine = metrics.engine_load[i];
+
+            ImguiNextColumnFirstItem();
+            HUDElements.TextColored(HUDElements.colors.gpu, "%s", gpu->gpu_text().c_str());
+            ImGui::SameLine(0, 1.0f);
+            ImGui::PushFont(HUDElements.sw_stats->font_small);
+            HUDElements.TextColored(HUDElements.colors.gpu, "%s", engine.name);
+            ImGui::PopFont();
+
+            ImguiNextColumnOrNewRow();
+            right_aligned_text(HUDElements.colors.text, HUDElements.ralign_width, "%i", engine.load);
+            ImGui::SameLine(0, 1.0f);
+            HUDElements.TextColored(HUDElements.colors.text, "%%");
+        }
+    }
+}
+
+void HudElements::gpu_frametime(){
+    if (!HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_gpu_frametime] ||
+        HUDElements.sw_stats->gpu_frame_ms < 0)
+        return;
+
+    // the backend keeps its last value while suspended, don't show it forever
+    const uint64_t end_ns = HUDElements.sw_stats->gpu_frame_end_ns;
+    if (end_ns && sample_age_ms(os_time_get_nano(), end_ns) > 2000)
+        return;
+
+    ImguiNextColumnFirstItem();
+    HUDElements.TextColored(HUDElements.colors.gpu, "GPU");
+    ImGui::SameLine(0, 1.0f);
+    ImGui::PushFont(HUDElements.sw_stats->font_small);
+    HUDElements.TextColored(HUDElements.colors.gpu, "time");
+    ImGui::PopFont();
+
+    ImguiNextColumnOrNewRow();
+    right_aligned_text(HUDElements.colors.text, HUDElements.ralign_width, "%.1f", HUDElements.sw_stats->gpu_frame_ms);
+    ImGui::SameLine(0, 1.0f);
+    ImGui::PushFont(HUDElements.sw_stats->font_small);
+    HUDElements.TextColored(HUDElements.colors.text, "ms");
+    ImGui::PopFont();
+
+    ImguiNextColumnOrNewRow();
+    right_aligned_text(HUDElements.colors.text, HUDElements.ralign_width, "%i", int(HUDElements.sw_stats->gpu_busy + 0.5f));
+    ImGui::SameLine(0, 1.0f);
+    HUDElements.TextColored(HUDElements.colors.text, "%%");
+}
+
 void HudElements::io_stats(){
 #ifndef _WIN32
     if (HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_io_read] || HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_io_write]){
@@ -789,6 +956,7 @@ void HudElements::vram(){
         size_t i = 0;
         if (HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_gpu_stats]){
             for (auto& gpu : gpus->selected_gpus()) {
+                const gpu_metrics metrics = gpu->metrics();
                 ImguiNextColumnFirstItem();
                 // Just iterate through the user selected GPUs
                 if (!HUDElements.params->gpu_list.empty())
@@ -803,9 +971,9 @@ void HudElements::vram(){
                 ImguiNextColumnOrNewRow();
                 // Add gtt_used to vram usage for APUs
                 if (gpu->is_apu())
-                    right_aligned_text(HUDElements.colors.text, HUDElements.ralign_width, "%.1f", gpu->metrics.sys_vram_used + gpu->metrics.gtt_used);
+                    right_aligned_text(HUDElements.colors.text, HUDElements.ralign_width, "%.1f", metrics.sys_vram_used + metrics.gtt_used);
                 else
-                    right_aligned_text(HUDElements.colors.text, HUDElements.ralign_width, "%.1f", gpu->metrics.sys_vram_used);
+                    right_aligned_text(HUDElements.colors.text, HUDElements.ralign_width, "%.1f", metrics.sys_vram_used);
                 if (!HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_hud_compact]){
                     ImGui::SameLine(0,1.0f);
                     ImGui::PushFont(HUDElements.sw_stats->font_small);
@@ -813,12 +981,12 @@ void HudElements::vram(){
                     ImGui::PopFont();
                 }
 
-                if (gpu->metrics.memory_temp > -1 && HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_gpu_mem_temp]) {
+                if (metrics.memory_temp > -1 && HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_gpu_mem_temp]) {
                     ImguiNextColumnOrNewRow();
                     if (HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_temp_fahrenheit])
-                        right_aligned_text(HUDElements.colors.text, HUDElements.ralign_width, "%i", HUDElements.convert_to_fahrenheit(gpu->metrics.memory_temp));
+                        right_aligned_text(HUDElements.colors.text, HUDElements.ralign_width, "%i", HUDElements.convert_to_fahrenheit(metrics.memory_temp));
                     else
-                        right_aligned_text(HUDElements.colors.text, HUDElements.ralign_width, "%i", gpu->metrics.memory_temp);
+                        right_aligned_text(HUDElements.colors.text, HUDElements.ralign_width, "%i", metrics.memory_temp);
                     ImGui::SameLine(0, 1.0f);
                     if (HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_temp_fahrenheit])
                         HUDElements.TextColored(HUDElements.colors.text, "°F");
@@ -828,7 +996,7 @@ void HudElements::vram(){
 
                 if (HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_gpu_mem_clock]){
                     ImguiNextColumnOrNewRow();
-                    right_aligned_text(HUDElements.colors.text, HUDElements.ralign_width, "%i", gpu->metrics.MemClock);
+                    right_aligned_text(HUDElements.colors.text, HUDElements.ralign_width, "%i", metrics.MemClock);
                     ImGui::SameLine(0, 1.0f);
                     ImGui::PushFont(HUDElements.sw_stats->font_small);
                     HUDElements.TextColored(HUDElements.colors.text, "MHz");
@@ -850,56 +1018,55 @@ void HudElements::proc_vram() {
     if (!gpus)
         return;
 
-    auto gpu = gpus->active_gpu();
-    if (!gpu)
-        return;
+    for (auto& gpu : gpus->selected_gpus()) {
+        const gpu_metrics metrics = gpu->metrics();
+        ImguiNextColumnFirstItem();
+        HUDElements.TextColored(HUDElements.colors.vram, "P%s", gpu->vram_text().c_str());
+        ImguiNextColumnOrNewRow();
 
-    ImguiNextColumnFirstItem();
-    HUDElements.TextColored(HUDElements.colors.vram, "PVRAM");
-    ImguiNextColumnOrNewRow();
+        right_aligned_text(
+            HUDElements.colors.text,
+            HUDElements.ralign_width,
+            "%.1f",
+            metrics.proc_vram_used
+        );
 
-    right_aligned_text(
-        HUDElements.colors.text,
-        HUDElements.ralign_width,
-        "%.1f",
-        gpu->metrics.proc_vram_used
-    );
+        if (!HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_hud_compact]) {
+            ImGui::SameLine(0, 1.0f);
+            ImGui::PushFont(HUDElements.sw_stats->font_small);
+            HUDElements.TextColored(HUDElements.colors.text, "GiB");
+            ImGui::PopFont();
+        }
 
-    if (!HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_hud_compact]) {
-        ImGui::SameLine(0, 1.0f);
-        ImGui::PushFont(HUDElements.sw_stats->font_small);
-        HUDElements.TextColored(HUDElements.colors.text, "GiB");
-        ImGui::PopFont();
-    }
+        // show only if vram is not enabled
+        if (!HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_vram] &&
+            HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_gpu_mem_temp] &&
+            metrics.memory_temp > -1) {
 
-    // show only if vram is not enabled
-    if (!HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_vram] &&
-        HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_gpu_mem_temp] &&
-        gpu->metrics.memory_temp > -1) {
+            ImguiNextColumnOrNewRow();
 
-        ImguiNextColumnOrNewRow();
+            int temp = metrics.memory_temp;
+            const char* unit = "°C";
 
-        int temp = gpu->metrics.memory_temp;
-        const char* unit = "°C";
+            if (HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_temp_fahrenheit]) {
+                temp = HUDElements.convert_to_fahrenheit(temp);
+                unit = "°F";
+            }
 
-        if (HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_temp_fahrenheit]) {
-            temp = HUDElements.convert_to_fahrenheit(temp);
-            unit = "°F";
-        }
+            right_aligned_text(
+                HUDElements.colors.text,
+                HUDElements.ralign_width,
+                "%i",
+                temp
+            );
 
-        right_aligned_text(
-            HUDElements.colors.text,
-            HUDElements.ralign_width,
-            "%i",
-            temp
-        );
+            ImGui::SameLine(0, 1.0f);
+            HUDElements.TextColored(HUDElements.colors.text, "%s", unit);
+        }
 
-        ImGui::SameLine(0, 1.0f);
-        HUDElements.TextColored(HUDElements.colors.text, "%s", unit);
+        if (!HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_horizontal])
+            ImGui::TableNextRow();
     }
-
-    if (!HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_horizontal])
-        ImGui::TableNextRow();
 }
 
 void HudElements::ram(){
@@ -1268,12 +1435,16 @@ void HudElements::frame_timing() {
                             ImPlot::SetNextLineStyle(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), 1.5f);
                             ImPlot::PlotLine("power line",
                                              thr->power.data(),
-                                             (int)thr->power.size());
+                                             Throttling::history_size,
+                                             1.0, 0.0, ImPlotLineFlags_None,
+                                             thr->history_offset);
 
                             ImPlot::SetNextLineStyle(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), 1.5f);
                             ImPlot::PlotLine("thermal line",
                                              thr->thermal.data(),
-                                             (int)thr->thermal.size());
+                                             Throttling::history_size,
+                                             1.0, 0.0, ImPlotLineFlags_None,
+                                             thr->history_offset);
                         }
 
                         ImPlot::EndPlot();
@@ -1704,18 +1875,19 @@ void HudElements::throttling_status(){
         if (!gpu)
             return;
 
-        if ((gpu->metrics.is_power_throttled || gpu->metrics.is_current_throttled || gpu->metrics.is_temp_throttled || gpu->metrics.is_other_throttled)){
+        const gpu_metrics metrics = gpu->metrics();
+        if ((metrics.is_power_throttled || metrics.is_current_throttled || metrics.is_temp_throttled || metrics.is_other_throttled)){
             ImguiNextColumnFirstItem();
             HUDElements.TextColored(HUDElements.colors.engine, "%s", "Throttling");
             ImguiNextColumnOrNewRow();
             ImguiNextColumnOrNewRow();
-            if (gpu->metrics.is_power_throttled)
+            if (metrics.is_power_throttled)
                 right_aligned_text(HUDElements.colors.text, HUDElements.ralign_width, "Power");
-            if (gpu->metrics.is_current_throttled)
+            if (metrics.is_current_throttled)
                 right_aligned_text(HUDElements.colors.text, HUDElements.ralign_width, "Current");
-            if (gpu->metrics.is_temp_throttled)
+            if (metrics.is_temp_throttled)
                 right_aligned_text(HUDElements.colors.text, HUDElements.ralign_width, "Temp");
-            if (gpu->metrics.is_other_throttled)
+            if (metrics.is_other_throttled)
                 right_aligned_text(HUDElements.colors.text, HUDElements.ralign_width, "Other");
         }
     }
@@ -1823,7 +1995,8 @@ void HudElements::graphs(){
         if (!gpu)
             return;
 
-        HUDElements.max = gpu->metrics.memoryTotal;
+        const gpu_metrics metrics = gpu->metrics();
+        HUDElements.max = metrics.memoryTotal;
         HUDElements.min = 0;
         HUDElements.TextColored(HUDElements.colors.engine, "%s", "VRAM");
     }
@@ -1863,6 +2036,7 @@ void HudElements::exec_name(){
         ImguiNextColumnFirstItem();
         HUDElements.TextColored(HUDElements.colors.engine, "%s", "Exe name");
         ImguiNextColumnOrNewRow();
+        request_glyphs(ImGui::GetFont(), global_proc_name.c_str());
         ImVec2 text_size = ImGui::CalcTextSize(global_proc_name.c_str());
         right_aligned_text(HUDElements.colors.text, text_size.x, global_proc_name.c_str());
         ImGui::PopFont();
@@ -2185,6 +2359,9 @@ void HudElements::sort_elements(const std::pair<std::string, std::string>& optio
         {"gpu_stats", {gpu_stats}},
         {"cpu_stats", {cpu_stats}},
         {"core_load", {core_load}},
+        {"apu_cores", {apu_cores}},
+        {"gpu_engines", {gpu_engines}},
+        {"gpu_frametime", {gpu_frametime}},
         {"io_read", {io_stats}},
         {"io_write", {io_stats}},
         {"arch", {arch}},
@@ -2278,6 +2455,12 @@ void HudElements::legacy_elements(){
         ordered_functions.push_back({cpu_stats, "cpu_stats", value});
     if (params->enabled[OVERLAY_PARAM_ENABLED_core_load])
         ordered_functions.push_back({core_load, "core_load", value});
+    if (params->enabled[OVERLAY_PARAM_ENABLED_apu_cores])
+        ordered_functions.push_back({apu_cores, "apu_cores", value});
+    if (params->enabled[OVERLAY_PARAM_ENABLED_gpu_engines])
+        ordered_functions.push_back({gpu_engines, "gpu_engines", value});
+    if (params->enabled[OVERLAY_PARAM_ENABLED_gpu_frametime])
+        ordered_functions.push_back({gpu_frametime, "gpu_frametime", value});
     if (params->enabled[OVERLAY_PARAM_ENABLED_io_read] || params->enabled[OVERLAY_PARAM_ENABLED_io_write])
         ordered_functions.push_back({io_stats, "io_stats", value});
     if (params->enabled[OVERLAY_PARAM_ENABLED_vram])
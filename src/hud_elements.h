@@ -77,6 +77,9 @@ class HudElements{
         static void gpu_stats();
         static void cpu_stats();
         static void core_load();
+        static void apu_cores();
+        static void gpu_engines();
+        static void gpu_frametime();
         static void io_stats();
         static void vram();
         static void proc_vram();
@@ -0,0 +1,66 @@
+#include "intel_gt.h"
+
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+static void open_gt_file(std::ifstream& stream, const std::string& path) {
+    stream.open(path);
+    if (!stream.good()) {
+        SPDLOG_DEBUG("Intel gt: {} is not available", path);
+        stream.close();
+    }
+}
+
+static bool read_gt_value(std::ifstream& stream, uint64_t& value) {
+    if (!stream.is_open())
+        return false;
+
+    stream.clear();
+    stream.seekg(0);
+    if (!(stream >> value))
+        return false;
+
+    return true;
+}
+
+intel_gt::intel_gt(const std::string& module, const std::string& gt_dir) {
+    if (module == "xe") {
+        open_gt_file(act_freq_stream, gt_dir + "/freq0/act_freq");
+        open_gt_file(cur_freq_stream, gt_dir + "/freq0/cur_freq");
+        open_gt_file(residency_stream, gt_dir + "/gtidle/idle_residency_ms");
+    } else {
+        open_gt_file(act_freq_stream, gt_dir + "/rps_act_freq_mhz");
+        open_gt_file(cur_freq_stream, gt_dir + "/rps_cur_freq_mhz");
+        open_gt_file(residency_stream, gt_dir + "/rc6_residency_ms");
+    }
+}
+
+int intel_gt::actual_freq() {
+    uint64_t value;
+    return read_gt_value(act_freq_stream, value) ? int(value) : -1;
+}
+
+int intel_gt::requested_freq() {
+    uint64_t value;
+    return read_gt_value(cur_freq_stream, value) ? int(value) : -1;
+}
+
+int intel_gt::idle_residency(uint64_t now_ns) {
+    uint64_t residency_ms;
+    if (!read_gt_value(residency_stream, residency_ms))
+        return -1;
+
+    bool valid = has_prev_residency && now_ns > prev_residency_ns &&
+                 residency_ms >= prev_residency_ms;
+    int percent = -1;
+
+    if (valid) {
+        double idle_ns = double(residency_ms - prev_residency_ms) * 1'000'000;
+        percent = std::clamp(int(idle_ns * 100 / (now_ns - prev_residency_ns) + 0.5), 0, 100);
+    }
+
+    prev_residency_ms = residency_ms;
+    prev_residency_ns = now_ns;
+    has_prev_residency = true;
+    return percent;
+}
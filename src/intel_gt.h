@@ -0,0 +1,40 @@
+#pragma once
+#ifndef MANGOHUD_INTEL_GT_H
+#define MANGOHUD_INTEL_GT_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+/* Frequency and idle residency of one Intel GT, read from sysfs:
+ *   i915: <card>/gt/gtN/rps_{act,cur}_freq_mhz, rc6_residency_ms
+ *   xe:   <tile>/gtN/freq0/{act,cur}_freq, gtidle/idle_residency_ms
+ */
+class intel_gt {
+public:
+    intel_gt(const std::string& module, const std::string& gt_dir);
+
+    bool has_actual_freq() const { return act_freq_stream.is_open(); }
+    bool has_requested_freq() const { return cur_freq_stream.is_open(); }
+    bool has_idle_residency() const { return residency_stream.is_open(); }
+
+    // MHz, -1 if not exposed
+    int actual_freq();
+    // MHz the driver asked the GT to run at, -1 if not exposed
+    int requested_freq();
+
+    // Percent of the time since the previous call spent in RC6 (gt-c6
+    // on xe), -1 on the first call or if not exposed
+    int idle_residency(uint64_t now_ns);
+
+private:
+    std::ifstream act_freq_stream;
+    std::ifstream cur_freq_stream;
+    std::ifstream residency_stream;
+
+    uint64_t prev_residency_ms = 0;
+    uint64_t prev_residency_ns = 0;
+    bool has_prev_residency = false;
+};
+
+#endif //MANGOHUD_INTEL_GT_H
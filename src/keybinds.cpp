@@ -49,12 +49,14 @@ void check_keybinds(struct overlay_params& params){
          logger->start_logging();
          benchmark.fps_data.clear();
       }
+      mark_hud_dirty();
    }
 
    if (elapsedFpsLimitToggle >= keyPressDelay &&
        keys_are_pressed(real_params->toggle_fps_limit)) {
       toggle_fps_limit_press = now;
       fps_limiter->next_limit();
+      mark_hud_dirty();
    }
 
    if (elapsedPresetToggle >= keyPressDelay &&
@@ -74,6 +76,7 @@ void check_keybinds(struct overlay_params& params){
        keys_are_pressed(real_params->toggle_hud)) {
       last_f12_press = now;
       real_params->no_display = !real_params->no_display;
+      mark_hud_dirty();
    }
 
    if (elapsedReloadCfg >= keyPressDelay &&
@@ -97,6 +100,7 @@ void check_keybinds(struct overlay_params& params){
    if (elapsedF12 >= keyPressDelay &&
        keys_are_pressed(real_params->toggle_hud_position)) {
       next_hud_position();
+      mark_hud_dirty();
       last_f12_press = now;
    }
 
@@ -105,5 +109,6 @@ void check_keybinds(struct overlay_params& params){
       last_f12_press = now;
       if (fpsmetrics)
          fpsmetrics->reset_metrics();
+      mark_hud_dirty();
    }
 }
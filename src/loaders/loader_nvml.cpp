@@ -278,6 +278,26 @@ bool libnvml_loader::Load(const std::string& library_name) {
     return false;
   }
 
+  // Optional, older drivers lack these and the backend falls back to
+  // nvmlDeviceGetUtilizationRates
+#if defined(LIBRARY_LOADER_NVML_H_DLOPEN)
+  nvmlDeviceGetSamples =
+      reinterpret_cast<decltype(this->nvmlDeviceGetSamples)>(
+          dlsym(library_, "nvmlDeviceGetSamples"));
+#endif
+#if defined(LIBRARY_LOADER_NVML_H_DT_NEEDED)
+  nvmlDeviceGetSamples = &::nvmlDeviceGetSamples;
+#endif
+
+#if defined(LIBRARY_LOADER_NVML_H_DLOPEN)
+  nvmlDeviceGetProcessUtilization =
+      reinterpret_cast<decltype(this->nvmlDeviceGetProcessUtilization)>(
+          dlsym(library_, "nvmlDeviceGetProcessUtilization"));
+#endif
+#if defined(LIBRARY_LOADER_NVML_H_DT_NEEDED)
+  nvmlDeviceGetProcessUtilization = &::nvmlDeviceGetProcessUtilization;
+#endif
+
   loaded_ = true;
   return true;
 }
@@ -304,4 +324,6 @@ void libnvml_loader::CleanUp(bool unload) {
   nvmlUnitGetHandleByIndex = NULL;
   nvmlDeviceGetFanSpeed = NULL;
   nvmlDeviceGetGraphicsRunningProcesses = NULL;
+  nvmlDeviceGetSamples = NULL;
+  nvmlDeviceGetProcessUtilization = NULL;
 }
@@ -45,6 +45,8 @@ class libnvml_loader {
   decltype(&::nvmlUnitGetHandleByIndex) nvmlUnitGetHandleByIndex;
   decltype(&::nvmlDeviceGetFanSpeed) nvmlDeviceGetFanSpeed;
   decltype(&::nvmlDeviceGetGraphicsRunningProcesses) nvmlDeviceGetGraphicsRunningProcesses;
+  decltype(&::nvmlDeviceGetSamples) nvmlDeviceGetSamples;
+  decltype(&::nvmlDeviceGetProcessUtilization) nvmlDeviceGetProcessUtilization;
 
  private:
   void CleanUp(bool unload);
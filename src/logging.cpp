@@ -17,6 +17,7 @@
 #include "string_utils.h"
 #include "version.h"
 #include "fps_metrics.h"
+#include "gpu_metrics_util.h"
 
 std::string os, cpu, gpu, ram, kernel, driver, cpusched;
 bool sysInfoFetched = false;
@@ -25,6 +26,10 @@ float frametime;
 logData currentLogData = {};
 std::unique_ptr<Logger> logger;
 std::ofstream output_file;
+// number of per GPU column sets in the open log file
+static size_t log_gpu_columns = 0;
+// log_throttling when the log file was opened
+static bool log_throttle_column = false;
 std::thread log_thread;
 
 #if !defined(__ANDROID__)
@@ -92,6 +97,10 @@ static void upload_files(const std::vector<std::string>&) {
 
 #endif // __ANDROID__
 
+static const char *throttle_reason_names[THROTTLE_REASON_COUNT] = {
+    "Power", "Current", "Thermal", "Other"
+};
+
 static bool compareByFps(const logData &a, const logData &b)
 {
     return a.fps < b.fps;
@@ -118,7 +127,10 @@ static void writeSummary(std::string filename){
             << "Average GPU Temp," << "Average CPU Temp," << "Average VRAM Used,"
             << "Average RAM Used," << "Average Swap Used," << "Peak GPU Load,"
             << "Peak CPU Load," << "Peak GPU Temp," << "Peak CPU Temp,"
-            << "Peak VRAM Used," << "Peak RAM Used," << "Peak Swap Used" << "\n";
+            << "Peak VRAM Used," << "Peak RAM Used," << "Peak Swap Used";
+        for (const char *reason : throttle_reason_names)
+            out << ",GPU " << reason << " Throttled %" << ",GPU " << reason << " Throttle Episodes";
+        out << "\n";
 
         std::vector<logData> sorted = logArray;
         std::sort(sorted.begin(), sorted.end(), compareByFps);
@@ -213,13 +225,51 @@ static void writeSummary(std::string filename){
         out << peak_ram << ",";
         // Peak Swap Used
         out << peak_swap;
+
+        // Share of the log spent throttled and how many times it started,
+        // left empty for GPUs that don't report it
+        std::array<throttle_episodes, THROTTLE_REASON_COUNT> episodes;
+        uint64_t duration_ns = 0;
+        bool has_throttling = logger->throttling_since_start(episodes, duration_ns) && duration_ns;
+        for (const auto& e : episodes) {
+            if (has_throttling)
+                out << "," << 100.0f * e.total_ns / duration_ns << "," << e.count;
+            else
+                out << ",,";
+        }
     } else {
         SPDLOG_ERROR("Failed to write log file");
     }
     out.close();
 }
 
-static void writeFileHeaders(std::ofstream& out){
+// SMU_THROTTLER_*_BIT of amdgpu_smu.h, the layout of gpu_metrics::throttle_status
+static const std::pair<int, const char*> throttle_status_names[] = {
+    { 0, "PPT0" }, { 1, "PPT1" }, { 2, "PPT2" }, { 3, "PPT3" },
+    { 4, "SPL" }, { 5, "FPPT" }, { 6, "SPPT" }, { 7, "SPPT_APU" },
+    { 16, "TDC_GFX" }, { 17, "TDC_SOC" }, { 18, "TDC_MEM" }, { 19, "TDC_VDD" },
+    { 20, "TDC_CVIP" }, { 21, "EDC_CPU" }, { 22, "EDC_GFX" }, { 23, "APCC" },
+    { 32, "TEMP_GPU" }, { 33, "TEMP_CORE" }, { 34, "TEMP_MEM" }, { 35, "TEMP_EDGE" },
+    { 36, "TEMP_HOTSPOT" }, { 37, "TEMP_SOC" }, { 38, "TEMP_VR_GFX" }, { 39, "TEMP_VR_SOC" },
+    { 40, "TEMP_VR_MEM0" }, { 41, "TEMP_VR_MEM1" }, { 42, "TEMP_LIQUID0" }, { 43, "TEMP_LIQUID1" },
+    { 44, "VRHOT0" }, { 45, "VRHOT1" }, { 46, "PROCHOT_CPU" }, { 47, "PROCHOT_GFX" },
+    { 56, "PPM" }, { 57, "FIT" },
+};
+
+// Names of the set bits separated by '|', empty when not throttled
+static std::string throttle_status_string(uint64_t status) {
+    std::string names;
+    for (const auto& [bit, name] : throttle_status_names) {
+        if (!(status & (1ull << bit)))
+            continue;
+        if (!names.empty())
+            names += '|';
+        names += name;
+    }
+    return names;
+}
+
+static void writeFileHeaders(std::ofstream& out, size_t gpu_columns){
     auto params = get_params();  
     if (params->enabled[OVERLAY_PARAM_ENABLED_log_versioning]){
         out << "v1" << std::endl;
@@ -236,7 +286,28 @@ static void writeFileHeaders(std::ofstream& out){
     out << "fps," << "frametime," << "cpu_load," << "cpu_power," << "gpu_load,"
         << "cpu_temp," << "gpu_temp," << "gpu_core_clock," << "gpu_mem_clock,"
         << "gpu_vram_used," << "gpu_power," << "ram_used," << "swap_used,"
-        << "process_rss," << "cpu_mhz," << "elapsed" << std::endl;
+        << "process_rss," << "cpu_mhz," << "elapsed";
+
+    // Appended after elapsed, so tools reading the columns above by
+    // position keep working
+    out << ",gpu_junction_temp," << "gpu_mem_temp,"
+        << "gpu_mem_load," << "gpu_video_load," << "gpu_pcie_width," << "gpu_pcie_speed,"
+        << "gpu_throttle_status," << "gpu_requested_clock," << "gpu_idle_residency,"
+        << "gpu_engine_render," << "gpu_engine_compute,"
+        << "gpu_engine_copy," << "gpu_engine_video," << "gpu_sample_age,"
+        << "cpu_sample_age," << "mem_sample_age";
+
+    log_throttle_column = params->enabled[OVERLAY_PARAM_ENABLED_log_throttling];
+    if (log_throttle_column)
+        out << ",gpu_throttle_reasons";
+
+    // suffixed by the index used for GPU0, GPU1... in the HUD
+    for (size_t i = 0; i < gpu_columns; i++)
+        out << ",gpu_load_" << i << "," << "gpu_temp_" << i << ","
+            << "gpu_core_clock_" << i << "," << "gpu_mem_clock_" << i << ","
+            << "gpu_vram_used_" << i << "," << "gpu_power_" << i;
+
+    out << std::endl;
 }
 
 void Logger::writeToFile()
@@ -270,7 +341,9 @@ void Logger::writeToFile()
         }
 
         // 여기까지 왔으면 정상 오픈
-        writeFileHeaders(output_file);
+        auto& logArray = logger->get_log_data();
+        log_gpu_columns = logArray.empty() ? 0 : logArray.back().gpu_count;
+        writeFileHeaders(output_file, log_gpu_columns);
     }
 
     auto& logArray = logger->get_log_data();
@@ -295,8 +368,36 @@ void Logger::writeToFile()
                 << back.swap_used << ","
                 << back.process_rss << ","
                 << back.cpu_mhz << ","
-                << std::chrono::duration_cast<std::chrono::nanoseconds>(back.previous).count()
-                << "\n";
+                << std::chrono::duration_cast<std::chrono::nanoseconds>(back.previous).count();
+
+    output_file << "," << back.gpu_junction_temp
+                << "," << back.gpu_mem_temp
+                << "," << back.gpu_mem_load
+                << "," << back.gpu_video_load
+                << "," << back.gpu_pcie_width
+                << "," << back.gpu_pcie_speed
+                << "," << throttle_status_string(back.gpu_throttle_status)
+                << "," << back.gpu_requested_clock
+                << "," << back.gpu_idle_residency
+                << "," << back.gpu_engine_render
+                << "," << back.gpu_engine_compute
+                << "," << back.gpu_engine_copy
+                << "," << back.gpu_engine_video
+                << "," << back.gpu_sample_age
+                << "," << back.cpu_sample_age
+                << "," << back.mem_sample_age;
+
+    if (log_throttle_column)
+        output_file << "," << int(back.gpu_throttle_reasons);
+
+    // keep the column count of the header if the selection changed since
+    for (size_t i = 0; i < log_gpu_columns; i++) {
+        const logGpuData g = i < back.gpu_count ? back.gpus[i] : logGpuData {};
+        output_file << "," << g.load << "," << g.temp << "," << g.core_clock << ","
+                    << g.mem_clock << "," << g.vram_used << "," << g.power;
+    }
+
+    output_file << "\n";
     // flush 없음: 안드로이드 I/O 목 조르던 쓰레기 호출 제거
 }
 
@@ -331,6 +432,13 @@ void Logger::start_logging() {
     m_logging_on   = true;
     m_log_start    = Clock::now();
 
+    m_throttling = gpus && gpus->active_gpu() ? gpus->active_gpu()->throttling() : nullptr;
+    if (m_throttling) {
+        m_throttle_start_ns = os_time_get_nano();
+        for (int i = 0; i < THROTTLE_REASON_COUNT; i++)
+            m_throttle_start[i] = m_throttling->episodes(throttle_reason(i), m_throttle_start_ns);
+    }
+
     std::string program = get_wine_exe_name();
     if (program.empty())
         program = get_program_name();
@@ -392,6 +500,21 @@ void Logger::stop_logging()
 #endif
 }
 
+bool Logger::throttling_since_start(std::array<throttle_episodes, THROTTLE_REASON_COUNT>& episodes,
+                                    uint64_t& duration_ns) const {
+    episodes = {};
+    duration_ns = 0;
+    if (!m_throttling)
+        return false;
+
+    uint64_t now = os_time_get_nano();
+    for (int i = 0; i < THROTTLE_REASON_COUNT; i++)
+        episodes[i] = throttle_episodes_since(m_throttle_start[i],
+                                              m_throttling->episodes(throttle_reason(i), now));
+    duration_ns = now - m_throttle_start_ns;
+    return true;
+}
+
 void Logger::logging(){
     wait_until_data_valid();
     while (is_active()){
@@ -410,6 +533,12 @@ void Logger::try_log() {
     currentLogData.previous   = elapsedLog;
     currentLogData.fps        = fps;
     currentLogData.frametime  = frametime;
+
+    // how old the hardware readings paired with this frame are, in ms
+    uint64_t now_ns = os_time_get_nano();
+    currentLogData.gpu_sample_age = sample_age_ms(now_ns, currentLogData.gpu_sample_ns);
+    currentLogData.cpu_sample_age = sample_age_ms(now_ns, currentLogData.cpu_sample_ns);
+    currentLogData.mem_sample_age = sample_age_ms(now_ns, currentLogData.mem_sample_ns);
     m_log_array.push_back(currentLogData);
     writeToFile();
 
@@ -2,17 +2,32 @@
 #ifndef MANGOHUD_LOGGING_H
 #define MANGOHUD_LOGGING_H
 
+#include <array>
 #include <iostream>
 #include <vector>
 #include <fstream>
 #include <chrono>
 #include <thread>
 #include <condition_variable>
+#include <memory>
 
 #include "timing.hpp"
+#include "gpu_metrics_util.h"
 
 #include "overlay_params.h"
 
+#define LOG_MAX_GPUS 4
+
+// Per GPU columns, only written when more than one GPU is selected
+struct logGpuData{
+  int load;
+  int temp;
+  int core_clock;
+  int mem_clock;
+  float vram_used;
+  int power;
+};
+
 struct logData{
   double fps;
   float frametime;
@@ -29,6 +44,28 @@ struct logData{
   float ram_used;
   float swap_used;
   float process_rss;
+  int gpu_junction_temp;
+  int gpu_mem_temp;
+  int gpu_mem_load;
+  int gpu_video_load;
+  int gpu_pcie_width;
+  float gpu_pcie_speed;
+  uint64_t gpu_throttle_status;
+  uint8_t gpu_throttle_reasons;
+  int gpu_requested_clock;
+  int gpu_idle_residency;
+  int gpu_engine_render;
+  int gpu_engine_compute;
+  int gpu_engine_copy;
+  int gpu_engine_video;
+  float gpu_sample_age;
+  float cpu_sample_age;
+  float mem_sample_age;
+  uint64_t gpu_sample_ns;
+  uint64_t cpu_sample_ns;
+  uint64_t mem_sample_ns;
+  std::array<logGpuData, LOG_MAX_GPUS> gpus;
+  uint8_t gpu_count;
 
   Clock::duration previous;
 };
@@ -59,6 +96,10 @@ public:
   void upload_last_log();
   void upload_last_logs();
   void calculate_benchmark_data();
+
+  // Throttling of the active GPU since start_logging(), false if it has none
+  bool throttling_since_start(std::array<throttle_episodes, THROTTLE_REASON_COUNT>& episodes,
+                              uint64_t& duration_ns) const;
   std::string output_folder;
   const int64_t log_interval;
   const int64_t log_duration;
@@ -71,6 +112,10 @@ private:
   Clock::time_point m_log_end;
   bool m_logging_on;
 
+  std::shared_ptr<Throttling> m_throttling;
+  std::array<throttle_episodes, THROTTLE_REASON_COUNT> m_throttle_start;
+  uint64_t m_throttle_start_ns = 0;
+
   std::mutex m_values_valid_mtx;
   std::condition_variable m_values_valid_cv;
   bool m_values_valid;
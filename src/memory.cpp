@@ -5,6 +5,7 @@
 #include <unistd.h>
 
 #include "memory.h"
+#include "mesa/util/os_time.h"
 
 #ifndef TEST_ONLY
 #include "hud_elements.h"
@@ -12,6 +13,7 @@
 
 float memused, memmax, swapused;
 uint64_t proc_mem_resident, proc_mem_shared, proc_mem_virt;
+uint64_t meminfo_sample_ns;
 
 // "Label:   12345 kB" 형태에서 숫자만 추출해서 GiB로 변환
 static inline float parse_kb_to_gib(const char* line)
@@ -75,6 +77,7 @@ void update_meminfo()
     }
 
     std::fclose(f);
+    uint64_t sample_ns = os_time_get_nano();
 
     if (mem_total <= 0.0f)
         return;
@@ -88,6 +91,7 @@ void update_meminfo()
     memmax   = mem_total;
     memused  = mem_total - mem_avail;
     swapused = (swap_total > swap_free) ? (swap_total - swap_free) : 0.0f;
+    meminfo_sample_ns = sample_ns;
 }
 
 void update_procmem()
@@ -6,6 +6,8 @@
 
 extern float memused, memmax, swapused;
 extern uint64_t proc_mem_resident, proc_mem_shared, proc_mem_virt;
+// os_time_get_nano() of the last successful update_meminfo() read
+extern uint64_t meminfo_sample_ns;
 
 void update_meminfo();
 void update_procmem();
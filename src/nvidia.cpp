@@ -7,6 +7,7 @@
 #include <thread>
 #include <chrono>
 #include "mesa/util/macros.h"
+#include "mesa/util/os_time.h"
 
 #if defined(HAVE_XNVCTRL) && defined(HAVE_X11)
 void NVIDIA::parse_token(std::string token, std::unordered_map<std::string, std::string>& options) {
@@ -66,7 +67,7 @@ NVIDIA::NVIDIA(const char* pciBusId) {
 #endif
 
     if (nvml_available || nvctrl_available) {
-        throttling = std::make_shared<Throttling>(0x10de);
+        throttling = std::make_shared<Throttling>();
         thread = std::thread(&NVIDIA::get_samples_and_copy, this);
         pthread_setname_np(thread.native_handle(), "mangohud-nvidia");
     } else {
@@ -75,6 +76,10 @@ NVIDIA::NVIDIA(const char* pciBusId) {
 }
 
 #ifdef HAVE_NVML
+bool NVIDIA::nvml_update_samples(nvml_sample_buffer& buffer) {
+    return nvml_update_sample_buffer(*nvml, device, buffer, os_time_get_nano());
+}
+
 void NVIDIA::get_instant_metrics_nvml(struct gpu_metrics *metrics) {
     auto params = get_params();
     nvmlReturn_t response;
@@ -92,6 +97,22 @@ void NVIDIA::get_instant_metrics_nvml(struct gpu_metrics *metrics) {
         }
 
         metrics->load = nvml_utilization.gpu;
+        if (nvml_update_samples(load_samples))
+            metrics->load = load_samples.avg + 0.5f;
+
+        if ((params->enabled[OVERLAY_PARAM_ENABLED_gpu_mem_load] || (logger && logger->is_active())) &&
+            nvml_update_samples(mem_load_samples))
+            metrics->mem_load = mem_load_samples.avg + 0.5f;
+
+        if (params->enabled[OVERLAY_PARAM_ENABLED_gpu_proc_load] && nvml_proc_load_supported) {
+            response = nvml_read_process_load(*nvml, device, pid, last_proc_sample_us, proc_load);
+            if (response == NVML_ERROR_NOT_SUPPORTED) {
+                SPDLOG_DEBUG("nvmlDeviceGetProcessUtilization not supported");
+                nvml_proc_load_supported = false;
+            }
+            // the last good reading, -1 until there is one
+            metrics->proc_load = proc_load.sm;
+        }
 
         if (params->enabled[OVERLAY_PARAM_ENABLED_gpu_temp] || (logger && logger->is_active())) {
             unsigned int temp;
@@ -113,6 +134,8 @@ void NVIDIA::get_instant_metrics_nvml(struct gpu_metrics *metrics) {
             unsigned int core_clock;
             nvml->nvmlDeviceGetClockInfo(device, NVML_CLOCK_GRAPHICS, &core_clock);
             metrics->CoreClock = core_clock;
+            if (nvml_update_samples(clock_samples))
+                metrics->CoreClock = clock_samples.avg + 0.5f;
         }
 
         if (params->enabled[OVERLAY_PARAM_ENABLED_gpu_mem_clock] || (logger && logger->is_active())) {
@@ -129,14 +152,15 @@ void NVIDIA::get_instant_metrics_nvml(struct gpu_metrics *metrics) {
             metrics->powerLimit = limit / 1000;
         }
 
-        if (params->enabled[OVERLAY_PARAM_ENABLED_throttling_status]) {
-            unsigned long long nvml_throttle_reasons;
+        if (params->enabled[OVERLAY_PARAM_ENABLED_throttling_status] ||
+            params->enabled[OVERLAY_PARAM_ENABLED_throttling_status_graph] || (logger && logger->is_active())) {
+            unsigned long long nvml_throttle_reasons = 0;
             nvml->nvmlDeviceGetCurrentClocksThrottleReasons(device, &nvml_throttle_reasons);
             metrics->is_temp_throttled = (nvml_throttle_reasons & 0x0000000000000060LL) != 0;
             metrics->is_power_throttled = (nvml_throttle_reasons & 0x000000000000008CLL) != 0;
             metrics->is_other_throttled = (nvml_throttle_reasons & 0x0000000000000112LL) != 0;
             if (throttling)
-		        throttling->indep_throttle_status = nvml_throttle_reasons;
+                throttling->set_reasons(gpu_throttle_reasons(*metrics));
         }
 
         if (params->enabled[OVERLAY_PARAM_ENABLED_gpu_fan] || (logger && logger->is_active())){
@@ -248,6 +272,8 @@ void NVIDIA::get_samples_and_copy() {
         std::unique_lock<std::mutex> lock(metrics_mutex);
         cond_var.wait(lock, [this]() { return !paused || stop_thread; });
         GPU_UPDATE_METRIC_AVERAGE(load);
+        GPU_UPDATE_METRIC_AVERAGE(mem_load);
+        GPU_UPDATE_METRIC_AVERAGE(proc_load);
         GPU_UPDATE_METRIC_AVERAGE_FLOAT(powerUsage);
         GPU_UPDATE_METRIC_MAX(powerLimit);
         GPU_UPDATE_METRIC_AVERAGE(CoreClock);
@@ -265,6 +291,9 @@ void NVIDIA::get_samples_and_copy() {
         GPU_UPDATE_METRIC_MAX(is_other_throttled);
 
         GPU_UPDATE_METRIC_MAX(fan_speed);
+
+        metrics.timestamp_ns = os_time_get_nano();
+        published_metrics.store(metrics);
     }
 }
 
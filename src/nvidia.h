@@ -2,6 +2,7 @@
 #include "gpu.h"
 #ifdef HAVE_NVML
 #include "loaders/loader_nvml.h"
+#include "nvml_samples.h"
 #endif
 #ifdef HAVE_XNVCTRL
 #include "loaders/loader_nvctrl.h"
@@ -16,8 +17,7 @@ class NVIDIA {
         bool nvctrl_available = false;
 
         gpu_metrics copy_metrics() {
-            std::lock_guard<std::mutex> lock(metrics_mutex);
-            return metrics;
+            return published_metrics.load();
         };
 
         void get_samples_and_copy();
@@ -86,6 +86,7 @@ class NVIDIA {
         pid_t pid = getpid();
         std::mutex metrics_mutex;
         gpu_metrics metrics;
+        metrics_snapshot<gpu_metrics> published_metrics;
         std::thread thread;
         std::condition_variable cond_var;
         std::atomic<bool> stop_thread{false};
@@ -96,6 +97,15 @@ class NVIDIA {
 
         std::vector<nvmlProcessInfo_v1_t> process_info = {};
 
+        nvml_sample_buffer load_samples {NVML_GPU_UTILIZATION_SAMPLES};
+        nvml_sample_buffer mem_load_samples {NVML_MEMORY_UTILIZATION_SAMPLES};
+        nvml_sample_buffer clock_samples {NVML_PROCESSOR_CLK_SAMPLES};
+
+        unsigned long long last_proc_sample_us = 0;
+        nvml_process_load proc_load;
+        bool nvml_proc_load_supported = true;
+
+        bool nvml_update_samples(nvml_sample_buffer& buffer);
         void get_instant_metrics_nvml(struct gpu_metrics *metrics);
         std::shared_ptr<libnvml_loader> nvml = get_libnvml_loader();
 #endif
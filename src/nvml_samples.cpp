@@ -0,0 +1,143 @@
+#include "nvml_samples.h"
+#include <algorithm>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+static float nvml_value(nvmlValueType_t type, const nvmlValue_t& value) {
+    switch (type) {
+        case NVML_VALUE_TYPE_DOUBLE:
+            return value.dVal;
+        case NVML_VALUE_TYPE_UNSIGNED_LONG:
+            return value.ulVal;
+        case NVML_VALUE_TYPE_UNSIGNED_LONG_LONG:
+            return value.ullVal;
+        case NVML_VALUE_TYPE_SIGNED_LONG_LONG:
+            return value.sllVal;
+        case NVML_VALUE_TYPE_UNSIGNED_INT:
+        default:
+            return value.uiVal;
+    }
+}
+
+nvmlReturn_t nvml_read_samples(libnvml_loader& nvml, nvmlDevice_t device,
+                               nvmlSamplingType_t type,
+                               unsigned long long& last_seen_us,
+                               nvml_sample_stats& stats) {
+    nvmlValueType_t value_type;
+    unsigned int count = 0;
+
+    if (!nvml.nvmlDeviceGetSamples)
+        return NVML_ERROR_NOT_SUPPORTED;
+
+    nvmlReturn_t ret = nvml.nvmlDeviceGetSamples(device, type, last_seen_us, &value_type, &count, nullptr);
+    if (ret != NVML_SUCCESS)
+        return ret;
+
+    if (count == 0)
+        return NVML_ERROR_NOT_FOUND;
+
+    // the buffer is small (~100 entries) and reused every poll
+    thread_local std::vector<nvmlSample_t> samples;
+    samples.resize(count);
+
+    ret = nvml.nvmlDeviceGetSamples(device, type, last_seen_us, &value_type, &count, samples.data());
+    if (ret != NVML_SUCCESS)
+        return ret;
+
+    stats = {};
+    float sum = 0.f;
+
+    for (unsigned int i = 0; i < std::min<size_t>(count, samples.size()); i++) {
+        const auto& sample = samples[i];
+
+        // older drivers ignore lastSeenTimeStamp for some types
+        if (sample.timeStamp <= last_seen_us && last_seen_us)
+            continue;
+
+        float value = nvml_value(value_type, sample.sampleValue);
+        sum += value;
+        stats.max = std::max(stats.max, value);
+        stats.count++;
+    }
+
+    for (unsigned int i = 0; i < std::min<size_t>(count, samples.size()); i++)
+        last_seen_us = std::max(last_seen_us, samples[i].timeStamp);
+
+    if (stats.count == 0)
+        return NVML_ERROR_NOT_FOUND;
+
+    stats.avg = sum / stats.count;
+    return NVML_SUCCESS;
+}
+
+bool nvml_update_sample_buffer(libnvml_loader& nvml, nvmlDevice_t device,
+                               nvml_sample_buffer& buffer, uint64_t now_ns) {
+    if (!buffer.supported)
+        return false;
+
+    nvml_sample_stats stats;
+    nvmlReturn_t ret = nvml_read_samples(nvml, device, buffer.type, buffer.last_seen_us, stats);
+    if (ret == NVML_SUCCESS) {
+        buffer.avg = stats.avg;
+        buffer.avg_ns = now_ns;
+        return true;
+    }
+
+    if (ret == NVML_ERROR_NOT_SUPPORTED) {
+        SPDLOG_DEBUG("nvmlDeviceGetSamples not supported for sampling type {}, using instant values",
+                     int(buffer.type));
+        buffer.supported = false;
+        buffer.avg = -1.f;
+        return false;
+    }
+
+    // no new sample, or a failed read, since the last poll
+    if (buffer.avg >= 0.f && now_ns - buffer.avg_ns > nvml_sample_max_age_ns)
+        buffer.avg = -1.f;
+
+    return buffer.avg >= 0.f;
+}
+
+nvmlReturn_t nvml_read_process_load(libnvml_loader& nvml, nvmlDevice_t device,
+                                    unsigned int pid,
+                                    unsigned long long& last_seen_us,
+                                    nvml_process_load& load) {
+    unsigned int count = 0;
+
+    if (!nvml.nvmlDeviceGetProcessUtilization)
+        return NVML_ERROR_NOT_SUPPORTED;
+
+    nvmlReturn_t ret = nvml.nvmlDeviceGetProcessUtilization(device, nullptr, &count, last_seen_us);
+    if (ret != NVML_SUCCESS && ret != NVML_ERROR_INSUFFICIENT_SIZE)
+        return ret;
+
+    if (count == 0)
+        return NVML_ERROR_NOT_FOUND;
+
+    thread_local std::vector<nvmlProcessUtilizationSample_t> samples;
+    samples.resize(count);
+
+    ret = nvml.nvmlDeviceGetProcessUtilization(device, samples.data(), &count, last_seen_us);
+    if (ret != NVML_SUCCESS)
+        return ret;
+
+    nvml_process_load found;
+    unsigned long long newest = last_seen_us;
+    for (unsigned int i = 0; i < std::min<size_t>(count, samples.size()); i++) {
+        const auto& sample = samples[i];
+        newest = std::max(newest, sample.timeStamp);
+
+        if (sample.pid != pid)
+            continue;
+
+        found.sm = std::max<int>(found.sm, sample.smUtil);
+        found.mem = std::max<int>(found.mem, sample.memUtil);
+    }
+    last_seen_us = newest;
+
+    // processes without utilization in the period are left out
+    load.sm = std::max(found.sm, 0);
+    load.mem = std::max(found.mem, 0);
+
+    return NVML_SUCCESS;
+}
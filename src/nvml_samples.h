@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include "loaders/loader_nvml.h"
+
+/* Reduction of one of the driver's sample buffers since the last read */
+struct nvml_sample_stats {
+    unsigned int count = 0;
+    float avg = 0.f;
+    float max = 0.f;
+};
+
+/* The driver keeps a high rate buffer of these, reading everything since
+ * the last poll catches bursts that instant values miss. `avg` is -1
+ * while there is no recent enough average to show.
+ */
+struct nvml_sample_buffer {
+    nvmlSamplingType_t type;
+    bool supported = true;
+    unsigned long long last_seen_us = 0;
+    float avg = -1.f;
+    /* os_time_get_nano() when `avg` was read */
+    uint64_t avg_ns = 0;
+};
+
+/* Averages older than this are dropped when the driver stops sampling */
+static const uint64_t nvml_sample_max_age_ns = 1'000'000'000;
+
+/* Per process SM and memory controller utilization, -1 until read */
+struct nvml_process_load {
+    int sm = -1;
+    int mem = -1;
+};
+
+/* Reads the samples of `type` newer than `last_seen_us` and advances it
+ * to the newest one returned. NVML_ERROR_NOT_FOUND means the driver has
+ * not taken a new sample since the last read.
+ */
+nvmlReturn_t nvml_read_samples(libnvml_loader& nvml, nvmlDevice_t device,
+                               nvmlSamplingType_t type,
+                               unsigned long long& last_seen_us,
+                               nvml_sample_stats& stats);
+
+/* Updates `buffer` at `now_ns` and returns whether `avg` can be shown.
+ * Polls without a new sample keep the previous average until it is
+ * nvml_sample_max_age_ns old. NVML_ERROR_NOT_SUPPORTED only disables
+ * this sampling type, the others may still work.
+ */
+bool nvml_update_sample_buffer(libnvml_loader& nvml, nvmlDevice_t device,
+                               nvml_sample_buffer& buffer, uint64_t now_ns);
+
+/* Reads the utilization `pid` accumulated since `last_seen_us` and
+ * advances it like nvml_read_samples, `load` is left alone on errors.
+ * Both return NVML_ERROR_NOT_SUPPORTED when the driver lacks the call.
+ */
+nvmlReturn_t nvml_read_process_load(libnvml_loader& nvml, nvmlDevice_t device,
+                                    unsigned int pid,
+                                    unsigned long long& last_seen_us,
+                                    nvml_process_load& load);
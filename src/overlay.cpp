@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <thread>
 #include <condition_variable>
+#include <atomic>
 #include <spdlog/spdlog.h>
 #include <spdlog/cfg/env.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
@@ -54,6 +55,11 @@ int fan_speed;
 fcatoverlay fcatstatus;
 std::string drm_dev;
 int current_preset;
+static std::atomic<uint32_t> hud_generation {1};
+
+/* In retained mode, elements that move every frame (frametime graph, media
+ * player scrolling) are redrawn at this rate at most instead of the game's */
+static constexpr uint64_t hud_live_refresh_ns = 1000000000 / 60;
 
 void init_spdlog()
 {
@@ -144,23 +150,57 @@ void update_hw_info(const struct overlay_params& params, uint32_t vendorID)
       getIoStats(g_io_stats);
 #endif
    if (gpus && gpus->active_gpu()) {
-      currentLogData.gpu_load = gpus->active_gpu()->metrics.load;
-      currentLogData.gpu_temp = gpus->active_gpu()->metrics.temp;
-      currentLogData.gpu_core_clock = gpus->active_gpu()->metrics.CoreClock;
-      currentLogData.gpu_mem_clock = gpus->active_gpu()->metrics.MemClock;
-      currentLogData.gpu_vram_used = gpus->active_gpu()->metrics.sys_vram_used;
-      currentLogData.gpu_power = gpus->active_gpu()->metrics.powerUsage;
+      const gpu_metrics active_metrics = gpus->active_gpu()->metrics();
+      currentLogData.gpu_load = active_metrics.load;
+      currentLogData.gpu_temp = active_metrics.temp;
+      currentLogData.gpu_core_clock = active_metrics.CoreClock;
+      currentLogData.gpu_mem_clock = active_metrics.MemClock;
+      currentLogData.gpu_vram_used = active_metrics.sys_vram_used;
+      currentLogData.gpu_power = active_metrics.powerUsage;
+      currentLogData.gpu_junction_temp = active_metrics.junction_temp;
+      currentLogData.gpu_mem_temp = active_metrics.memory_temp;
+      currentLogData.gpu_mem_load = active_metrics.mem_load;
+      currentLogData.gpu_video_load = active_metrics.video_load;
+      currentLogData.gpu_pcie_width = active_metrics.pcie_link_width;
+      currentLogData.gpu_pcie_speed = active_metrics.pcie_link_speed;
+      currentLogData.gpu_throttle_status = active_metrics.throttle_status;
+      currentLogData.gpu_throttle_reasons = gpu_throttle_reasons(active_metrics);
+      currentLogData.gpu_requested_clock = active_metrics.requested_clock;
+      currentLogData.gpu_idle_residency = active_metrics.idle_residency;
+      currentLogData.gpu_sample_ns = active_metrics.timestamp_ns;
+
+      // busiest engine of each class, -1 if the driver has none
+      int engine_class_load[GPU_ENGINE_OTHER];
+      std::fill(std::begin(engine_class_load), std::end(engine_class_load), -1);
+      for (int i = 0; i < std::min(active_metrics.engine_count, GPU_METRICS_MAX_ENGINES); i++) {
+         auto& engine = active_metrics.engine_load[i];
+         if (engine.engine_class < GPU_ENGINE_OTHER)
+            engine_class_load[engine.engine_class] = std::max(engine_class_load[engine.engine_class], engine.load);
+      }
+      currentLogData.gpu_engine_render = engine_class_load[GPU_ENGINE_RENDER];
+      currentLogData.gpu_engine_compute = engine_class_load[GPU_ENGINE_COMPUTE];
+      currentLogData.gpu_engine_copy = engine_class_load[GPU_ENGINE_COPY];
+      currentLogData.gpu_engine_video = engine_class_load[GPU_ENGINE_VIDEO];
+
+      auto selected = gpus->selected_gpus();
+      currentLogData.gpu_count = selected.size() > 1 ? std::min<size_t>(selected.size(), LOG_MAX_GPUS) : 0;
+      for (size_t i = 0; i < currentLogData.gpu_count; i++) {
+         const gpu_metrics m = selected[i]->metrics();
+         currentLogData.gpus[i] = {m.load, m.temp, m.CoreClock, m.MemClock, m.sys_vram_used, int(m.powerUsage)};
+      }
    }
 #ifdef __linux__
    currentLogData.ram_used = memused;
    currentLogData.swap_used = swapused;
    currentLogData.process_rss = proc_mem_resident / float((2 << 29)); // GiB, consistent w/ other mem stats
+   currentLogData.mem_sample_ns = meminfo_sample_ns;
 #endif
 
    currentLogData.cpu_load = cpuStats.GetCPUDataTotal().percent;
    currentLogData.cpu_temp = cpuStats.GetCPUDataTotal().temp;
    currentLogData.cpu_power = cpuStats.GetCPUDataTotal().power;
    currentLogData.cpu_mhz = cpuStats.GetCPUDataTotal().cpu_mhz;
+   currentLogData.cpu_sample_ns = cpuStats.GetSampleTimeNs();
 
    // Save data for graphs
    if (graph_data.size() >= kMaxGraphEntries)
@@ -170,6 +210,38 @@ void update_hw_info(const struct overlay_params& params, uint32_t vendorID)
    HUDElements.update_exec();
 }
 
+void mark_hud_dirty()
+{
+   hud_generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool hud_needs_rebuild(struct swapchain_stats& sw_stats, const ImVec2& display_size)
+{
+   auto real_params = get_params();
+   uint64_t now = os_time_get_nano();
+   uint32_t generation = hud_generation.load(std::memory_order_relaxed);
+   auto& enabled = real_params->enabled;
+
+   bool live = enabled[OVERLAY_PARAM_ENABLED_frame_timing] ||
+               enabled[OVERLAY_PARAM_ENABLED_media_player];
+   bool rebuild = !enabled[OVERLAY_PARAM_ENABLED_hud_retained] ||
+                  // fcat needs a new colour every frame
+                  enabled[OVERLAY_PARAM_ENABLED_fcat] ||
+                  !sw_stats.last_hud_build ||
+                  generation != sw_stats.hud_generation ||
+                  display_size.x != sw_stats.hud_display_size.x ||
+                  display_size.y != sw_stats.hud_display_size.y ||
+                  (live && now - sw_stats.last_hud_build >= hud_live_refresh_ns);
+
+   if (!rebuild)
+      return false;
+
+   sw_stats.hud_generation = generation;
+   sw_stats.hud_display_size = display_size;
+   sw_stats.last_hud_build = now;
+   return true;
+}
+
 struct hw_info_updater
 {
    bool quit = false;
@@ -220,6 +292,8 @@ struct hw_info_updater
             update_hw_info(*params, vendorID);
          }
          update_hw_info_thread = false;
+         // new values are only shown once this sample is done
+         mark_hud_dirty();
       }
    }
 };
@@ -293,6 +367,7 @@ void update_hud_info_with_frametime(struct swapchain_stats& sw_stats, const stru
 
       sw_stats.n_frames_since_update = 0;
       sw_stats.last_fps_update = now;
+      mark_hud_dirty();
 
    }
    auto min = std::min_element(frametime_data.begin(), frametime_data.end());
@@ -318,7 +393,10 @@ void update_hud_info_with_frametime(struct swapchain_stats& sw_stats, const stru
 void update_hud_info(struct swapchain_stats& sw_stats, const struct overlay_params& params, uint32_t vendorID){
    uint64_t now = os_time_get_nano(); /* ns */
    uint64_t frametime_ns = now - sw_stats.last_present_time;
-   if (!get_params()->no_display || logger->is_active())
+   auto real_params = get_params();
+   if (gpus)
+      gpus->update_sampling(real_params, logger->is_active());
+   if (!real_params->no_display || logger->is_active())
       update_hud_info_with_frametime(sw_stats, params, vendorID, frametime_ns);
 }
 
@@ -426,9 +504,12 @@ void RenderOutlinedText(const char* text, ImU32 textColor)
     ImVec2 pos = window->DC.CursorPos;
 
     ImDrawList* draw = ImGui::GetWindowDrawList();
+    request_glyphs(font, text);
 
     float t = HUDElements.params->text_outline_thickness;
-    bool outlineEnabled = HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_text_outline] && t > 0.0f;
+    // with a font_sdf atlas the shaders draw the outline
+    bool outlineEnabled = HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_text_outline] && t > 0.0f &&
+                          !HUDElements.sw_stats->font_sdf;
 
     if (outlineEnabled)
     {
@@ -454,6 +535,8 @@ void right_aligned_text(ImVec4& col, float off_x, const char *fmt, ...)
    va_end(args);
 
    if (!HUDElements.params->enabled[OVERLAY_PARAM_ENABLED_hud_compact]){
+      // measured before RenderOutlinedText() asks for them
+      request_glyphs(ImGui::GetFont(), buffer);
       ImVec2 sz = ImGui::CalcTextSize(buffer);
       ImGui::SetCursorPosX(pos.x + off_x - sz.x);
    }
@@ -463,6 +546,7 @@ void right_aligned_text(ImVec4& col, float off_x, const char *fmt, ...)
 
 void center_text(const std::string& text)
 {
+   request_glyphs(ImGui::GetFont(), text.c_str());
    ImGui::SetCursorPosX((ImGui::GetWindowSize().x / 2 )- (ImGui::CalcTextSize(text.c_str()).x / 2));
 }
 
@@ -500,7 +584,10 @@ void render_mpris_metadata(const struct overlay_params& params, mutexed_metadata
          ImGui::Dummy(ImVec2(0.0f, 20.0f));
       }
 
-      if (meta.ticker.needs_recalc) {
+      // widths measured before the atlas had the glyphs are off
+      uint32_t glyphs_generation = lazy_glyphs_generation();
+      if (meta.ticker.needs_recalc || meta.ticker.glyphs_generation != glyphs_generation) {
+         meta.ticker.glyphs_generation = glyphs_generation;
          meta.ticker.formatted.clear();
          meta.ticker.longest = 0;
          for (const auto& f : params.media_player_format)
@@ -517,6 +604,7 @@ void render_mpris_metadata(const struct overlay_params& params, mutexed_metadata
             {
                SPDLOG_ERROR("formatting error in '{}': {}", f, err.what());
             }
+            request_glyphs(ImGui::GetFont(), str.c_str());
             float w = ImGui::CalcTextSize(str.c_str()).x;
             meta.ticker.longest = std::max(meta.ticker.longest, w);
             meta.ticker.formatted.push_back({str, w});
@@ -3,6 +3,14 @@ layout(location = 0) out vec4 fColor;
 
 layout(set=0, binding=0) uniform sampler2D sTexture;
 
+/* font_sdf: sTexture holds distances to the glyph edges when sdf_spread is
+ * not 0, see create_fonts() */
+layout(push_constant) uniform uPushConstant{
+    layout(offset = 16) float sdf_spread;
+    float sdf_outline;
+    layout(offset = 32) vec4 sdf_outline_color;
+} pc;
+
 layout(location = 0) in struct{
     vec4 Color;
     vec2 UV;
@@ -10,5 +18,21 @@ layout(location = 0) in struct{
 
 void main()
 {
-    fColor = In.Color * vec4(1, 1, 1, texture(sTexture, In.UV.st).r);
+    float value = texture(sTexture, In.UV.st).r;
+    if (pc.sdf_spread == 0.0) {
+        fColor = In.Color * vec4(1, 1, 1, value);
+        return;
+    }
+
+    // fill and outline coverage from the distance in texels, positive inside
+    float dist = (value - 0.5) * 2.0 * pc.sdf_spread;
+    float aa = max(fwidth(dist), 0.001);
+    float fill = clamp(dist / aa + 0.5, 0.0, 1.0);
+    float outline = clamp((dist + pc.sdf_outline) / aa + 0.5, 0.0, 1.0);
+
+    float fill_alpha = In.Color.a * fill;
+    float outline_alpha = pc.sdf_outline_color.a * max(outline - fill, 0.0);
+    float alpha = fill_alpha + outline_alpha;
+    vec3 color = In.Color.rgb * fill_alpha + pc.sdf_outline_color.rgb * outline_alpha;
+    fColor = vec4(color / max(alpha, 0.0001), alpha);
 }
@@ -50,12 +50,24 @@ struct swapchain_stats {
    ImFont* font_text = nullptr;
    ImFont* font_secondary = nullptr;
    size_t font_params_hash = 0;
+   /* font_sdf: the atlas holds distances to the glyph edges */
+   bool font_sdf = false;
+   /* lazy_glyphs_generation() the atlas was built with */
+   uint32_t font_glyphs_generation = 0;
    std::string time;
    double fps;
    uint64_t last_present_time;
    unsigned n_frames_since_update;
    uint64_t last_fps_update;
    ImVec2 main_window_pos;
+   /* Vulkan timestamp queries, -1 until the first sample */
+   float gpu_frame_ms = -1;
+   float gpu_busy = -1;
+   uint64_t gpu_frame_end_ns = 0;
+   /* last HUD build, see hud_needs_rebuild() */
+   uint32_t hud_generation = 0;
+   uint64_t last_hud_build = 0;
+   ImVec2 hud_display_size;
    
    struct {
       int32_t major;
@@ -161,9 +173,31 @@ void update_hud_info_with_frametime(struct swapchain_stats& sw_stats, const stru
 void update_hw_info(const struct overlay_params& params, uint32_t vendorID);
 void init_cpu_stats(overlay_params& params);
 void check_keybinds(overlay_params& params);
+/* hud_retained: the last ImGui draw data is kept until something shown on
+ * the HUD changes. mark_hud_dirty() requests a rebuild on every swapchain */
+void mark_hud_dirty();
+bool hud_needs_rebuild(struct swapchain_stats& sw_stats, const ImVec2& display_size);
 void init_system_info(void);
 void check_for_vkbasalt_and_gamemode();
-void create_fonts(ImFontAtlas* font_atlas, const overlay_params& params, ImFont*& small_font, ImFont*& text_font, ImFont*& secondary_font);
+/* sdf: store distances to the glyph edges in the atlas instead of coverage,
+ * font_sdf_spread texels on both sides of an edge map to 0..1. Only for
+ * renderers whose shaders decode it, with the outline font_sdf_outline()
+ * returns drawn in the same pass */
+constexpr float font_sdf_spread = 4.0f;
+void create_fonts(ImFontAtlas* font_atlas, const overlay_params& params, ImFont*& small_font, ImFont*& text_font, ImFont*& secondary_font, bool sdf = false);
+float font_sdf_outline(const overlay_params& params, ImVec4& color);
+/* font_glyph_ranges are only added to the atlas once HUD text uses them.
+ * request_glyphs() notes the ones `text` misses from `font`. When
+ * lazy_glyphs_generation() changes, add_requested_glyphs() puts them in
+ * room create_fonts() left in the atlas and grows `dirty` by the texels
+ * to upload again. If they do not fit it returns false, and the fonts
+ * have to be created again. */
+struct font_atlas_rect {
+   int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+};
+void request_glyphs(ImFont* font, const char* text);
+uint32_t lazy_glyphs_generation();
+bool add_requested_glyphs(ImFontAtlas* atlas, font_atlas_rect& dirty);
 void right_aligned_text(ImVec4& col, float off_x, const char *fmt, ...);
 void center_text(const std::string& text);
 ImVec4 change_on_load_temp(LOAD_DATA& data, unsigned current);
@@ -63,6 +63,8 @@ apply_android_overlay_policy(struct overlay_params* params)
     params->enabled[OVERLAY_PARAM_ENABLED_gpu_power_limit]    = 0;
     params->enabled[OVERLAY_PARAM_ENABLED_cpu_power]          = 0;
     params->enabled[OVERLAY_PARAM_ENABLED_gpu_voltage]        = 0;
+    params->enabled[OVERLAY_PARAM_ENABLED_gpu_pcie_link]      = 0;
+    params->enabled[OVERLAY_PARAM_ENABLED_apu_cores]          = 0;
     params->enabled[OVERLAY_PARAM_ENABLED_cpu_efficiency]     = 0;
     params->enabled[OVERLAY_PARAM_ENABLED_gpu_efficiency]     = 0;
     params->enabled[OVERLAY_PARAM_ENABLED_flip_efficiency]    = 0;
@@ -851,6 +853,19 @@ static void set_param_defaults(struct overlay_params *params){
    params->enabled[OVERLAY_PARAM_ENABLED_cpu_load_change] = false;
    params->enabled[OVERLAY_PARAM_ENABLED_core_load_change] = false;
    params->enabled[OVERLAY_PARAM_ENABLED_gpu_voltage] = false;
+   params->enabled[OVERLAY_PARAM_ENABLED_gpu_mem_load] = false;
+   params->enabled[OVERLAY_PARAM_ENABLED_gpu_video_load] = false;
+   params->enabled[OVERLAY_PARAM_ENABLED_gpu_pcie_link] = false;
+   params->enabled[OVERLAY_PARAM_ENABLED_apu_cores] = false;
+   params->enabled[OVERLAY_PARAM_ENABLED_gpu_engines] = false;
+   params->enabled[OVERLAY_PARAM_ENABLED_sample_age] = false;
+   params->enabled[OVERLAY_PARAM_ENABLED_gpu_frametime] = false;
+   params->enabled[OVERLAY_PARAM_ENABLED_gpu_proc_load] = false;
+   params->enabled[OVERLAY_PARAM_ENABLED_gpu_requested_clock] = false;
+   params->enabled[OVERLAY_PARAM_ENABLED_gpu_idle_residency] = false;
+   params->enabled[OVERLAY_PARAM_ENABLED_log_throttling] = false;
+   params->enabled[OVERLAY_PARAM_ENABLED_hud_retained] = false;
+   params->enabled[OVERLAY_PARAM_ENABLED_font_sdf] = false;
    params->enabled[OVERLAY_PARAM_ENABLED_legacy_layout] = true;
    params->enabled[OVERLAY_PARAM_ENABLED_frametime] = true;
    params->enabled[OVERLAY_PARAM_ENABLED_fps_only] = false;
@@ -1096,7 +1111,8 @@ parse_overlay_config(struct overlay_params *params,
                                  params->font_file_text,
                                  params->font_glyph_ranges,
                                  params->font_scale,
-                                 params->font_size_secondary
+                                 params->font_size_secondary,
+                                 params->enabled[OVERLAY_PARAM_ENABLED_font_sdf]
                                 );
 
    // check if user specified an env for fps limiter instead
@@ -1370,6 +1386,7 @@ void presets(int preset, struct overlay_params *params, bool inherit) {
                add_to_options(params, "gpu_junction_temp", "0");
                add_to_options(params, "gpu_voltage", "0");
                add_to_options(params, "gpu_mem_temp", "0");
+               add_to_options(params, "gpu_pcie_link", "0");
                add_to_options(params, "gpu_efficiency", "0");
             }
             // Rembrandt and Phoenix APUs (Z1, Z1E, Z2 Go)
@@ -110,6 +110,19 @@ struct Tracepoint;
    OVERLAY_PARAM_BOOL(retro)                         \
    OVERLAY_PARAM_BOOL(gpu_fan)                       \
    OVERLAY_PARAM_BOOL(gpu_voltage)                   \
+   OVERLAY_PARAM_BOOL(gpu_mem_load)                  \
+   OVERLAY_PARAM_BOOL(gpu_video_load)                \
+   OVERLAY_PARAM_BOOL(gpu_pcie_link)                 \
+   OVERLAY_PARAM_BOOL(apu_cores)                     \
+   OVERLAY_PARAM_BOOL(gpu_engines)                   \
+   OVERLAY_PARAM_BOOL(sample_age)                    \
+   OVERLAY_PARAM_BOOL(gpu_frametime)                 \
+   OVERLAY_PARAM_BOOL(gpu_proc_load)                 \
+   OVERLAY_PARAM_BOOL(gpu_requested_clock)           \
+   OVERLAY_PARAM_BOOL(gpu_idle_residency)            \
+   OVERLAY_PARAM_BOOL(log_throttling)                \
+   OVERLAY_PARAM_BOOL(hud_retained)                  \
+   OVERLAY_PARAM_BOOL(font_sdf)                      \
    OVERLAY_PARAM_BOOL(engine_short_names)            \
    OVERLAY_PARAM_BOOL(hide_engine_names)             \
    OVERLAY_PARAM_BOOL(hide_fps_superscript)          \
@@ -1,5 +1,5 @@
 #include <vulkan/vulkan.h>
-#include "android_gpu_vk_usage.h"
+#include "vk_gpu_usage.h"
 
 #include <algorithm>
 #include <array>
@@ -27,6 +27,7 @@ constexpr auto kCooldownNotReadyLong = std::chrono::milliseconds{1000};
 constexpr auto kCooldownStaleSlot    = std::chrono::milliseconds{1000};
 constexpr auto kCooldownRecordFail   = std::chrono::milliseconds{1500};
 constexpr auto kSuspendedProbeEvery  = std::chrono::milliseconds{100};
+constexpr auto kCalibrateEvery       = std::chrono::milliseconds{1000};
 
 constexpr uint32_t kNotReadyLimit = 120u;
 constexpr auto     kNotReadyMaxTime = std::chrono::milliseconds{5000};
@@ -164,10 +165,10 @@ submit_with_fallback(SubmitFn&& submit_fn,
 
 enum class BackendMode : uint8_t { Active, Suspended, Disabled };
 
-struct AndroidVkGpuContext {
+struct VulkanGpuUsageContext {
     VkPhysicalDevice        phys_dev      = VK_NULL_HANDLE;
     VkDevice                device        = VK_NULL_HANDLE;
-    AndroidVkGpuDispatch    disp{};
+    VulkanGpuUsageDispatch    disp{};
 
     float                   ts_period_ns  = 0.0f; // ns per tick
     uint32_t                ts_valid_bits = 0;
@@ -184,7 +185,6 @@ struct AndroidVkGpuContext {
     static constexpr uint32_t FRAME_LAG             = 3;    // 몇 프레임 뒤에 슬롯을 읽고 해제할지
 
     std::atomic<BackendMode> mode{BackendMode::Active};
-    bool env_enabled = false;
 
     std::chrono::steady_clock::time_point suspend_until{};
 
@@ -229,6 +229,14 @@ struct AndroidVkGpuContext {
     float                                           last_gpu_ms   = 0.0f;
     float                                           last_usage    = 0.0f;
     bool                                            have_metrics  = false;
+    uint64_t                                        last_end_ns   = 0;
+
+    // ---- GPU tick -> CLOCK_MONOTONIC 보정 (guarded by metrics_mtx) ----
+    bool                                            can_calibrate    = false;
+    bool                                            have_calibration = false;
+    uint64_t                                        cal_gpu_ticks    = 0;
+    uint64_t                                        cal_cpu_ns       = 0;
+    std::chrono::steady_clock::time_point           last_calibration{};
 
     struct FrameSample { uint64_t serial; float ms; }; // metrics_mtx (present interval 기반 frame time)
     static constexpr uint32_t CPU_RING = 64;
@@ -237,20 +245,20 @@ struct AndroidVkGpuContext {
     static_assert((CPU_RING & (CPU_RING - 1u)) == 0u, "CPU_RING must be power-of-two");
 };
 
-static_assert(AndroidVkGpuContext::MAX_PAIRS_PER_FRAME <= 64u,
+static_assert(VulkanGpuUsageContext::MAX_PAIRS_PER_FRAME <= 64u,
                "valid_pairs_mask assumes <= 64 pairs/frame");
 
-struct AndroidGpuApiGuard {
-    AndroidVkGpuContext* ctx = nullptr;
+struct VulkanGpuUsageApiGuard {
+    VulkanGpuUsageContext* ctx = nullptr;
     bool armed = false;
 
-    explicit AndroidGpuApiGuard(AndroidVkGpuContext* c) : ctx(c) {
+    explicit VulkanGpuUsageApiGuard(VulkanGpuUsageContext* c) : ctx(c) {
         if (!ctx) return;
         ctx->in_flight.fetch_add(1, std::memory_order_acq_rel);
         armed = true;
     }
 
-    ~AndroidGpuApiGuard() {
+    ~VulkanGpuUsageApiGuard() {
         if (!armed || !ctx) return;
         if (ctx->in_flight.fetch_sub(1, std::memory_order_acq_rel) == 1) {
             if (ctx->destroying.load(std::memory_order_acquire))
@@ -260,24 +268,24 @@ struct AndroidGpuApiGuard {
 };
 
 // forward decls (submit wrapper uses these before their definitions)
-inline void
-android_gpu_usage_suspend_locked(AndroidVkGpuContext* ctx,
+static inline void
+vk_gpu_usage_suspend_locked(VulkanGpuUsageContext* ctx,
                                  const char* reason,
                                  std::chrono::milliseconds cooldown) noexcept;
 
 static bool
-android_gpu_usage_init_timestamp_resources(AndroidVkGpuContext* ctx,
+vk_gpu_usage_init_timestamp_resources(VulkanGpuUsageContext* ctx,
                                            uint32_t queue_family_index);
 
 static bool
-android_gpu_usage_begin_frame(AndroidVkGpuContext* ctx,
+vk_gpu_usage_begin_frame(VulkanGpuUsageContext* ctx,
                               uint32_t frame_idx,
                               uint64_t frame_serial);
 
 // ====================== submit commit/rollback helpers ======================
 namespace {
 inline void
-disarm_in_submit_locked(AndroidVkGpuContext* ctx, bool& armed, uint32_t slot_idx) noexcept
+disarm_in_submit_locked(VulkanGpuUsageContext* ctx, bool& armed, uint32_t slot_idx) noexcept
 {
     if (!armed || !ctx) return;
     ctx->frames[slot_idx].in_submit.fetch_sub(1, std::memory_order_acq_rel);
@@ -285,8 +293,8 @@ disarm_in_submit_locked(AndroidVkGpuContext* ctx, bool& armed, uint32_t slot_idx
 }
 
 static inline bool
-rollback_slot_if_safe_locked(AndroidVkGpuContext* ctx,
-                             AndroidVkGpuContext::FrameResources& fr,
+rollback_slot_if_safe_locked(VulkanGpuUsageContext* ctx,
+                             VulkanGpuUsageContext::FrameResources& fr,
                              uint64_t serial_snapshot,
                              uint32_t saved_query_used,
                              bool saved_has_queries,
@@ -302,8 +310,8 @@ rollback_slot_if_safe_locked(AndroidVkGpuContext* ctx,
 }
 
 inline void // LOCK: ctx->lock held.
-finalize_submit_locked(AndroidVkGpuContext* ctx,
-                       AndroidVkGpuContext::FrameResources& fr,
+finalize_submit_locked(VulkanGpuUsageContext* ctx,
+                       VulkanGpuUsageContext::FrameResources& fr,
                        VkResult vr,
                        uint64_t serial_snapshot,
                        uint32_t saved_query_used,
@@ -325,10 +333,10 @@ finalize_submit_locked(AndroidVkGpuContext* ctx,
     if (vr == VK_ERROR_DEVICE_LOST) {
         ctx->ts_supported.store(false, std::memory_order_relaxed);
         ctx->mode.store(BackendMode::Disabled, std::memory_order_relaxed);
-        SPDLOG_WARN("Android GPU usage: DEVICE_LOST -> disable backend");
+        SPDLOG_WARN("Vulkan GPU usage: DEVICE_LOST -> disable backend");
         return;
     }
-    android_gpu_usage_suspend_locked(ctx, fail_reason, kCooldownSubmitFail);
+    vk_gpu_usage_suspend_locked(ctx, fail_reason, kCooldownSubmitFail);
 }
 
 template <typename SubmitT>
@@ -359,8 +367,8 @@ struct TlsScratch {
 };
 
 inline void
-rollback_and_maybe_reset_locked(AndroidVkGpuContext* ctx,
-                                AndroidVkGpuContext::FrameResources& fr,
+rollback_and_maybe_reset_locked(VulkanGpuUsageContext* ctx,
+                                VulkanGpuUsageContext::FrameResources& fr,
                                 uint64_t serial_snapshot,
                                 uint32_t saved_query_used,
                                 bool saved_has_queries,
@@ -378,7 +386,7 @@ rollback_and_maybe_reset_locked(AndroidVkGpuContext* ctx,
         if (rolled && ctx->disp.ResetCommandPool && fr.cmd_pool != VK_NULL_HANDLE) {
             VkResult rr = ctx->disp.ResetCommandPool(ctx->device, fr.cmd_pool, 0);
             if (rr != VK_SUCCESS) {
-                android_gpu_usage_suspend_locked(ctx, "ResetCommandPool failed", kCooldownRecordFail);
+                vk_gpu_usage_suspend_locked(ctx, "ResetCommandPool failed", kCooldownRecordFail);
             }
         }
     } else {
@@ -386,8 +394,8 @@ rollback_and_maybe_reset_locked(AndroidVkGpuContext* ctx,
     }
 }
 bool
-android_gpu_usage_reserve_timestamp_pair_locked(AndroidVkGpuContext* ctx,
-                                                AndroidVkGpuContext::FrameResources& fr,
+vk_gpu_usage_reserve_timestamp_pair_locked(VulkanGpuUsageContext* ctx,
+                                                VulkanGpuUsageContext::FrameResources& fr,
                                                 uint32_t& out_query_first,
                                                 uint32_t& out_pair_index,
                                                 VkCommandBuffer& out_cmd_begin,
@@ -415,7 +423,7 @@ android_gpu_usage_reserve_timestamp_pair_locked(AndroidVkGpuContext* ctx,
 }
 
 bool // LOCK: ctx->lock NOT held. (serial_snapshot, q0 must be stable)
-android_gpu_usage_record_timestamp_pair_unlocked(AndroidVkGpuContext* ctx,
+vk_gpu_usage_record_timestamp_pair_unlocked(VulkanGpuUsageContext* ctx,
                                                  VkCommandBuffer cmd_begin,
                                                  VkCommandBuffer cmd_end,
                                                  uint32_t query_first) noexcept
@@ -446,8 +454,8 @@ android_gpu_usage_record_timestamp_pair_unlocked(AndroidVkGpuContext* ctx,
 
 template <typename SubmitT>
 inline void
-build_wrapped_submits_locked(AndroidVkGpuContext* ctx,
-                             AndroidVkGpuContext::FrameResources& fr,
+build_wrapped_submits_locked(VulkanGpuUsageContext* ctx,
+                             VulkanGpuUsageContext::FrameResources& fr,
                              const SubmitT* pSubmits,
                              uint32_t n,
                              TlsScratch<SubmitT>& tls,
@@ -476,7 +484,7 @@ build_wrapped_submits_locked(AndroidVkGpuContext* ctx,
         uint32_t query_first      = 0;
         uint32_t pair_index       = 0;
 
-        if (!android_gpu_usage_reserve_timestamp_pair_locked(ctx, fr, query_first, pair_index,
+        if (!vk_gpu_usage_reserve_timestamp_pair_locked(ctx, fr, query_first, pair_index,
                                                              cmd_begin, cmd_end)) {
 
             wrapped[i] = src;
@@ -503,8 +511,8 @@ build_wrapped_submits_locked(AndroidVkGpuContext* ctx,
 }
 
 inline void
-rollback_best_effort_locked(AndroidVkGpuContext* ctx,
-                            AndroidVkGpuContext::FrameResources& fr,
+rollback_best_effort_locked(VulkanGpuUsageContext* ctx,
+                            VulkanGpuUsageContext::FrameResources& fr,
                             uint64_t serial_snapshot,
                             uint32_t saved_query_used,
                             bool saved_has_queries) noexcept
@@ -518,7 +526,7 @@ rollback_best_effort_locked(AndroidVkGpuContext* ctx,
 
 template <typename SubmitT, typename SubmitFn>
 static VkResult
-android_gpu_usage_queue_submit_impl(AndroidVkGpuContext* ctx,
+vk_gpu_usage_queue_submit_impl(VulkanGpuUsageContext* ctx,
                                     uint32_t queue_family_index,
                                     uint32_t submitCount,
                                     const SubmitT* pSubmits,
@@ -526,7 +534,7 @@ android_gpu_usage_queue_submit_impl(AndroidVkGpuContext* ctx,
                                     SubmitFn&& submit_fn,
                                     const char* fail_reason)
 {
-    AndroidVkGpuContext::FrameResources* fr_ptr = nullptr;
+    VulkanGpuUsageContext::FrameResources* fr_ptr = nullptr;
     uint64_t serial_snapshot = 0;
     uint32_t saved_query_used = 0;
     bool     saved_has_queries = false;
@@ -556,10 +564,10 @@ android_gpu_usage_queue_submit_impl(AndroidVkGpuContext* ctx,
                     break; // queue-family mismatch: instrumentation pass-through
                 }
 
-                if (!android_gpu_usage_init_timestamp_resources(ctx, queue_family_index))
+                if (!vk_gpu_usage_init_timestamp_resources(ctx, queue_family_index))
                     break;
             
-                const uint32_t curr_idx = static_cast<uint32_t>(frame_serial % AndroidVkGpuContext::MAX_FRAMES);
+                const uint32_t curr_idx = static_cast<uint32_t>(frame_serial % VulkanGpuUsageContext::MAX_FRAMES);
                 serial_snapshot = frame_serial;
                 fr_ptr = &ctx->frames[curr_idx];
                 auto& fr = *fr_ptr;
@@ -567,7 +575,7 @@ android_gpu_usage_queue_submit_impl(AndroidVkGpuContext* ctx,
                 if (fr.in_submit.load(std::memory_order_acquire) != 0)
                     break;
                 
-                if (!android_gpu_usage_begin_frame(ctx, curr_idx, frame_serial))
+                if (!vk_gpu_usage_begin_frame(ctx, curr_idx, frame_serial))
                     break;
 
                 saved_query_used  = fr.query_used;
@@ -628,7 +636,7 @@ android_gpu_usage_queue_submit_impl(AndroidVkGpuContext* ctx,
         if (!tls.jobs.empty()) {
             std::lock_guard<std::mutex> rg(ctx->record_mtx);
             for (const auto& job : tls.jobs) {
-                if (!android_gpu_usage_record_timestamp_pair_unlocked(ctx, job.begin, job.end, job.q0)) {
+                if (!vk_gpu_usage_record_timestamp_pair_unlocked(ctx, job.begin, job.end, job.q0)) {
                     record_ok = false;
                     break;
                 }
@@ -643,7 +651,7 @@ android_gpu_usage_queue_submit_impl(AndroidVkGpuContext* ctx,
                                            saved_query_used, saved_has_queries,
                                            reserved_delta_queries);
 
-            android_gpu_usage_suspend_locked(ctx, "record timestamp CB failed", kCooldownRecordFail);
+            vk_gpu_usage_suspend_locked(ctx, "record timestamp CB failed", kCooldownRecordFail);
             return submit_fn(submitCount, pSubmits, fence);
         }
 
@@ -662,7 +670,7 @@ android_gpu_usage_queue_submit_impl(AndroidVkGpuContext* ctx,
                                                saved_query_used, saved_has_queries,
                                                reserved_delta_queries);
 
-                android_gpu_usage_suspend_locked(ctx,
+                vk_gpu_usage_suspend_locked(ctx,
                     "instrumented submit failed, fallback used",
                     kCooldownSubmitFail);
             } else {
@@ -674,9 +682,9 @@ android_gpu_usage_queue_submit_impl(AndroidVkGpuContext* ctx,
         }
         return vr;
     } catch (const std::exception& e) {
-        SPDLOG_WARN("Android GPU usage: submit wrapper exception: {}", e.what());
+        SPDLOG_WARN("Vulkan GPU usage: submit wrapper exception: {}", e.what());
     } catch (...) {
-        SPDLOG_WARN("Android GPU usage: submit wrapper unknown exception");
+        SPDLOG_WARN("Vulkan GPU usage: submit wrapper unknown exception");
     }
 
     if (ctx && fr_ptr) {
@@ -688,38 +696,8 @@ android_gpu_usage_queue_submit_impl(AndroidVkGpuContext* ctx,
 }
 } // namespace
 
-// ====================== 환경 변수 플래그 =====================
-// 정책: 기본 OFF(fdinfo + kgsl 사용). 오직 MANGOHUD_VKP=1 일 때만 Vulkan timestamp 백엔드 ON.
-// 캐시: -1 = 미초기화, 0 = 비활성, 1 = 활성
-namespace {
-static bool android_gpu_usage_env_enabled()
-{
-    // -1 = unknown, 0 = disabled, 1 = enabled
-    static std::atomic<int> cached{-1};
-
-    int v = cached.load(std::memory_order_relaxed);
-    if (v != -1) return v != 0;
-
-    const char* env = std::getenv("MANGOHUD_VKP");
-    const bool enabled = (env && env[0] == '1' && env[1] == '\0');
-    const int newv = enabled ? 1 : 0;
-
-    int expected = -1;
-    if (cached.compare_exchange_strong(expected, newv,
-                                       std::memory_order_relaxed)) {
-
-        if (!enabled)
-            SPDLOG_INFO("MANGOHUD_VKP!=1 -> Vulkan GPU usage backend disabled (fdinfo + kgsl remains default)");
-        else
-            SPDLOG_INFO("MANGOHUD_VKP=1 -> Vulkan GPU usage backend enabled");
-        return enabled;
-    }
-    return cached.load(std::memory_order_relaxed) != 0;
-}
-} // namespace
-
 static inline void
-android_gpu_usage_suspend_locked(AndroidVkGpuContext* ctx,
+vk_gpu_usage_suspend_locked(VulkanGpuUsageContext* ctx,
                                  const char* reason,
                                  std::chrono::milliseconds cooldown) noexcept
 {
@@ -742,11 +720,11 @@ android_gpu_usage_suspend_locked(AndroidVkGpuContext* ctx,
     ctx->notready_since = {};          // 시간 기반 NotReady도 리셋
     ctx->read_serial = ctx->frame_index.load(std::memory_order_relaxed);
 
-    SPDLOG_WARN("Android GPU usage: SUSPEND ({}) -> stop instrumentation, keep last metrics", reason);
+    SPDLOG_WARN("Vulkan GPU usage: SUSPEND ({}) -> stop instrumentation, keep last metrics", reason);
 }
 
 static inline bool
-android_gpu_usage_should_sample(const AndroidVkGpuContext* ctx) noexcept
+vk_gpu_usage_should_sample(const VulkanGpuUsageContext* ctx) noexcept
 {
     return ctx &&
            ctx->mode.load(std::memory_order_relaxed) == BackendMode::Active &&
@@ -757,10 +735,10 @@ android_gpu_usage_should_sample(const AndroidVkGpuContext* ctx) noexcept
 // ====================== 헬퍼: 타임스탬프 리소스 초기화 ======================
 
 static inline void
-android_gpu_usage_consume_slot(AndroidVkGpuContext::FrameResources& fr);
+vk_gpu_usage_consume_slot(VulkanGpuUsageContext::FrameResources& fr);
 
 static inline void
-android_gpu_usage_wait_idle_best_effort(AndroidVkGpuContext* ctx) noexcept
+vk_gpu_usage_wait_idle_best_effort(VulkanGpuUsageContext* ctx) noexcept
 {
     if (!ctx) return;
     if (ctx->device == VK_NULL_HANDLE) return;
@@ -774,19 +752,19 @@ android_gpu_usage_wait_idle_best_effort(AndroidVkGpuContext* ctx) noexcept
     VkResult r = ctx->disp.DeviceWaitIdle(ctx->device);
     if (r == VK_SUCCESS) return;
     if (r == VK_ERROR_DEVICE_LOST) {
-        SPDLOG_WARN("Android GPU usage: DeviceWaitIdle -> DEVICE_LOST (continue destroy)");
+        SPDLOG_WARN("Vulkan GPU usage: DeviceWaitIdle -> DEVICE_LOST (continue destroy)");
         return;
     }
-    SPDLOG_DEBUG("Android GPU usage: DeviceWaitIdle -> {} (continue destroy)", (int)r);
+    SPDLOG_DEBUG("Vulkan GPU usage: DeviceWaitIdle -> {} (continue destroy)", (int)r);
 }
 
 static void
-android_gpu_usage_destroy_timestamp_resources(AndroidVkGpuContext* ctx)
+vk_gpu_usage_destroy_timestamp_resources(VulkanGpuUsageContext* ctx)
 {
     if (!ctx || ctx->device == VK_NULL_HANDLE)
         return;
 
-    for (uint32_t i = 0; i < AndroidVkGpuContext::MAX_FRAMES; ++i) {
+    for (uint32_t i = 0; i < VulkanGpuUsageContext::MAX_FRAMES; ++i) {
         auto& fr = ctx->frames[i];
         if (ctx->disp.DestroyCommandPool && fr.cmd_pool != VK_NULL_HANDLE) {
             ctx->disp.DestroyCommandPool(ctx->device, fr.cmd_pool, nullptr);
@@ -798,7 +776,7 @@ android_gpu_usage_destroy_timestamp_resources(AndroidVkGpuContext* ctx)
         fr.query_used = 0;
         fr.has_queries = false;
         fr.valid_pairs_mask = 0;
-        fr.frame_serial = AndroidVkGpuContext::FrameResources::kInvalidSerial;
+        fr.frame_serial = VulkanGpuUsageContext::FrameResources::kInvalidSerial;
         fr.in_submit.store(0, std::memory_order_relaxed);
     }
 
@@ -810,7 +788,7 @@ android_gpu_usage_destroy_timestamp_resources(AndroidVkGpuContext* ctx)
 }
 
 static bool
-android_gpu_usage_init_timestamp_resources(AndroidVkGpuContext* ctx,
+vk_gpu_usage_init_timestamp_resources(VulkanGpuUsageContext* ctx,
                                            uint32_t queue_family_index)
 {
     if (!ctx || !ctx->ts_supported.load(std::memory_order_relaxed))
@@ -829,28 +807,28 @@ android_gpu_usage_init_timestamp_resources(AndroidVkGpuContext* ctx,
         return false;
 
     uint32_t qf_count = 0;
-    vkGetPhysicalDeviceQueueFamilyProperties(ctx->phys_dev, &qf_count, nullptr);
+    ctx->disp.GetPhysicalDeviceQueueFamilyProperties(ctx->phys_dev, &qf_count, nullptr);
     if (qf_count == 0) {
-        SPDLOG_WARN("Android GPU usage: queue family count == 0 -> disabling");
+        SPDLOG_WARN("Vulkan GPU usage: queue family count == 0 -> disabling");
         ctx->ts_supported.store(false, std::memory_order_relaxed);
         return false;
     }
     if (queue_family_index >= qf_count) {
-        SPDLOG_WARN("Android GPU usage: bad queue_family_index={} (qf_count={})", queue_family_index, qf_count);
+        SPDLOG_WARN("Vulkan GPU usage: bad queue_family_index={} (qf_count={})", queue_family_index, qf_count);
         ctx->ts_supported.store(false, std::memory_order_relaxed);
         return false;
     }
 
     std::vector<VkQueueFamilyProperties> qf(qf_count);
     uint32_t qf_count2 = qf_count;
-    vkGetPhysicalDeviceQueueFamilyProperties(ctx->phys_dev, &qf_count2, qf.data());
+    ctx->disp.GetPhysicalDeviceQueueFamilyProperties(ctx->phys_dev, &qf_count2, qf.data());
     if (qf_count2 == 0) {
-        SPDLOG_WARN("Android GPU usage: queue family count became 0 -> disabling");
+        SPDLOG_WARN("Vulkan GPU usage: queue family count became 0 -> disabling");
         ctx->ts_supported.store(false, std::memory_order_relaxed);
         return false;
     }
     if (queue_family_index >= qf_count2) {
-        SPDLOG_WARN("Android GPU usage: bad queue_family_index={} (qf_count2={})", queue_family_index, qf_count2);
+        SPDLOG_WARN("Vulkan GPU usage: bad queue_family_index={} (qf_count2={})", queue_family_index, qf_count2);
         ctx->ts_supported.store(false, std::memory_order_relaxed);
         return false;
     }
@@ -858,13 +836,13 @@ android_gpu_usage_init_timestamp_resources(AndroidVkGpuContext* ctx,
 
     const uint32_t vb = qf[queue_family_index].timestampValidBits;
     if (vb == 0) {
-        SPDLOG_WARN("Android GPU usage: queue family {} has timestampValidBits=0 -> disabling", queue_family_index);
+        SPDLOG_WARN("Vulkan GPU usage: queue family {} has timestampValidBits=0 -> disabling", queue_family_index);
         ctx->ts_supported.store(false, std::memory_order_relaxed);
         return false;
     }
 
     if ((qf[queue_family_index].queueFlags & VK_QUEUE_GRAPHICS_BIT) == 0) {
-        SPDLOG_DEBUG("Android GPU usage: queue family {} is not GRAPHICS -> skip init", queue_family_index);
+        SPDLOG_DEBUG("Vulkan GPU usage: queue family {} is not GRAPHICS -> skip init", queue_family_index);
         ctx->last_init_reject_qf = queue_family_index;
         return false;
     }
@@ -874,7 +852,7 @@ android_gpu_usage_init_timestamp_resources(AndroidVkGpuContext* ctx,
     
     if (!ctx->disp.CreateCommandPool || !ctx->disp.ResetCommandPool) {
         SPDLOG_WARN(
-            "Android GPU usage: Create/ResetCommandPool not available → disabling timestamp backend"
+            "Vulkan GPU usage: Create/ResetCommandPool not available → disabling timestamp backend"
         );
         ctx->ts_supported.store(false, std::memory_order_relaxed);
         return false;
@@ -883,15 +861,15 @@ android_gpu_usage_init_timestamp_resources(AndroidVkGpuContext* ctx,
     VkQueryPoolCreateInfo qp{};
     qp.sType              = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
     qp.queryType          = VK_QUERY_TYPE_TIMESTAMP;
-    qp.queryCount         = AndroidVkGpuContext::MAX_FRAMES *
-                            AndroidVkGpuContext::MAX_QUERIES_PER_FRAME;
+    qp.queryCount         = VulkanGpuUsageContext::MAX_FRAMES *
+                            VulkanGpuUsageContext::MAX_QUERIES_PER_FRAME;
     qp.flags              = 0;
     qp.pipelineStatistics = 0;
 
     if (!ctx->disp.CreateQueryPool ||
         ctx->disp.CreateQueryPool(ctx->device, &qp, nullptr, &ctx->query_pool) != VK_SUCCESS) {
         SPDLOG_WARN(
-            "Android GPU usage: CreateQueryPool failed (qcount={}) → disabling timestamp backend",
+            "Vulkan GPU usage: CreateQueryPool failed (qcount={}) → disabling timestamp backend",
             qp.queryCount
         );
         ctx->query_pool   = VK_NULL_HANDLE;
@@ -899,7 +877,7 @@ android_gpu_usage_init_timestamp_resources(AndroidVkGpuContext* ctx,
         return false;
     }
 
-    for (uint32_t i = 0; i < AndroidVkGpuContext::MAX_FRAMES; ++i) {
+    for (uint32_t i = 0; i < VulkanGpuUsageContext::MAX_FRAMES; ++i) {
         VkCommandPoolCreateInfo cp{};
         cp.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
         cp.queueFamilyIndex = queue_family_index;
@@ -909,26 +887,26 @@ android_gpu_usage_init_timestamp_resources(AndroidVkGpuContext* ctx,
         VkCommandPool pool = VK_NULL_HANDLE;
         if (ctx->disp.CreateCommandPool(ctx->device, &cp, nullptr, &pool) != VK_SUCCESS) {
             SPDLOG_WARN(
-                "Android GPU usage: CreateCommandPool failed at slot {} → disabling timestamp backend",
+                "Vulkan GPU usage: CreateCommandPool failed at slot {} → disabling timestamp backend",
                 i
             );
-            android_gpu_usage_destroy_timestamp_resources(ctx);
+            vk_gpu_usage_destroy_timestamp_resources(ctx);
             ctx->ts_supported.store(false, std::memory_order_relaxed);
             return false;
         }
 
         auto& fr          = ctx->frames[i];
         fr.cmd_pool       = pool;
-        fr.query_start    = i * AndroidVkGpuContext::MAX_QUERIES_PER_FRAME;
-        fr.query_capacity = AndroidVkGpuContext::MAX_QUERIES_PER_FRAME;
+        fr.query_start    = i * VulkanGpuUsageContext::MAX_QUERIES_PER_FRAME;
+        fr.query_capacity = VulkanGpuUsageContext::MAX_QUERIES_PER_FRAME;
         fr.query_used     = 0;
         fr.has_queries    = false;
-        fr.frame_serial   = AndroidVkGpuContext::FrameResources::kInvalidSerial;
+        fr.frame_serial   = VulkanGpuUsageContext::FrameResources::kInvalidSerial;
         fr.timestamp_cmds.clear();
 
         if (!ctx->disp.AllocateCommandBuffers) {
-            SPDLOG_WARN("Android GPU usage: AllocateCommandBuffers missing -> disable backend");
-            android_gpu_usage_destroy_timestamp_resources(ctx);
+            SPDLOG_WARN("Vulkan GPU usage: AllocateCommandBuffers missing -> disable backend");
+            vk_gpu_usage_destroy_timestamp_resources(ctx);
             ctx->ts_supported.store(false, std::memory_order_relaxed);
             return false;
         }
@@ -941,8 +919,8 @@ android_gpu_usage_init_timestamp_resources(AndroidVkGpuContext* ctx,
         ai.commandBufferCount = static_cast<uint32_t>(tmp.size());
 
         if (ctx->disp.AllocateCommandBuffers(ctx->device, &ai, tmp.data()) != VK_SUCCESS) {
-            SPDLOG_WARN("Android GPU usage: prealloc AllocateCommandBuffers failed at slot {} -> disable", i);
-            android_gpu_usage_destroy_timestamp_resources(ctx);
+            SPDLOG_WARN("Vulkan GPU usage: prealloc AllocateCommandBuffers failed at slot {} -> disable", i);
+            vk_gpu_usage_destroy_timestamp_resources(ctx);
             ctx->ts_supported.store(false, std::memory_order_relaxed);
             return false;
         }
@@ -954,18 +932,18 @@ android_gpu_usage_init_timestamp_resources(AndroidVkGpuContext* ctx,
     ctx->last_init_reject_qf = VK_QUEUE_FAMILY_IGNORED;
 
     SPDLOG_INFO(
-        "Android GPU usage: timestamp resources initialized (qf_index={} qpool={} slots={} qpf={})",
+        "Vulkan GPU usage: timestamp resources initialized (qf_index={} qpool={} slots={} qpf={})",
         queue_family_index,
         static_cast<void*>(ctx->query_pool),
-        AndroidVkGpuContext::MAX_FRAMES,
-        AndroidVkGpuContext::MAX_QUERIES_PER_FRAME
+        VulkanGpuUsageContext::MAX_FRAMES,
+        VulkanGpuUsageContext::MAX_QUERIES_PER_FRAME
     );
 
     return true;
 }
 
 static bool
-android_gpu_usage_begin_frame(AndroidVkGpuContext* ctx,
+vk_gpu_usage_begin_frame(VulkanGpuUsageContext* ctx,
                               uint32_t frame_idx,
                               uint64_t frame_serial)
 {
@@ -974,15 +952,15 @@ android_gpu_usage_begin_frame(AndroidVkGpuContext* ctx,
     if (fr.frame_serial == frame_serial)
         return true;
 
-    if (fr.has_queries && fr.frame_serial != AndroidVkGpuContext::FrameResources::kInvalidSerial) {
+    if (fr.has_queries && fr.frame_serial != VulkanGpuUsageContext::FrameResources::kInvalidSerial) {
         const uint64_t age = (frame_serial > fr.frame_serial)
             ? (frame_serial - fr.frame_serial)
             : std::numeric_limits<uint64_t>::max();
 
-        if (age < AndroidVkGpuContext::MAX_FRAMES)
+        if (age < VulkanGpuUsageContext::MAX_FRAMES)
             return false; // 아직 회수 전
 
-        android_gpu_usage_suspend_locked(ctx, "stale slot: queries not drained", kCooldownStaleSlot);
+        vk_gpu_usage_suspend_locked(ctx, "stale slot: queries not drained", kCooldownStaleSlot);
         return false;
     }
 
@@ -998,7 +976,7 @@ android_gpu_usage_begin_frame(AndroidVkGpuContext* ctx,
         !fr.timestamp_cmds.empty()) {
         VkResult rr = ctx->disp.ResetCommandPool(ctx->device, fr.cmd_pool, 0);
         if (rr != VK_SUCCESS) {
-            android_gpu_usage_suspend_locked(ctx, "ResetCommandPool failed", kCooldownRecordFail);
+            vk_gpu_usage_suspend_locked(ctx, "ResetCommandPool failed", kCooldownRecordFail);
             return false;
         }
     }
@@ -1006,33 +984,37 @@ android_gpu_usage_begin_frame(AndroidVkGpuContext* ctx,
     return true;
 }
 
-enum class AndroidGpuReadStatus : uint8_t {
+enum class VulkanGpuUsageReadStatus : uint8_t {
     Ready,
     NotReady,
     Error,
     DeviceLost
 };
 
-static AndroidGpuReadStatus
-android_gpu_usage_query_range_gpu_ms(AndroidVkGpuContext* ctx,
+static VulkanGpuUsageReadStatus
+vk_gpu_usage_query_range_gpu_ms(VulkanGpuUsageContext* ctx,
                                      uint32_t query_start,
                                      uint32_t query_count,
                                      uint64_t valid_pairs_mask,
-                                     float* out_gpu_ms)
+                                     float* out_gpu_ms,
+                                     uint64_t* out_end_tick)
 {
+    if (out_end_tick)
+        *out_end_tick = 0;
+
     if (!ctx || !out_gpu_ms ||
         !ctx->ts_supported.load(std::memory_order_relaxed) ||
         ctx->query_pool == VK_NULL_HANDLE ||
         !ctx->disp.GetQueryPoolResults)
-        return AndroidGpuReadStatus::Error;
+        return VulkanGpuUsageReadStatus::Error;
 
     if (query_count < 2 || (query_count & 1u))
-        return AndroidGpuReadStatus::Error;
+        return VulkanGpuUsageReadStatus::Error;
 
-    if (query_count > AndroidVkGpuContext::MAX_QUERIES_PER_FRAME)
-        return AndroidGpuReadStatus::Error;
+    if (query_count > VulkanGpuUsageContext::MAX_QUERIES_PER_FRAME)
+        return VulkanGpuUsageReadStatus::Error;
 
-    thread_local std::array<uint64_t, AndroidVkGpuContext::MAX_QUERIES_PER_FRAME * 2u> scratch{};
+    thread_local std::array<uint64_t, VulkanGpuUsageContext::MAX_QUERIES_PER_FRAME * 2u> scratch{};
     const uint32_t needed_u64 = query_count * 2u;
 
     VkResult r = ctx->disp.GetQueryPoolResults(
@@ -1048,11 +1030,11 @@ android_gpu_usage_query_range_gpu_ms(AndroidVkGpuContext* ctx,
     );
 
     if (r == VK_ERROR_DEVICE_LOST)
-        return AndroidGpuReadStatus::DeviceLost;
+        return VulkanGpuUsageReadStatus::DeviceLost;
     if (r == VK_NOT_READY)
-        return AndroidGpuReadStatus::NotReady;
+        return VulkanGpuUsageReadStatus::NotReady;
     if (r < 0)
-        return AndroidGpuReadStatus::Error;
+        return VulkanGpuUsageReadStatus::Error;
 
     const uint32_t pair_count = query_count / 2u;
 
@@ -1064,7 +1046,7 @@ android_gpu_usage_query_range_gpu_ms(AndroidVkGpuContext* ctx,
         const uint64_t as = scratch[qs * 2u + 1u];
         const uint64_t ae = scratch[qe * 2u + 1u];
         if (!as || !ae)
-            return AndroidGpuReadStatus::NotReady;
+            return VulkanGpuUsageReadStatus::NotReady;
     }
 
     // ------------------ busy_ms = union of [start,end] intervals (wrap-safe) ------------------
@@ -1105,7 +1087,7 @@ android_gpu_usage_query_range_gpu_ms(AndroidVkGpuContext* ctx,
 
     if (seg_n == 0) {
         *out_gpu_ms = 0.0f;
-        return AndroidGpuReadStatus::Ready;
+        return VulkanGpuUsageReadStatus::Ready;
     }
 
     struct Interval { uint64_t s; uint64_t e; };
@@ -1159,7 +1141,7 @@ android_gpu_usage_query_range_gpu_ms(AndroidVkGpuContext* ctx,
 
     if (iv_n == 0) {
         *out_gpu_ms = 0.0f;
-        return AndroidGpuReadStatus::Ready;
+        return VulkanGpuUsageReadStatus::Ready;
     }
 
     std::sort(iv.begin(), iv.begin() + iv_n,
@@ -1208,31 +1190,86 @@ android_gpu_usage_query_range_gpu_ms(AndroidVkGpuContext* ctx,
     }
 
     if (!std::isfinite(busy_ms) || busy_ms < 0.0)
-        return AndroidGpuReadStatus::Error;
+        return VulkanGpuUsageReadStatus::Error;
 
     *out_gpu_ms = (float)busy_ms; // 0도 허용
-    return AndroidGpuReadStatus::Ready;
+    if (out_end_tick)
+        *out_end_tick = max_end_u & mask;
+    return VulkanGpuUsageReadStatus::Ready;
+}
+
+// LOCK: ctx->metrics_mtx held
+static void
+vk_gpu_usage_calibrate_locked(VulkanGpuUsageContext* ctx,
+                              std::chrono::steady_clock::time_point now)
+{
+    if (!ctx->can_calibrate)
+        return;
+    if (ctx->last_calibration.time_since_epoch().count() != 0 &&
+        (now - ctx->last_calibration) < kCalibrateEvery)
+        return;
+    ctx->last_calibration = now;
+
+    VkCalibratedTimestampInfoEXT infos[2] = {};
+    infos[0].sType      = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+    infos[0].timeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+    infos[1].sType      = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+    infos[1].timeDomain = VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT;
+
+    uint64_t ts[2] = {};
+    uint64_t max_deviation = 0;
+    VkResult r = ctx->disp.GetCalibratedTimestamps(ctx->device, 2, infos, ts, &max_deviation);
+    if (r != VK_SUCCESS) {
+        SPDLOG_WARN("Vulkan GPU usage: GetCalibratedTimestamps -> {}, frame end times disabled", (int)r);
+        ctx->can_calibrate = false;
+        ctx->have_calibration = false;
+        return;
+    }
+
+    ctx->cal_gpu_ticks    = ts[0] & ctx->ts_mask;
+    ctx->cal_cpu_ns       = ts[1];
+    ctx->have_calibration = true;
+}
+
+// LOCK: ctx->metrics_mtx held. tick 은 ts_mask 적용된 값, 보정점 기준 앞뒤 반 주기까지 허용
+static uint64_t
+vk_gpu_usage_tick_to_cpu_ns_locked(const VulkanGpuUsageContext* ctx, uint64_t tick)
+{
+    if (!ctx->have_calibration)
+        return 0;
+
+    const uint64_t mask  = ctx->ts_mask;
+    const uint64_t ahead = (tick - ctx->cal_gpu_ticks) & mask;
+    int64_t delta_ns = 0;
+    if (ahead <= (mask >> 1))
+        delta_ns = (int64_t)(double(ahead) * double(ctx->ts_period_ns));
+    else
+        delta_ns = -(int64_t)(double((ctx->cal_gpu_ticks - tick) & mask) * double(ctx->ts_period_ns));
+
+    if (delta_ns < 0 && uint64_t(-delta_ns) > ctx->cal_cpu_ns)
+        return 0;
+    return ctx->cal_cpu_ns + delta_ns;
 }
 
 static inline void
-android_gpu_usage_consume_slot(AndroidVkGpuContext::FrameResources& fr)
+vk_gpu_usage_consume_slot(VulkanGpuUsageContext::FrameResources& fr)
 {
     fr.has_queries      = false;
     fr.valid_pairs_mask = 0;
     fr.query_used       = 0;
-    fr.frame_serial     = AndroidVkGpuContext::FrameResources::kInvalidSerial;
+    fr.frame_serial     = VulkanGpuUsageContext::FrameResources::kInvalidSerial;
 }
 
 // ====================== 외부 API ======================
 
-AndroidVkGpuContext*
-android_gpu_usage_create(VkPhysicalDevice            phys_dev,
+VulkanGpuUsageContext*
+vk_gpu_usage_create(VkPhysicalDevice            phys_dev,
                          VkDevice                    device,
                          float                       timestamp_period_ns,
                          uint32_t                    timestamp_valid_bits,
-                         const AndroidVkGpuDispatch& disp)
+                         const VulkanGpuUsageDispatch& disp)
 {
-    auto ctx = new AndroidVkGpuContext{};
+    auto ctx = new VulkanGpuUsageContext{};
     ctx->phys_dev      = phys_dev;
     ctx->device        = device;
     ctx->disp          = disp;
@@ -1241,16 +1278,7 @@ android_gpu_usage_create(VkPhysicalDevice            phys_dev,
 
     if (!ctx->disp.QueueSubmit2 && ctx->disp.QueueSubmit2KHR)
         ctx->disp.QueueSubmit2 = ctx->disp.QueueSubmit2KHR; // normalize once
-    
-    ctx->env_enabled = android_gpu_usage_env_enabled();
-    if (!ctx->env_enabled) {
-        ctx->ts_supported.store(false, std::memory_order_relaxed);
-        ctx->mode.store(BackendMode::Disabled, std::memory_order_relaxed);
-        SPDLOG_INFO(
-            "Android GPU usage: backend disabled (MANGOHUD_VKP!=1), context will be no-op"
-        );
-        return ctx;
-    }
+    ctx->can_calibrate = ctx->disp.GetCalibratedTimestamps != nullptr;
 
     if (ctx->ts_valid_bits == 0 || ctx->ts_valid_bits >= 64) {
         ctx->ts_mask = ~0ULL;
@@ -1277,7 +1305,8 @@ android_gpu_usage_create(VkPhysicalDevice            phys_dev,
         ctx->disp.BeginCommandBuffer &&
         ctx->disp.EndCommandBuffer &&
         ctx->disp.CmdWriteTimestamp &&
-        ctx->disp.CmdResetQueryPool;
+        ctx->disp.CmdResetQueryPool &&
+        ctx->disp.GetPhysicalDeviceQueueFamilyProperties;
 
     ctx->ts_supported.store(dispatch_ok && (ctx->ts_period_ns > 0.0f),
                             std::memory_order_relaxed);
@@ -1285,22 +1314,23 @@ android_gpu_usage_create(VkPhysicalDevice            phys_dev,
         ctx->mode.store(BackendMode::Disabled, std::memory_order_relaxed);
     
     SPDLOG_INFO(
-        "Android GPU usage: create ctx={} ts_period_ns={} ts_valid_bits={} dispatch_ok={} ts_supported={}",
+        "Vulkan GPU usage: create ctx={} ts_period_ns={} ts_valid_bits={} dispatch_ok={} ts_supported={} calibrated={}",
         static_cast<void*>(ctx),
         ctx->ts_period_ns,
         ctx->ts_valid_bits,
         dispatch_ok,
-        ctx->ts_supported.load(std::memory_order_relaxed)
+        ctx->ts_supported.load(std::memory_order_relaxed),
+        ctx->can_calibrate
     );
 
     if (!ctx->ts_supported.load(std::memory_order_relaxed)) {
-        SPDLOG_WARN("Android GPU usage: Vulkan timestamps not supported, backend will be disabled");
+        SPDLOG_WARN("Vulkan GPU usage: Vulkan timestamps not supported, backend will be disabled");
     }
     return ctx;
 }
 
 void
-android_gpu_usage_destroy(AndroidVkGpuContext* ctx)
+vk_gpu_usage_destroy(VulkanGpuUsageContext* ctx)
 {
     if (!ctx)
         return;
@@ -1312,7 +1342,7 @@ android_gpu_usage_destroy(AndroidVkGpuContext* ctx)
         ctx->cv.wait(lk, [&] { return ctx->in_flight.load(std::memory_order_acquire) == 0; });
     }
 
-    android_gpu_usage_wait_idle_best_effort(ctx);
+    vk_gpu_usage_wait_idle_best_effort(ctx);
     
     {
         std::lock_guard<std::mutex> g(ctx->lock);
@@ -1320,22 +1350,22 @@ android_gpu_usage_destroy(AndroidVkGpuContext* ctx)
         ctx->ts_supported.store(false, std::memory_order_relaxed);
     }
     { std::lock_guard<std::mutex> mg(ctx->metrics_mtx); ctx->have_metrics = false; }
-    android_gpu_usage_destroy_timestamp_resources(ctx);
-    SPDLOG_INFO("Android GPU usage: destroy -> Vulkan resources destroyed");
+    vk_gpu_usage_destroy_timestamp_resources(ctx);
+    SPDLOG_INFO("Vulkan GPU usage: destroy -> Vulkan resources destroyed");
 
     delete ctx;
 }
 
 template <typename SubmitT>
 static inline bool
-android_gpu_usage_can_wrap_submit(AndroidVkGpuContext* ctx,
+vk_gpu_usage_can_wrap_submit(VulkanGpuUsageContext* ctx,
                                   uint32_t submitCount,
                                   const SubmitT* pSubmits) noexcept
 {
     if (!ctx || !pSubmits || submitCount == 0) return false;
     if (ctx->destroying.load(std::memory_order_acquire)) return false;
     if (!ctx->ts_supported.load(std::memory_order_relaxed)) return false;
-    if (!android_gpu_usage_should_sample(ctx)) return false;
+    if (!vk_gpu_usage_should_sample(ctx)) return false;
     if (submitCount > kSubmitCountHardCap) return false;
     return true;
 }
@@ -1343,7 +1373,7 @@ android_gpu_usage_can_wrap_submit(AndroidVkGpuContext* ctx,
 // ====================== QueueSubmit(v1) 래핑 ======================
 
 VkResult
-android_gpu_usage_queue_submit(AndroidVkGpuContext* ctx,
+vk_gpu_usage_queue_submit(VulkanGpuUsageContext* ctx,
                                VkQueue              queue,
                                uint32_t             queue_family_index,
                                uint32_t             submitCount,
@@ -1351,7 +1381,7 @@ android_gpu_usage_queue_submit(AndroidVkGpuContext* ctx,
                                VkFence              fence)
 {
     if (!ctx) return VK_ERROR_INITIALIZATION_FAILED;
-    AndroidGpuApiGuard guard(ctx);
+    VulkanGpuUsageApiGuard guard(ctx);
 
     if (!ctx->disp.QueueSubmit)
         return VK_ERROR_INITIALIZATION_FAILED;
@@ -1360,14 +1390,14 @@ android_gpu_usage_queue_submit(AndroidVkGpuContext* ctx,
     if (!pSubmits)
         return VK_ERROR_INITIALIZATION_FAILED; // avoid crashing driver with nullptr+count>0
 
-    if (!android_gpu_usage_can_wrap_submit(ctx, submitCount, pSubmits))
+    if (!vk_gpu_usage_can_wrap_submit(ctx, submitCount, pSubmits))
         return ctx->disp.QueueSubmit(queue, submitCount, pSubmits, fence);
 
     auto submit_fn = [&](uint32_t n, const VkSubmitInfo* s, VkFence f) -> VkResult {
         return ctx->disp.QueueSubmit(queue, n, s, f);
     };
 
-    return android_gpu_usage_queue_submit_impl(ctx,
+    return vk_gpu_usage_queue_submit_impl(ctx,
                                                queue_family_index,
                                                submitCount, pSubmits,
                                                fence,
@@ -1378,7 +1408,7 @@ android_gpu_usage_queue_submit(AndroidVkGpuContext* ctx,
 // ====================== QueueSubmit2(v2) 래핑 ======================
 
 VkResult
-android_gpu_usage_queue_submit2(AndroidVkGpuContext* ctx,
+vk_gpu_usage_queue_submit2(VulkanGpuUsageContext* ctx,
                                 VkQueue              queue,
                                 uint32_t             queue_family_index,
                                 uint32_t             submitCount,
@@ -1386,7 +1416,7 @@ android_gpu_usage_queue_submit2(AndroidVkGpuContext* ctx,
                                 VkFence              fence)
 {
     if (!ctx) return VK_ERROR_INITIALIZATION_FAILED;
-    AndroidGpuApiGuard guard(ctx);
+    VulkanGpuUsageApiGuard guard(ctx);
 
     PFN_vkQueueSubmit2 fpSubmit2 = ctx->disp.QueueSubmit2;
     if (!fpSubmit2)
@@ -1396,14 +1426,14 @@ android_gpu_usage_queue_submit2(AndroidVkGpuContext* ctx,
     if (!pSubmits)
         return VK_ERROR_INITIALIZATION_FAILED; // avoid crashing driver
 
-    if (!android_gpu_usage_can_wrap_submit(ctx, submitCount, pSubmits))
+    if (!vk_gpu_usage_can_wrap_submit(ctx, submitCount, pSubmits))
         return fpSubmit2(queue, submitCount, pSubmits, fence);
 
     auto submit_fn = [&](uint32_t n, const VkSubmitInfo2* s, VkFence f) -> VkResult {
         return fpSubmit2(queue, n, s, f);
     };
 
-    return android_gpu_usage_queue_submit_impl(ctx,
+    return vk_gpu_usage_queue_submit_impl(ctx,
                                                queue_family_index,
                                                submitCount, pSubmits,
                                                fence,
@@ -1413,7 +1443,7 @@ android_gpu_usage_queue_submit2(AndroidVkGpuContext* ctx,
 
 // ====================== Present 시점 처리 ======================
 void
-android_gpu_usage_on_present(AndroidVkGpuContext*    ctx,
+vk_gpu_usage_on_present(VulkanGpuUsageContext*    ctx,
                              VkQueue                 queue,
                              uint32_t                queue_family_index,
                              const VkPresentInfoKHR* present_info,
@@ -1429,10 +1459,8 @@ android_gpu_usage_on_present(AndroidVkGpuContext*    ctx,
     if (!ctx)
         return;
 
-    AndroidGpuApiGuard guard(ctx);
+    VulkanGpuUsageApiGuard guard(ctx);
 
-    if (!ctx->env_enabled)
-        return;
     if (ctx->mode.load(std::memory_order_relaxed) == BackendMode::Disabled)
         return;
     if (ctx->destroying.load(std::memory_order_acquire))
@@ -1466,7 +1494,7 @@ android_gpu_usage_on_present(AndroidVkGpuContext*    ctx,
         }
         ctx->last_present = now;
 
-        auto& cs = ctx->cpu_ring[cur_serial & (AndroidVkGpuContext::CPU_RING - 1u)];
+        auto& cs = ctx->cpu_ring[cur_serial & (VulkanGpuUsageContext::CPU_RING - 1u)];
         cs.serial = cur_serial;
         cs.ms     = frame_ms;
     }
@@ -1487,7 +1515,7 @@ android_gpu_usage_on_present(AndroidVkGpuContext*    ctx,
             if (mode == BackendMode::Suspended) {
                 if (now >= ctx->suspend_until) {
                     bool any_pending = false;
-                    for (uint32_t i = 0; i < AndroidVkGpuContext::MAX_FRAMES; ++i) {
+                    for (uint32_t i = 0; i < VulkanGpuUsageContext::MAX_FRAMES; ++i) {
                         const auto& fr = ctx->frames[i];
                         if (fr.has_queries &&
                             fr.valid_pairs_mask != 0 &&
@@ -1501,7 +1529,7 @@ android_gpu_usage_on_present(AndroidVkGpuContext*    ctx,
                         ctx->mode.store(BackendMode::Active, std::memory_order_relaxed);
                         ctx->notready_streak = 0;
                         ctx->notready_since = {};
-                        SPDLOG_INFO("Android GPU usage: RESUME -> cooldown passed and no pending queries");
+                        SPDLOG_INFO("Vulkan GPU usage: RESUME -> cooldown passed and no pending queries");
                         mode = BackendMode::Active;
                     } else {
                         if (ctx->last_probe.time_since_epoch().count() == 0 ||
@@ -1515,12 +1543,12 @@ android_gpu_usage_on_present(AndroidVkGpuContext*    ctx,
             if (ctx->ts_supported.load(std::memory_order_relaxed) && ctx->query_pool != VK_NULL_HANDLE) {
                 if (mode == BackendMode::Active) {
                     const uint64_t fi = ctx->frame_index.load(std::memory_order_relaxed);
-                    if (ctx->read_serial + AndroidVkGpuContext::FRAME_LAG <= fi) {
-                        for (uint32_t step = 0; step < AndroidVkGpuContext::MAX_FRAMES; ++step) {
+                    if (ctx->read_serial + VulkanGpuUsageContext::FRAME_LAG <= fi) {
+                        for (uint32_t step = 0; step < VulkanGpuUsageContext::MAX_FRAMES; ++step) {
                             const uint64_t serial = ctx->read_serial;
-                            if (serial + AndroidVkGpuContext::FRAME_LAG > fi) break;
+                            if (serial + VulkanGpuUsageContext::FRAME_LAG > fi) break;
             
-                            const uint32_t idx = static_cast<uint32_t>(serial % AndroidVkGpuContext::MAX_FRAMES);
+                            const uint32_t idx = static_cast<uint32_t>(serial % VulkanGpuUsageContext::MAX_FRAMES);
                             auto& fr = ctx->frames[idx];
 
                             if (fr.in_submit.load(std::memory_order_acquire) != 0) {
@@ -1544,7 +1572,7 @@ android_gpu_usage_on_present(AndroidVkGpuContext*    ctx,
                 } else if (probe) {
                     uint32_t best_idx = 0;
                     uint64_t best_serial = std::numeric_limits<uint64_t>::max();
-                    for (uint32_t i = 0; i < AndroidVkGpuContext::MAX_FRAMES; ++i) {
+                    for (uint32_t i = 0; i < VulkanGpuUsageContext::MAX_FRAMES; ++i) {
                         auto& fr = ctx->frames[i];
                         if (fr.in_submit.load(std::memory_order_acquire) != 0)
                             continue;
@@ -1567,22 +1595,24 @@ android_gpu_usage_on_present(AndroidVkGpuContext*    ctx,
                     } else {
                         ctx->mode.store(BackendMode::Active, std::memory_order_relaxed);
                         ctx->notready_streak = 0;
-                        SPDLOG_INFO("Android GPU usage: RESUME -> no pending queries left");
+                        SPDLOG_INFO("Vulkan GPU usage: RESUME -> no pending queries left");
                     }
                 }
             }
         }
         if (read.have) {
             std::lock_guard<std::mutex> mg(ctx->metrics_mtx);
-            const auto& cs2 = ctx->cpu_ring[read.serial & (AndroidVkGpuContext::CPU_RING - 1u)];
+            const auto& cs2 = ctx->cpu_ring[read.serial & (VulkanGpuUsageContext::CPU_RING - 1u)];
             read.frame_ms = (cs2.serial == read.serial) ? cs2.ms : 0.0f;
         }
         float frame_gpu_ms = 0.0f;
-        AndroidGpuReadStatus st = AndroidGpuReadStatus::NotReady;
+        uint64_t frame_end_tick = 0;
+        VulkanGpuUsageReadStatus st = VulkanGpuUsageReadStatus::NotReady;
         const bool attempted_read = read.have;
 
         if (read.have) {
-            st = android_gpu_usage_query_range_gpu_ms(ctx, read.q_start, read.q_count, read.valid_mask, &frame_gpu_ms);
+            st = vk_gpu_usage_query_range_gpu_ms(ctx, read.q_start, read.q_count, read.valid_mask,
+                                                 &frame_gpu_ms, &frame_end_tick);
         }
 
         // --------- (C) state lock: 슬롯 소비/서스펜드/리드시리얼/프레임인덱스 ---------
@@ -1593,16 +1623,16 @@ android_gpu_usage_on_present(AndroidVkGpuContext*    ctx,
                 bump_frame_index();
                 return;
             }
-            if (st == AndroidGpuReadStatus::DeviceLost) {
+            if (st == VulkanGpuUsageReadStatus::DeviceLost) {
                 ctx->ts_supported.store(false, std::memory_order_relaxed);
                 ctx->mode.store(BackendMode::Disabled, std::memory_order_relaxed);
-                SPDLOG_WARN("Android GPU usage: DEVICE_LOST on GetQueryPoolResults -> disable backend (no destroy)");
+                SPDLOG_WARN("Vulkan GPU usage: DEVICE_LOST on GetQueryPoolResults -> disable backend (no destroy)");
                 frame_gpu_ms = 0.0f;
             }
-            else if (st == AndroidGpuReadStatus::Ready) {
+            else if (st == VulkanGpuUsageReadStatus::Ready) {
                 auto& fr = ctx->frames[read.slot_idx];
                 if (fr.frame_serial == read.serial && fr.has_queries && fr.query_used == read.q_count) {
-                    android_gpu_usage_consume_slot(fr);
+                    vk_gpu_usage_consume_slot(fr);
             
                     if (ctx->mode.load(std::memory_order_relaxed) == BackendMode::Active) {
                         ctx->read_serial = read.serial + 1;
@@ -1615,13 +1645,13 @@ android_gpu_usage_on_present(AndroidVkGpuContext*    ctx,
             
                     if (ctx->mode.load(std::memory_order_relaxed) == BackendMode::Suspended) {
                         bool any_pending = false;
-                        for (uint32_t i = 0; i < AndroidVkGpuContext::MAX_FRAMES; ++i) {
+                        for (uint32_t i = 0; i < VulkanGpuUsageContext::MAX_FRAMES; ++i) {
                             if (ctx->frames[i].has_queries) { any_pending = true; break; }
                         }
                         if (!any_pending && now >= ctx->suspend_until) {
                             ctx->mode.store(BackendMode::Active, std::memory_order_relaxed);
                             ctx->notready_streak = 0;
-                            SPDLOG_INFO("Android GPU usage: RESUME -> drained pending queries");
+                            SPDLOG_INFO("Vulkan GPU usage: RESUME -> drained pending queries");
                         }
                     }
                 } else {
@@ -1629,10 +1659,10 @@ android_gpu_usage_on_present(AndroidVkGpuContext*    ctx,
                     return;
                 }
             }
-            else if (st == AndroidGpuReadStatus::Error) {
+            else if (st == VulkanGpuUsageReadStatus::Error) {
                 ctx->ts_supported.store(false, std::memory_order_relaxed);
                 ctx->mode.store(BackendMode::Disabled, std::memory_order_relaxed);
-                SPDLOG_WARN("Android GPU usage: GetQueryPoolResults ERROR -> disable backend (keep last metrics)");
+                SPDLOG_WARN("Vulkan GPU usage: GetQueryPoolResults ERROR -> disable backend (keep last metrics)");
                 frame_gpu_ms = 0.0f;
             }
             else { // NotReady
@@ -1647,7 +1677,7 @@ android_gpu_usage_on_present(AndroidVkGpuContext*    ctx,
                     ((now - ctx->notready_since) >= kNotReadyMaxTime);
 
                 if (too_many_frames || too_much_time) {
-                    android_gpu_usage_suspend_locked(ctx,
+                    vk_gpu_usage_suspend_locked(ctx,
                         "GetQueryPoolResults NOT_READY too long",
                         kCooldownNotReadyLong);
                     ctx->notready_streak = 0;
@@ -1665,7 +1695,11 @@ android_gpu_usage_on_present(AndroidVkGpuContext*    ctx,
                 ctx->window_start = now;
             }
 
-            if (st == AndroidGpuReadStatus::Ready && read.frame_ms > 0.0f) {
+            vk_gpu_usage_calibrate_locked(ctx, now);
+            if (st == VulkanGpuUsageReadStatus::Ready && frame_end_tick != 0)
+                ctx->last_end_ns = vk_gpu_usage_tick_to_cpu_ns_locked(ctx, frame_end_tick);
+
+            if (st == VulkanGpuUsageReadStatus::Ready && read.frame_ms > 0.0f) {
                 ctx->acc_frame_ms_sampled += read.frame_ms;
                 ctx->acc_frames_sampled += 1;
                 ctx->acc_gpu_ms         += frame_gpu_ms;
@@ -1704,26 +1738,24 @@ android_gpu_usage_on_present(AndroidVkGpuContext*    ctx,
             }
         }        
     } catch (const std::exception& e) {
-        SPDLOG_WARN("Android GPU usage: on_present exception: {}", e.what());
+        SPDLOG_WARN("Vulkan GPU usage: on_present exception: {}", e.what());
     } catch (...) {
-        SPDLOG_WARN("Android GPU usage: on_present unknown exception");
+        SPDLOG_WARN("Vulkan GPU usage: on_present unknown exception");
     }
     if (!frame_index_bumped)
         bump_frame_index();
 }
 
 bool
-android_gpu_usage_get_metrics(AndroidVkGpuContext* ctx,
+vk_gpu_usage_get_metrics(VulkanGpuUsageContext* ctx,
                               float*              out_gpu_ms,
-                              float*              out_usage)
+                              float*              out_usage,
+                              uint64_t*           out_end_ns)
 {
     if (!ctx)
         return false;
 
-    AndroidGpuApiGuard guard(ctx);
-
-    if (!ctx->env_enabled)
-        return false;
+    VulkanGpuUsageApiGuard guard(ctx);
 
     if (ctx->destroying.load(std::memory_order_acquire))
         return false;
@@ -1737,6 +1769,8 @@ android_gpu_usage_get_metrics(AndroidVkGpuContext* ctx,
         *out_gpu_ms = ctx->last_gpu_ms;
     if (out_usage)
         *out_usage  = ctx->last_usage;
+    if (out_end_ns)
+        *out_end_ns = ctx->last_end_ns;
 
     return true;
 }
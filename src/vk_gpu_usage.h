@@ -83,7 +83,7 @@ typedef PFN_vkQueueSubmit2 PFN_vkQueueSubmit2KHR;
 
 #endif // submit2 없는 구형 헤더
 
-struct AndroidVkGpuDispatch {
+struct VulkanGpuUsageDispatch {
     // 큐/쿼리 관련
     PFN_vkQueueSubmit             QueueSubmit;
     PFN_vkQueueSubmit2            QueueSubmit2;
@@ -103,23 +103,27 @@ struct AndroidVkGpuDispatch {
     // 타임스탬프 / 쿼리
     PFN_vkCmdWriteTimestamp       CmdWriteTimestamp;
     PFN_vkCmdResetQueryPool       CmdResetQueryPool;
+
+    PFN_vkGetPhysicalDeviceQueueFamilyProperties GetPhysicalDeviceQueueFamilyProperties;
+    // VK_EXT_calibrated_timestamps, nullptr 이면 CPU 시간 보정 없이 동작
+    PFN_vkGetCalibratedTimestampsEXT             GetCalibratedTimestamps;
 };
 
-struct AndroidVkGpuContext;
+struct VulkanGpuUsageContext;
 
 // 컨텍스트 생성 / 파괴
-AndroidVkGpuContext* android_gpu_usage_create(
+VulkanGpuUsageContext* vk_gpu_usage_create(
     VkPhysicalDevice              phys_dev,
     VkDevice                      device,
     float                         timestamp_period_ns,
     uint32_t                      timestamp_valid_bits,
-    const AndroidVkGpuDispatch&   disp);
+    const VulkanGpuUsageDispatch&   disp);
 
-void android_gpu_usage_destroy(AndroidVkGpuContext* ctx);
+void vk_gpu_usage_destroy(VulkanGpuUsageContext* ctx);
 
 // vkQueueSubmit 훅에서 호출
-VkResult android_gpu_usage_queue_submit(
-    AndroidVkGpuContext*          ctx,
+VkResult vk_gpu_usage_queue_submit(
+    VulkanGpuUsageContext*          ctx,
     VkQueue                       queue,
     uint32_t                      queue_family_index,
     uint32_t                      submitCount,
@@ -127,8 +131,8 @@ VkResult android_gpu_usage_queue_submit(
     VkFence                       fence);
 
 // vkQueueSubmit2 / vkQueueSubmit2KHR 훅에서 호출
-VkResult android_gpu_usage_queue_submit2(
-    AndroidVkGpuContext*          ctx,
+VkResult vk_gpu_usage_queue_submit2(
+    VulkanGpuUsageContext*          ctx,
     VkQueue                       queue,
     uint32_t                      queue_family_index,
     uint32_t                      submitCount,
@@ -136,8 +140,8 @@ VkResult android_gpu_usage_queue_submit2(
     VkFence                       fence);
 
 // vkQueuePresentKHR에서 호출
-void android_gpu_usage_on_present(
-    AndroidVkGpuContext*          ctx,
+void vk_gpu_usage_on_present(
+    VulkanGpuUsageContext*          ctx,
     VkQueue                       queue,
     uint32_t                      queue_family_index,
     const VkPresentInfoKHR*       present_info,
@@ -145,7 +149,10 @@ void android_gpu_usage_on_present(
     uint32_t                      image_index);
 
 // 최신 GPU time(ms), usage(%) 가져오기
-bool android_gpu_usage_get_metrics(
-    AndroidVkGpuContext*          ctx,
+// out_end_ns: 마지막으로 읽은 프레임의 GPU 작업 종료 시각(CLOCK_MONOTONIC ns),
+//             calibrated timestamps 가 없으면 0
+bool vk_gpu_usage_get_metrics(
+    VulkanGpuUsageContext*          ctx,
     float*                        out_gpu_ms,
-    float*                        out_usage);
+    float*                        out_usage,
+    uint64_t*                     out_end_ns = nullptr);
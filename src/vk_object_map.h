@@ -0,0 +1,308 @@
+#pragma once
+#ifndef MANGOHUD_VK_OBJECT_MAP_H
+#define MANGOHUD_VK_OBJECT_MAP_H
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/* Handle -> layer data map for the Vulkan layer.
+ *
+ * Every intercepted call looks its objects up, often from several submit
+ * threads at once, while objects are only created and destroyed now and
+ * then. Lookups never lock or write shared memory: open addressing with
+ * linear probing over atomic slots. Inserts and erases are serialized by
+ * a mutex.
+ *
+ * An erased slot keeps its key with a null value (tombstone) until the
+ * writer can turn it back to empty without cutting a probe chain, or a
+ * new key reuses it. Slots are only ever reused for keys that are not
+ * mapped, so a reader never sees the data of another live object.
+ *
+ * A full table is rebuilt into a new one, twice as large when more than
+ * half of it is live, the same size when tombstones filled it. Keys are
+ * never moved inside a table, a reader walking past could miss them.
+ *
+ * Readers may still be walking the old table, so it is retired rather
+ * than freed: every lookup publishes the epoch it started in, in a record
+ * of its own thread, and a table retired in an epoch no lookup still runs
+ * in is freed by the next insert or erase.
+ */
+class vk_object_map {
+public:
+   explicit vk_object_map(size_t capacity = 256)
+   {
+      size_t size = 16;
+      while (size < capacity)
+         size *= 2;
+      current.store(new table(size), std::memory_order_release);
+   }
+
+   vk_object_map(const vk_object_map&) = delete;
+   vk_object_map& operator=(const vk_object_map&) = delete;
+
+   // nullptr if `key` isn't mapped
+   void *find(uint64_t key) const
+   {
+      if (!key)
+         return nullptr;
+
+      reader *r = this_thread_reader();
+      // seq_cst: published before `current` is read, see reclaim()
+      r->epoch.store(epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+      void *data = find_in(current.load(std::memory_order_seq_cst), key);
+      r->epoch.store(0, std::memory_order_release);
+      return data;
+   }
+
+   void insert(uint64_t key, void *data)
+   {
+      assert(key && data);
+      std::lock_guard<std::mutex> lock(write_lock);
+      table *t = current.load(std::memory_order_relaxed);
+
+      slot *existing = nullptr, *free_slot = nullptr;
+      size_t i = hash(key) & t->mask;
+      for (;; i = (i + 1) & t->mask) {
+         slot& s = t->slots[i];
+         uint64_t k = s.key.load(std::memory_order_relaxed);
+         if (k == key) {
+            existing = &s;
+            break;
+         }
+         if (!k)
+            break;
+         if (!free_slot && !s.data.load(std::memory_order_relaxed))
+            free_slot = &s;
+      }
+
+      if (existing) {
+         if (!existing->data.load(std::memory_order_relaxed))
+            t->live++;
+         existing->data.store(data, std::memory_order_release);
+         return;
+      }
+
+      if (free_slot) {
+         // key first: a reader of the old key sees it change and bails
+         free_slot->key.store(key, std::memory_order_release);
+         free_slot->data.store(data, std::memory_order_release);
+         t->live++;
+         return;
+      }
+
+      if ((t->used + 1) * 4 > (t->mask + 1) * 3) {
+         t = rehash(t);
+         i = hash(key) & t->mask;
+         while (t->slots[i].key.load(std::memory_order_relaxed))
+            i = (i + 1) & t->mask;
+      }
+
+      t->slots[i].key.store(key, std::memory_order_release);
+      t->slots[i].data.store(data, std::memory_order_release);
+      t->used++;
+      t->live++;
+   }
+
+   void erase(uint64_t key)
+   {
+      if (!key)
+         return;
+
+      std::lock_guard<std::mutex> lock(write_lock);
+      reclaim();
+      table *t = current.load(std::memory_order_relaxed);
+
+      size_t i = hash(key) & t->mask;
+      for (;; i = (i + 1) & t->mask) {
+         uint64_t k = t->slots[i].key.load(std::memory_order_relaxed);
+         if (!k)
+            return;
+         if (k == key)
+            break;
+      }
+
+      if (!t->slots[i].data.load(std::memory_order_relaxed))
+         return;
+      t->slots[i].data.store(nullptr, std::memory_order_release);
+      t->live--;
+
+      // No chain goes past an empty slot, so tombstones right before one
+      // can be emptied without hiding any key from readers
+      if (t->slots[(i + 1) & t->mask].key.load(std::memory_order_relaxed))
+         return;
+
+      while (t->used && !t->slots[i].data.load(std::memory_order_relaxed) &&
+             t->slots[i].key.load(std::memory_order_relaxed)) {
+         t->slots[i].key.store(0, std::memory_order_release);
+         t->used--;
+         i = (i - 1) & t->mask;
+      }
+   }
+
+   size_t size() const
+   {
+      std::lock_guard<std::mutex> lock(write_lock);
+      return current.load(std::memory_order_relaxed)->live;
+   }
+
+   // tables allocated, the current one and those not reclaimed yet
+   size_t table_count() const
+   {
+      std::lock_guard<std::mutex> lock(write_lock);
+      return retired.size() + 1;
+   }
+
+   ~vk_object_map()
+   {
+      delete current.load(std::memory_order_relaxed);
+      for (auto& t : retired)
+         delete t.first;
+   }
+
+private:
+   struct slot {
+      std::atomic<uint64_t> key {0};
+      std::atomic<void *> data {nullptr};
+   };
+
+   struct table {
+      explicit table(size_t size) : mask(size - 1), slots(new slot[size]) {}
+
+      const size_t mask;
+      std::unique_ptr<slot[]> slots;
+      size_t used = 0;   // non empty slots, tombstones included
+      size_t live = 0;
+   };
+
+   // One per thread that ever looked something up, shared by all maps and
+   // reused once its thread exits. epoch is 0 outside of find().
+   struct alignas(64) reader {
+      std::atomic<uint64_t> epoch {0};
+      std::atomic<bool> in_use {true};
+      reader *next = nullptr;
+   };
+
+   struct reader_slot {
+      reader *r = nullptr;
+      ~reader_slot() { if (r) r->in_use.store(false, std::memory_order_release); }
+   };
+
+   static inline std::atomic<reader *> readers {nullptr};
+   static inline std::atomic<uint64_t> epoch {1};
+
+   std::atomic<table *> current {nullptr};
+   // with the epoch they were replaced in
+   std::vector<std::pair<table *, uint64_t>> retired;
+   mutable std::mutex write_lock;
+
+   static reader *this_thread_reader()
+   {
+      static thread_local reader_slot slot;
+      if (slot.r)
+         return slot.r;
+
+      for (reader *r = readers.load(std::memory_order_acquire); r; r = r->next) {
+         bool in_use = false;
+         if (!r->in_use.load(std::memory_order_relaxed) &&
+             r->in_use.compare_exchange_strong(in_use, true, std::memory_order_acquire))
+            return slot.r = r;
+      }
+
+      reader *r = new reader;
+      r->next = readers.load(std::memory_order_relaxed);
+      while (!readers.compare_exchange_weak(r->next, r, std::memory_order_release,
+                                            std::memory_order_relaxed))
+         ;
+      return slot.r = r;
+   }
+
+   static void *find_in(const table *t, uint64_t key)
+   {
+      for (size_t i = hash(key) & t->mask;; i = (i + 1) & t->mask) {
+         const slot& s = t->slots[i];
+         uint64_t k = s.key.load(std::memory_order_acquire);
+         if (!k)
+            return nullptr;
+         if (k != key)
+            continue;
+
+         void *data = s.data.load(std::memory_order_acquire);
+         // the tombstone of `key` was reused for another key meanwhile
+         if (s.key.load(std::memory_order_acquire) != key)
+            return nullptr;
+         return data;
+      }
+   }
+
+   /* A lookup publishing an epoch after a table was retired read `current`
+    * after it was replaced: the replacement, the epoch bump, the lookup's
+    * epoch store and its load of `current` are all seq_cst. So tables
+    * retired before the oldest epoch still being looked up in can go.
+    */
+   void reclaim()
+   {
+      if (retired.empty())
+         return;
+
+      uint64_t oldest = UINT64_MAX;
+      for (reader *r = readers.load(std::memory_order_acquire); r; r = r->next) {
+         uint64_t e = r->epoch.load(std::memory_order_seq_cst);
+         if (e && e < oldest)
+            oldest = e;
+      }
+
+      size_t kept = 0;
+      for (auto& t : retired) {
+         if (t.second < oldest)
+            delete t.first;
+         else
+            retired[kept++] = t;
+      }
+      retired.resize(kept);
+   }
+
+   static size_t hash(uint64_t key)
+   {
+      // handles are mostly aligned pointers, mix the low bits in
+      key ^= key >> 33;
+      key *= 0xff51afd7ed558ccdull;
+      key ^= key >> 33;
+      return static_cast<size_t>(key);
+   }
+
+   table *rehash(table *old)
+   {
+      size_t size = old->mask + 1;
+      if ((old->live + 1) * 2 > size)
+         size *= 2;
+
+      auto t = std::make_unique<table>(size);
+      for (size_t i = 0; i <= old->mask; i++) {
+         uint64_t k = old->slots[i].key.load(std::memory_order_relaxed);
+         void *data = old->slots[i].data.load(std::memory_order_relaxed);
+         if (!k || !data)
+            continue;
+
+         size_t j = hash(k) & t->mask;
+         while (t->slots[j].key.load(std::memory_order_relaxed))
+            j = (j + 1) & t->mask;
+         t->slots[j].key.store(k, std::memory_order_relaxed);
+         t->slots[j].data.store(data, std::memory_order_relaxed);
+         t->used++;
+         t->live++;
+      }
+
+      table *replacement = t.release();
+      current.store(replacement, std::memory_order_seq_cst);
+      retired.emplace_back(old, epoch.fetch_add(1, std::memory_order_seq_cst));
+      reclaim();
+      return replacement;
+   }
+};
+
+#endif //MANGOHUD_VK_OBJECT_MAP_H
@@ -23,6 +23,7 @@
 #ifdef _WIN32
 #include <windows.h>
 #endif
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include <assert.h>
@@ -33,6 +34,7 @@
 #include <vector>
 #include <list>
 #include <array>
+#include <algorithm>
 #include <iomanip>
 #include <sstream>
 #include <inttypes.h>
@@ -62,9 +64,11 @@
 #endif
 #include "fps_limiter.h"
 
-#if defined(__ANDROID__)
 #include <atomic>
-#include "android_gpu_vk_usage.h"
+#include <fstream>
+#include "vk_gpu_usage.h"
+#include "vk_object_map.h"
+#if defined(__ANDROID__)
 #include "gpu.h"
 #endif
 
@@ -110,32 +114,21 @@ struct device_data {
 
    std::vector<struct queue_data *> queues;
 
-#if defined(__ANDROID__)
-   AndroidVkGpuContext* android_gpu_ctx = nullptr;
-
-   // Vulkan timestamp GPU usage: "최후의 보루" 모드
-   bool                 android_vk_gpu_usage_enabled = false;
-   uint64_t             android_vk_interval_ns = 100000000ull; // default 100ms
-
-   // 샘플링 타이밍 (멀티스레드 QueueSubmit 고려)
-   std::atomic<uint64_t> android_vk_next_submit_sample_ns{0};
-   std::atomic<uint64_t> android_vk_next_metrics_poll_ns{0};
-#endif
+   // Vulkan timestamp GPU frame time, contexts live on the graphics queues
+   bool                   gpu_usage_enabled = false;
+   VulkanGpuUsageDispatch gpu_usage_disp{};
+   float                  gpu_usage_ts_period_ns = 0.0f;
+   uint64_t               gpu_usage_interval_ns = 100000000ull; // default 100ms
+   std::atomic<uint64_t>  gpu_usage_next_metrics_poll_ns{0};
 
    PFN_vkQueueSubmit2    real_QueueSubmit2    = nullptr;
    PFN_vkQueueSubmit2KHR real_QueueSubmit2KHR = nullptr;
-};
-/* Mapped from VkCommandBuffer */
-struct command_buffer_data {
-   struct device_data *device;
-
-   VkCommandBufferLevel level;
 
-   VkCommandBuffer cmd_buffer;
-
-   struct queue_data *queue_data;
+   /* Shared by all swapchains and kept on disk, see setup_pipeline_cache() */
+   VkPipelineCache pipeline_cache = VK_NULL_HANDLE;
+   std::string pipeline_cache_path;
+   size_t pipeline_cache_size = 0;
 };
-
 /* Mapped from VkQueue */
 struct queue_data {
    struct device_data *device;
@@ -143,14 +136,14 @@ struct queue_data {
    VkQueue queue;
    VkQueueFlags flags;
    uint32_t family_index;
+
+   VulkanGpuUsageContext* gpu_usage_ctx = nullptr;
+   // 샘플링 타이밍 (멀티스레드 QueueSubmit 고려)
+   std::atomic<uint64_t> gpu_usage_next_submit_ns{0};
 };
 
 struct overlay_draw {
    VkCommandBuffer command_buffer;
-
-   VkSemaphore cross_engine_semaphore;
-
-   VkSemaphore semaphore;
    VkFence fence;
 
    VkBuffer vertex_buffer;
@@ -164,6 +157,28 @@ struct overlay_draw {
    // 영구매핑 포인터
    void* vertex_mapped = nullptr;
    void* index_mapped  = nullptr;
+
+   /* swapchain_data::hud_build the buffers hold */
+   uint64_t uploaded_hud_build = 0;
+
+   /* swapchain_data::draw_submits at the last submission, 0 once the
+    * fence was reset */
+   uint64_t submit = 0;
+   VkQueue queue = VK_NULL_HANDLE;
+};
+
+/* Font and HUD images, with their upload or quad buffers, that draws in
+ * flight may still use, see release_retired_images() */
+struct retired_image {
+   VkImage image;
+   VkImageView image_view;
+   VkDeviceMemory mem;
+   VkFramebuffer framebuffer;
+   VkBuffer buffer;
+   VkDeviceMemory buffer_mem;
+   VkDescriptorSet descriptor_set;
+   /* swapchain_data::draw_submits when it was replaced */
+   uint64_t submits;
 };
 
 /* Mapped from VkSwapchainKHR */
@@ -177,6 +192,14 @@ struct swapchain_data {
    std::vector<VkImage> images;
    std::vector<VkImageView> image_views;
    std::vector<VkFramebuffer> framebuffers;
+   /* Per image, unlike draws: the present waiting on them is only known to
+    * have run once its image is acquired again, not when a draw's fence
+    * signals. present_semaphores are signalled by the overlay draw and
+    * waited by the present, cross_engine_semaphores order our graphics
+    * queue after a present queue of another family.
+    */
+   std::vector<VkSemaphore> present_semaphores;
+   std::vector<VkSemaphore> cross_engine_semaphores;
 
    VkRenderPass render_pass;
 
@@ -188,10 +211,19 @@ struct swapchain_data {
 
    VkPipelineLayout pipeline_layout;
    VkPipeline pipeline;
+   /* draws hud_image with premultiplied alpha */
+   VkPipeline composite_pipeline;
 
    VkCommandPool command_pool;
 
-   std::vector<overlay_draw *> draws; /* vector of struct overlay_draw */
+   /* Ring of in flight draws, oldest at next_draw, see get_overlay_draw() */
+   std::vector<overlay_draw *> draws;
+   size_t next_draw = 0;
+   /* times the present thread had to wait for a draw to retire */
+   uint64_t draw_waits = 0;
+   uint64_t draw_submits = 0;
+   /* VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT per application semaphore */
+   std::vector<VkPipelineStageFlags> wait_stages;
 
    bool font_uploaded;
    VkImage font_image;
@@ -199,19 +231,44 @@ struct swapchain_data {
    VkDeviceMemory font_mem;
    VkBuffer upload_font_buffer;
    VkDeviceMemory upload_font_buffer_mem;
+   /* glyphs added since the last upload, see add_requested_glyphs() */
+   font_atlas_rect font_dirty;
+   std::vector<retired_image> retired_images;
 
    /**/
    ImGuiContext* imgui_context;
    ImFontAtlas* font_atlas;
    ImVec2 window_size;
+   /* bumped every time ImGui draw data is rebuilt */
+   uint64_t hud_build = 0;
+
+   /* hud_retained: HUD drawn once per build, see setup_hud_image() */
+   bool hud_image_failed = false;
+   /* rebuilds in the current hud_direct_window, see hud_image_pays_off() */
+   bool hud_direct = false;
+   uint32_t hud_window_presents = 0;
+   uint32_t hud_window_builds = 0;
+   uint64_t hud_window_build = 0;
+   VkImage hud_image = VK_NULL_HANDLE;
+   VkExtent2D hud_image_extent = {};
+   VkDeviceMemory hud_mem = VK_NULL_HANDLE;
+   VkImageView hud_image_view = VK_NULL_HANDLE;
+   VkDescriptorSet hud_descriptor_set = VK_NULL_HANDLE;
+   VkRenderPass hud_render_pass = VK_NULL_HANDLE;
+   VkFramebuffer hud_framebuffer = VK_NULL_HANDLE;
+   uint64_t hud_image_build = 0;
+   VkRect2D hud_rect = {};
+   VkBuffer quad_buffer = VK_NULL_HANDLE;
+   VkDeviceMemory quad_buffer_mem = VK_NULL_HANDLE;
+   VkDeviceSize quad_buffer_size = 0;
+   void* quad_mapped = nullptr;
 
    struct swapchain_stats sw_stats;
 };
 
-// single global lock, for simplicity
-std::mutex global_lock;
 typedef std::lock_guard<std::mutex> scoped_lock;
-std::unordered_map<uint64_t, void *> vk_object_to_data;
+// looked up by every intercepted call, see vk_object_map.h
+vk_object_map vk_object_to_data;
 
 thread_local ImGuiContext* __MesaImGui;
 
@@ -220,19 +277,16 @@ thread_local ImGuiContext* __MesaImGui;
 
 static void *find_object_data(uint64_t obj)
 {
-   ::scoped_lock lk(global_lock);
-   return vk_object_to_data[obj];
+   return vk_object_to_data.find(obj);
 }
 
 static void map_object(uint64_t obj, void *data)
 {
-   ::scoped_lock lk(global_lock);
-   vk_object_to_data[obj] = data;
+   vk_object_to_data.insert(obj, data);
 }
 
 static void unmap_object(uint64_t obj)
 {
-   ::scoped_lock lk(global_lock);
    vk_object_to_data.erase(obj);
 }
 
@@ -249,27 +303,28 @@ static void unmap_object(uint64_t obj)
 
 /**/
 
-#if defined(__ANDROID__)
-static inline uint64_t android_vk_now_ns()
+static inline uint64_t gpu_usage_now_ns()
 {
    using namespace std::chrono;
    return (uint64_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
 }
 
-// default OFF (kgsl이 기본이라며, 그럼 이건 켜기 전까지 존재감 0이 맞음)
-static inline bool android_vk_read_enabled()
+// default OFF, gpu_frametime 파라미터 또는 MANGOHUD_VKP=1 일 때만 켠다.
+static inline bool gpu_usage_read_enabled(const struct overlay_params& params)
 {
-   // Vulkan timestamp GPU usage는 "진짜 최후의 보루"라서
-   // MANGOHUD_VKP=1일 때만 켠다.
+   if (params.enabled[OVERLAY_PARAM_ENABLED_gpu_frametime])
+      return true;
    const char* s = getenv("MANGOHUD_VKP");
    if (!s || !*s) return false;
    return (strtol(s, nullptr, 10) != 0);
 }
 
 // 샘플링 간격(ms) env로 조절
-static inline uint64_t android_vk_read_interval_ns()
+static inline uint64_t gpu_usage_read_interval_ns()
 {
-   const char* s = getenv("MANGOHUD_ANDROID_VK_GPU_USAGE_INTERVAL_MS");
+   const char* s = getenv("MANGOHUD_VK_GPU_USAGE_INTERVAL_MS");
+   if (!s || !*s)
+      s = getenv("MANGOHUD_ANDROID_VK_GPU_USAGE_INTERVAL_MS");
    if (!s || !*s) return 100000000ull; // 100ms
    long ms = strtol(s, nullptr, 10);
 
@@ -280,7 +335,7 @@ static inline uint64_t android_vk_read_interval_ns()
 }
 
 // "지금 시간에 이 작업을 해도 되는가?" 원자적으로 한 스레드만 통과
-static inline bool android_vk_try_tick(std::atomic<uint64_t>& next_ns,
+static inline bool gpu_usage_try_tick(std::atomic<uint64_t>& next_ns,
                                        uint64_t interval_ns,
                                        uint64_t now_ns)
 {
@@ -303,7 +358,6 @@ static inline bool has_cmd_buffers2(const VkSubmitInfo2* submits, uint32_t submi
       if (submits[i].commandBufferInfoCount) return true;
    return false;
 }
-#endif
 
 static void shutdown_swapchain_font(struct swapchain_data*);
 
@@ -398,11 +452,26 @@ static struct queue_data *new_queue_data(VkQueue queue,
    if (data->flags & VK_QUEUE_GRAPHICS_BIT)
       device_data->graphic_queue = data;
 
+   // 큐마다 별도 query pool, 큐 패밀리의 timestampValidBits 기준
+   if (device_data->gpu_usage_enabled &&
+       (data->flags & VK_QUEUE_GRAPHICS_BIT) &&
+       family_props->timestampValidBits) {
+      data->gpu_usage_ctx = vk_gpu_usage_create(device_data->physical_device,
+                                                device_data->device,
+                                                device_data->gpu_usage_ts_period_ns,
+                                                family_props->timestampValidBits,
+                                                device_data->gpu_usage_disp);
+   }
+
    return data;
 }
 
 static void destroy_queue(struct queue_data *data)
 {
+   if (data->gpu_usage_ctx) {
+      vk_gpu_usage_destroy(data->gpu_usage_ctx);
+      data->gpu_usage_ctx = nullptr;
+   }
    unmap_object(HKEY(data->queue));
    delete data;
 }
@@ -448,28 +517,81 @@ static void device_unmap_queues(struct device_data *data)
       destroy_queue(q);
 }
 
-static void destroy_device_data(struct device_data *data)
-{
-   unmap_object(HKEY(data->device));
-   delete data;
+/* The overlay pipelines are rebuilt on every swapchain recreation and
+ * every start. Through the cache, only the first build on a given driver
+ * compiles anything.
+ */
+static void setup_pipeline_cache(struct device_data *data)
+{
+   std::string dir = get_cache_dir();
+   if (!dir.empty()) {
+      char name[64];
+      snprintf(name, sizeof(name), "/MangoHud/vk_pipeline_cache_%04x_%04x.bin",
+               data->properties.vendorID, data->properties.deviceID);
+      data->pipeline_cache_path = dir + name;
+   }
+
+   std::vector<char> blob;
+   if (!data->pipeline_cache_path.empty()) {
+      std::ifstream file(data->pipeline_cache_path, std::ios::binary);
+      blob.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+   }
+
+   /* Only hand the driver data written by the same device and driver build:
+    * header size, header version, vendor id, device id and cache UUID.
+    */
+   uint32_t header[4];
+   if (!blob.empty()) {
+      bool matches = blob.size() >= sizeof(header) + VK_UUID_SIZE;
+      if (matches) {
+         memcpy(header, blob.data(), sizeof(header));
+         matches = header[1] == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+                   header[2] == data->properties.vendorID &&
+                   header[3] == data->properties.deviceID &&
+                   !memcmp(blob.data() + sizeof(header),
+                           data->properties.pipelineCacheUUID, VK_UUID_SIZE);
+      }
+      if (!matches) {
+         SPDLOG_DEBUG("Ignoring pipeline cache {} of another driver", data->pipeline_cache_path);
+         blob.clear();
+      }
+   }
+
+   VkPipelineCacheCreateInfo info = {};
+   info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+   info.initialDataSize = blob.size();
+   info.pInitialData = blob.data();
+   VK_CHECK(data->vtable.CreatePipelineCache(data->device, &info, NULL,
+                                             &data->pipeline_cache));
+   data->pipeline_cache_size = blob.size();
 }
 
-/**/
-static struct command_buffer_data *new_command_buffer_data(VkCommandBuffer cmd_buffer,
-                                                           VkCommandBufferLevel level,
-                                                           struct device_data *device_data)
+/* Written as soon as new pipelines make the cache grow, games are often
+ * killed before they destroy their device.
+ */
+static void save_pipeline_cache(struct device_data *data)
 {
-   struct command_buffer_data *data = new command_buffer_data();
-   data->device = device_data;
-   data->cmd_buffer = cmd_buffer;
-   data->level = level;
-   map_object(HKEY(data->cmd_buffer), data);
-   return data;
+   if (data->pipeline_cache == VK_NULL_HANDLE || data->pipeline_cache_path.empty())
+      return;
+
+   size_t size = 0;
+   if (data->vtable.GetPipelineCacheData(data->device, data->pipeline_cache,
+                                         &size, NULL) != VK_SUCCESS ||
+       size <= data->pipeline_cache_size)
+      return;
+
+   std::vector<char> blob(size);
+   if (data->vtable.GetPipelineCacheData(data->device, data->pipeline_cache,
+                                         &size, blob.data()) != VK_SUCCESS)
+      return;
+
+   if (replace_file(data->pipeline_cache_path, blob.data(), size))
+      data->pipeline_cache_size = size;
 }
 
-static void destroy_command_buffer_data(struct command_buffer_data *data)
+static void destroy_device_data(struct device_data *data)
 {
-   unmap_object(HKEY(data->cmd_buffer));
+   unmap_object(HKEY(data->device));
    delete data;
 }
 
@@ -493,27 +615,42 @@ static void destroy_swapchain_data(struct swapchain_data *data)
    delete data;
 }
 
-static struct overlay_draw *get_overlay_draw(struct swapchain_data *data, unsigned image_idx)
+/* Draws allowed in flight on top of one per swapchain image */
+static const size_t overlay_draw_slack = 2;
+/* Font and HUD images replaced before the draws using them retired, each
+ * keeps a set of descriptor_pool */
+static const size_t max_retired_images = 2;
+
+/* Returns the oldest draw if the GPU is done with it, a new one if the ring
+ * can still grow, and only waits on the oldest one once the ring is full.
+ * Draws only hold what their fence covers, see present_semaphores.
+ */
+static struct overlay_draw *get_overlay_draw(struct swapchain_data *data)
 {
    struct device_data *device_data = data->device;
-   const size_t images_count = data->images.size();
-   if (data->draws.size() < images_count) {
-      data->draws.resize(images_count, nullptr);
-   }
-   struct overlay_draw *draw = data->draws[image_idx];
-
-   VkSemaphoreCreateInfo sem_info = {};
-   sem_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-
-   if (draw) {
-      VK_CHECK(device_data->vtable.WaitForFences(device_data->device, 1,
-                                                 &draw->fence, VK_TRUE, ~0ull));
-      VK_CHECK(device_data->vtable.ResetFences(device_data->device,
-                                               1, &draw->fence));
-      return draw;
+   const size_t max_draws = data->images.size() + overlay_draw_slack;
+
+   if (!data->draws.empty()) {
+      struct overlay_draw *oldest = data->draws[data->next_draw];
+      VkResult status = device_data->vtable.GetFenceStatus(device_data->device,
+                                                           oldest->fence);
+      if (status == VK_SUCCESS || data->draws.size() >= max_draws) {
+         if (status != VK_SUCCESS) {
+            data->draw_waits++;
+            SPDLOG_DEBUG("All {} overlay draws in flight, waiting ({} times)",
+                         data->draws.size(), data->draw_waits);
+            VK_CHECK(device_data->vtable.WaitForFences(device_data->device, 1,
+                                                       &oldest->fence, VK_TRUE, ~0ull));
+         }
+         VK_CHECK(device_data->vtable.ResetFences(device_data->device,
+                                                  1, &oldest->fence));
+         oldest->submit = 0;
+         data->next_draw = (data->next_draw + 1) % data->draws.size();
+         return oldest;
+      }
    }
 
-   draw = new overlay_draw();
+   struct overlay_draw *draw = new overlay_draw();
 
    VkCommandBufferAllocateInfo cmd_buffer_info = {};
    cmd_buffer_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -534,67 +671,90 @@ static struct overlay_draw *get_overlay_draw(struct swapchain_data *data, unsign
                                             NULL,
                                             &draw->fence));
 
-   VK_CHECK(device_data->vtable.CreateSemaphore(device_data->device, &sem_info,
-                                                NULL, &draw->semaphore));
-   VK_CHECK(device_data->vtable.CreateSemaphore(device_data->device, &sem_info,
-                                                NULL, &draw->cross_engine_semaphore));
-
-   data->draws[image_idx] = draw;
+   /* Goes in right before the oldest one, which stays next in line */
+   data->draws.insert(data->draws.begin() + data->next_draw, draw);
+   data->next_draw = (data->next_draw + 1) % data->draws.size();
 
    return draw;
 }
 
-static void snapshot_swapchain_frame(struct swapchain_data *data)
+static void update_gpu_frametime(struct swapchain_data *data)
 {
-   struct device_data *device_data   = data->device;
-   struct instance_data *instance_data = device_data->instance;
+   struct device_data *device_data = data->device;
+   if (!device_data->gpu_usage_enabled)
+      return;
 
-   update_hud_info(data->sw_stats, instance_data->params,
-                   device_data->properties.vendorID);
-   check_keybinds(instance_data->params);
+   // 매 프레임 get_metrics 하지 말고 interval마다 1회만
+   const uint64_t now = gpu_usage_now_ns();
+   if (!gpu_usage_try_tick(device_data->gpu_usage_next_metrics_poll_ns,
+                           device_data->gpu_usage_interval_ns,
+                           now))
+      return;
 
-#if defined(__ANDROID__)
-   if (device_data->android_gpu_ctx && gpus) {
-
-      // (추가) 매 프레임 get_metrics 하지 말고 interval마다 1회만
-      const uint64_t now = android_vk_now_ns();
-      if (!android_vk_try_tick(device_data->android_vk_next_metrics_poll_ns,
-                               device_data->android_vk_interval_ns,
-                               now)) {
-         return; // snapshot_swapchain_frame() 내부라면 그냥 스킵
-      }
+   // 가장 바쁜 그래픽스 큐 기준
+   bool have_metrics = false;
+   float gpu_ms      = 0.f;
+   float gpu_usage   = 0.f;
+   uint64_t end_ns   = 0;
+   for (auto q : device_data->queues) {
+      float ms = 0.f, usage = 0.f;
+      uint64_t q_end_ns = 0;
+      if (!q->gpu_usage_ctx ||
+          !vk_gpu_usage_get_metrics(q->gpu_usage_ctx, &ms, &usage, &q_end_ns))
+         continue;
 
-      float gpu_ms    = 0.f;
-      float gpu_usage = 0.f;
+      have_metrics = true;
+      gpu_ms    = std::max(gpu_ms, ms);
+      gpu_usage = std::max(gpu_usage, usage);
+      end_ns    = std::max(end_ns, q_end_ns);
+   }
 
-      if (android_gpu_usage_get_metrics(device_data->android_gpu_ctx,
-                                        &gpu_ms, &gpu_usage)) {
+   if (!have_metrics)
+      return;
 
-         // selected_gpus()[0]의 "참조" 타입에서 참조/const 떼고 순수 값 타입만 얻기
-         using SelectedGpuRef = decltype(gpus->selected_gpus()[0]);
-         using GpuPtr         = std::decay_t<SelectedGpuRef>;
+   data->sw_stats.gpu_frame_ms = gpu_ms;
+   data->sw_stats.gpu_busy = gpu_usage;
+   data->sw_stats.gpu_frame_end_ns = end_ns;
 
-         // gpu_info* 이든 std::shared_ptr<GPU>든 둘 다 여기 수렴
-         static GpuPtr cached_gpu = nullptr;
+#if defined(__ANDROID__)
+   if (!gpus)
+      return;
 
-         // 아직 캐시 안 되어 있으면 한 번만 selected_gpus() 호출
-         if (!cached_gpu) {
-            auto selected = gpus->selected_gpus();
-            if (!selected.empty())
-               cached_gpu = selected[0];
-         }
+   // selected_gpus()[0]의 "참조" 타입에서 참조/const 떼고 순수 값 타입만 얻기
+   using SelectedGpuRef = decltype(gpus->selected_gpus()[0]);
+   using GpuPtr         = std::decay_t<SelectedGpuRef>;
 
-         if (cached_gpu) {
-            int load = static_cast<int>(gpu_usage + 0.5f);
-            if (load < 0)   load = 0;
-            if (load > 100) load = 100;
+   // gpu_info* 이든 std::shared_ptr<GPU>든 둘 다 여기 수렴
+   static GpuPtr cached_gpu = nullptr;
 
-            // gpu_info* / shared_ptr<GPU> 둘 다 '->'로 접근 가능
-            cached_gpu->metrics.load = load;
-         }
-      }
+   // 아직 캐시 안 되어 있으면 한 번만 selected_gpus() 호출
+   if (!cached_gpu) {
+      auto selected = gpus->selected_gpus();
+      if (!selected.empty())
+         cached_gpu = selected[0];
+   }
+
+   if (cached_gpu) {
+      int load = static_cast<int>(gpu_usage + 0.5f);
+      if (load < 0)   load = 0;
+      if (load > 100) load = 100;
+
+      // gpu_info* / shared_ptr<GPU> 둘 다 '->'로 접근 가능
+      cached_gpu->set_load(load);
    }
 #endif
+}
+
+static void snapshot_swapchain_frame(struct swapchain_data *data)
+{
+   struct device_data *device_data   = data->device;
+   struct instance_data *instance_data = device_data->instance;
+
+   update_hud_info(data->sw_stats, instance_data->params,
+                   device_data->properties.vendorID);
+   check_keybinds(instance_data->params);
+
+   update_gpu_frametime(data);
 
 #ifdef __linux__
    if (instance_data->params.control >= 0) {
@@ -605,6 +765,8 @@ static void snapshot_swapchain_frame(struct swapchain_data *data)
 }
 
 
+static void check_fonts(struct swapchain_data* data);
+
 static void compute_swapchain_display(struct swapchain_data *data)
 {
    struct device_data *device_data = data->device;
@@ -617,6 +779,14 @@ static void compute_swapchain_display(struct swapchain_data *data)
    if (HUDElements.colors.update)
       HUDElements.convert_colors(instance_data->params);
 
+   // glyphs the previous build asked for have to be in the atlas first
+   check_fonts(data);
+
+   /* Keep drawing the previous draw data (and the vertex/index buffers
+    * already uploaded from it) until something shown changes */
+   if (!hud_needs_rebuild(data->sw_stats, ImGui::GetIO().DisplaySize))
+      return;
+
    ImGui::NewFrame();
    {
       ::scoped_lock lk(instance_data->notifier.mutex);
@@ -627,7 +797,7 @@ static void compute_swapchain_display(struct swapchain_data *data)
    }
    ImGui::EndFrame();
    ImGui::Render();
-
+   data->hud_build++;
 }
 
 static uint32_t vk_memory_type(struct device_data *data,
@@ -683,16 +853,21 @@ static void update_image_descriptor(struct swapchain_data *data, VkImageView ima
    device_data->vtable.UpdateDescriptorSets(device_data->device, 1, write_desc, 0, NULL);
 }
 
+/* Copies the `rect` texels of `pixels`, `stride` texels wide, to `image`.
+ * Unless `keep`, what the image held before is discarded.
+ */
 static void upload_image_data(struct device_data *device_data,
                               VkCommandBuffer command_buffer,
-                              void *pixels,
-                              VkDeviceSize upload_size,
-                              uint32_t width,
-                              uint32_t height,
+                              const unsigned char *pixels,
+                              uint32_t stride,
+                              VkRect2D rect,
+                              bool keep,
                               VkBuffer& upload_buffer,
                               VkDeviceMemory& upload_buffer_mem,
                               VkImage image)
 {
+   const VkDeviceSize upload_size = VkDeviceSize(rect.extent.width) * rect.extent.height;
+
    /* Upload buffer */
    VkBufferCreateInfo buffer_info = {};
    buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -724,7 +899,10 @@ static void upload_image_data(struct device_data *device_data,
    VK_CHECK(device_data->vtable.MapMemory(device_data->device,
                                           upload_buffer_mem,
                                           0, upload_size, 0, (void**)(&map)));
-   memcpy(map, pixels, upload_size);
+   for (uint32_t y = 0; y < rect.extent.height; y++)
+      memcpy(map + y * rect.extent.width,
+             pixels + (rect.offset.y + y) * stride + rect.offset.x,
+             rect.extent.width);
    VkMappedMemoryRange range[1] = {};
    range[0].sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
    range[0].memory = upload_buffer_mem;
@@ -737,7 +915,8 @@ static void upload_image_data(struct device_data *device_data,
    VkImageMemoryBarrier copy_barrier[1] = {};
    copy_barrier[0].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
    copy_barrier[0].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-   copy_barrier[0].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+   copy_barrier[0].oldLayout = keep ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL :
+                                      VK_IMAGE_LAYOUT_UNDEFINED;
    copy_barrier[0].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
    copy_barrier[0].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
    copy_barrier[0].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
@@ -745,8 +924,10 @@ static void upload_image_data(struct device_data *device_data,
    copy_barrier[0].subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
    copy_barrier[0].subresourceRange.levelCount = 1;
    copy_barrier[0].subresourceRange.layerCount = 1;
+   /* earlier draws on this queue may still sample the texels kept */
    device_data->vtable.CmdPipelineBarrier(command_buffer,
-                                          VK_PIPELINE_STAGE_HOST_BIT,
+                                          keep ? VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT :
+                                                 VK_PIPELINE_STAGE_HOST_BIT,
                                           VK_PIPELINE_STAGE_TRANSFER_BIT,
                                           0, 0, NULL, 0, NULL,
                                           1, copy_barrier);
@@ -754,8 +935,10 @@ static void upload_image_data(struct device_data *device_data,
    VkBufferImageCopy region = {};
    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
    region.imageSubresource.layerCount = 1;
-   region.imageExtent.width = width;
-   region.imageExtent.height = height;
+   region.imageOffset.x = rect.offset.x;
+   region.imageOffset.y = rect.offset.y;
+   region.imageExtent.width = rect.extent.width;
+   region.imageExtent.height = rect.extent.height;
    region.imageExtent.depth = 1;
    device_data->vtable.CmdCopyBufferToImage(command_buffer,
                                             upload_buffer,
@@ -791,7 +974,8 @@ static void create_image(struct swapchain_data *data,
                         VkFormat format,
                         VkImage& image,
                         VkDeviceMemory& image_mem,
-                        VkImageView& image_view)
+                        VkImageView& image_view,
+                        VkImageUsageFlags usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT)
 {
    struct device_data *device_data = data->device;
 
@@ -806,7 +990,7 @@ static void create_image(struct swapchain_data *data,
    image_info.arrayLayers = 1;
    image_info.samples = VK_SAMPLE_COUNT_1_BIT;
    image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
-   image_info.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+   image_info.usage = usage;
    image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
    image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
    VK_CHECK(device_data->vtable.CreateImage(device_data->device, &image_info,
@@ -847,7 +1031,8 @@ static VkDescriptorSet create_image_with_desc(struct swapchain_data *data,
                                           VkFormat format,
                                           VkImage& image,
                                           VkDeviceMemory& image_mem,
-                                          VkImageView& image_view)
+                                          VkImageView& image_view,
+                                          VkImageUsageFlags usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT)
 {
    struct device_data *device_data = data->device;
 
@@ -862,57 +1047,175 @@ static VkDescriptorSet create_image_with_desc(struct swapchain_data *data,
                                                        &alloc_info,
                                                        &descriptor_set));
 
-   create_image(data, descriptor_set, width, height, format, image, image_mem, image_view);
+   create_image(data, descriptor_set, width, height, format, image, image_mem, image_view, usage);
    return descriptor_set;
 }
 
+/* Draws may still use them until their fences signal, see
+ * release_retired_images() */
+static void retire_swapchain_font(struct swapchain_data *data, bool image)
+{
+   retired_image font = {};
+   font.buffer = data->upload_font_buffer;
+   font.buffer_mem = data->upload_font_buffer_mem;
+   data->upload_font_buffer = VK_NULL_HANDLE;
+   data->upload_font_buffer_mem = VK_NULL_HANDLE;
+   if (image) {
+      font.image = data->font_image;
+      font.image_view = data->font_image_view;
+      font.mem = data->font_mem;
+      font.descriptor_set = (VkDescriptorSet)data->font_atlas->TexID;
+      data->font_image = VK_NULL_HANDLE;
+      data->font_image_view = VK_NULL_HANDLE;
+      data->font_mem = VK_NULL_HANDLE;
+   }
+   font.submits = data->draw_submits;
+
+   if (font.buffer || font.image || font.descriptor_set)
+      data->retired_images.push_back(font);
+}
+
+static void destroy_retired_image(struct swapchain_data *data, const retired_image& retired)
+{
+   struct device_data *device_data = data->device;
+
+   device_data->vtable.DestroyFramebuffer(device_data->device, retired.framebuffer, NULL);
+   device_data->vtable.DestroyImageView(device_data->device, retired.image_view, NULL);
+   device_data->vtable.DestroyImage(device_data->device, retired.image, NULL);
+   device_data->vtable.FreeMemory(device_data->device, retired.mem, NULL);
+   device_data->vtable.DestroyBuffer(device_data->device, retired.buffer, NULL);
+   device_data->vtable.FreeMemory(device_data->device, retired.buffer_mem, NULL);
+   if (retired.descriptor_set)
+      device_data->vtable.FreeDescriptorSets(device_data->device, data->descriptor_pool,
+                                             1, &retired.descriptor_set);
+}
+
+/* Frees the retired images no draw submitted before they were replaced
+ * still runs, waiting for those draws if `wait`.
+ */
+static void release_retired_images(struct swapchain_data *data, bool wait)
+{
+   struct device_data *device_data = data->device;
+
+   if (data->retired_images.empty())
+      return;
+
+   uint64_t done = data->draw_submits;
+   for (auto draw : data->draws) {
+      if (!draw->submit)
+         continue;
+      if (wait)
+         VK_CHECK(device_data->vtable.WaitForFences(device_data->device, 1,
+                                                    &draw->fence, VK_TRUE, ~0ull));
+      else if (device_data->vtable.GetFenceStatus(device_data->device,
+                                                  draw->fence) != VK_SUCCESS)
+         done = std::min(done, draw->submit - 1);
+   }
+
+   auto released = std::remove_if(data->retired_images.begin(), data->retired_images.end(),
+                                  [&](const retired_image& retired) {
+      if (retired.submits > done)
+         return false;
+      destroy_retired_image(data, retired);
+      return true;
+   });
+   data->retired_images.erase(released, data->retired_images.end());
+}
+
+/* descriptor_pool only has room for max_retired_images retired sets */
+static void reserve_retired_set(struct swapchain_data *data)
+{
+   size_t retired_sets = std::count_if(data->retired_images.begin(), data->retired_images.end(),
+                                       [](const retired_image& retired) { return retired.descriptor_set != VK_NULL_HANDLE; });
+   if (retired_sets >= max_retired_images)
+      release_retired_images(data, true);
+}
+
+/* Barriers only order the work of their own queue */
+static void wait_draws_on_other_queues(struct swapchain_data *data, VkQueue queue)
+{
+   struct device_data *device_data = data->device;
+
+   for (auto draw : data->draws)
+      if (draw->submit && draw->queue != queue)
+         VK_CHECK(device_data->vtable.WaitForFences(device_data->device, 1,
+                                                    &draw->fence, VK_TRUE, ~0ull));
+}
+
 static void check_fonts(struct swapchain_data* data)
 {
    struct device_data *device_data = data->device;
    struct instance_data *instance_data = device_data->instance;
    auto& params = instance_data->params;
 
-   if (params.font_params_hash != data->sw_stats.font_params_hash)
-   {
-      SPDLOG_DEBUG("Recreating font image");
-      VkDescriptorSet desc_set = (VkDescriptorSet)data->font_atlas->TexID;
-      create_fonts(data->font_atlas, instance_data->params, data->sw_stats.font_small, data->sw_stats.font_text, data->sw_stats.font_secondary);
-      unsigned char* pixels;
-      int width, height;
-      data->font_atlas->GetTexDataAsAlpha8(&pixels, &width, &height);
-
-      // wait for rendering to complete, if any
-      device_data->vtable.DeviceWaitIdle(device_data->device);
-      shutdown_swapchain_font(data);
-
-      if (desc_set)
-         create_image(data, desc_set, width, height, VK_FORMAT_R8_UNORM, data->font_image, data->font_mem, data->font_image_view);
-      else
-         desc_set = create_image_with_desc(data, width, height, VK_FORMAT_R8_UNORM, data->font_image, data->font_mem, data->font_image_view);
+   release_retired_images(data, false);
 
-      data->font_atlas->SetTexID((ImTextureID)desc_set);
-      data->font_uploaded = false;
-      data->sw_stats.font_params_hash = params.font_params_hash;
-      SPDLOG_DEBUG("Default font tex size: {}x{}px", width, height);
+   uint32_t glyphs_generation = lazy_glyphs_generation();
+   bool rebuild = params.font_params_hash != data->sw_stats.font_params_hash;
+   if (!rebuild && glyphs_generation != data->sw_stats.font_glyphs_generation) {
+      // in place, ensure_swapchain_fonts() uploads what changed
+      rebuild = !add_requested_glyphs(data->font_atlas, data->font_dirty);
+      data->sw_stats.font_glyphs_generation = glyphs_generation;
+      // the previous draw data was measured and drawn without them
+      mark_hud_dirty();
    }
+   if (!rebuild)
+      return;
+
+   SPDLOG_DEBUG("Recreating font image");
+   // draws in flight keep the old image and descriptor set
+   reserve_retired_set(data);
+   retire_swapchain_font(data, true);
+
+   data->sw_stats.font_sdf = params.enabled[OVERLAY_PARAM_ENABLED_font_sdf];
+   create_fonts(data->font_atlas, instance_data->params, data->sw_stats.font_small, data->sw_stats.font_text, data->sw_stats.font_secondary,
+                data->sw_stats.font_sdf);
+   unsigned char* pixels;
+   int width, height;
+   data->font_atlas->GetTexDataAsAlpha8(&pixels, &width, &height);
+
+   VkDescriptorSet desc_set = create_image_with_desc(data, width, height, VK_FORMAT_R8_UNORM, data->font_image, data->font_mem, data->font_image_view);
+   data->font_atlas->SetTexID((ImTextureID)desc_set);
+   data->font_uploaded = false;
+   data->font_dirty = {};
+   data->sw_stats.font_params_hash = params.font_params_hash;
+   data->sw_stats.font_glyphs_generation = glyphs_generation;
+   // the previous draw data points into the old atlas
+   mark_hud_dirty();
+   SPDLOG_DEBUG("Default font tex size: {}x{}px", width, height);
 }
 
 static void ensure_swapchain_fonts(struct swapchain_data *data,
-                                   VkCommandBuffer command_buffer)
+                                   VkCommandBuffer command_buffer,
+                                   VkQueue queue)
 {
    struct device_data *device_data = data->device;
 
    check_fonts(data);
 
-   if (data->font_uploaded)
-      return;
+   VkRect2D rect = {};
+   const font_atlas_rect& dirty = data->font_dirty;
+   bool keep = data->font_uploaded;
+   if (keep) {
+      if (dirty.x1 <= dirty.x0 || dirty.y1 <= dirty.y0)
+         return;
+      rect.offset = { dirty.x0, dirty.y0 };
+      rect.extent = { uint32_t(dirty.x1 - dirty.x0), uint32_t(dirty.y1 - dirty.y0) };
+      wait_draws_on_other_queues(data, queue);
+   }
 
-   data->font_uploaded = true;
    unsigned char* pixels;
    int width, height;
    data->font_atlas->GetTexDataAsAlpha8(&pixels, &width, &height);
-   size_t upload_size = width * height * 1 * sizeof(char);
-   upload_image_data(device_data, command_buffer, pixels, upload_size, width, height, data->upload_font_buffer, data->upload_font_buffer_mem, data->font_image);
+   if (!keep)
+      rect.extent = { uint32_t(width), uint32_t(height) };
+
+   data->font_uploaded = true;
+   data->font_dirty = {};
+   // a previous upload may still be running
+   retire_swapchain_font(data, false);
+   upload_image_data(device_data, command_buffer, pixels, width, rect, keep,
+                     data->upload_font_buffer, data->upload_font_buffer_mem, data->font_image);
 }
 
 static void CreateOrResizeBuffer(struct device_data *data,
@@ -971,119 +1274,83 @@ static void CreateOrResizeBuffer(struct device_data *data,
 }
 
 
-static struct overlay_draw *render_swapchain_display(struct swapchain_data *data,
-                                                     struct queue_data *present_queue,
-                                                     const VkSemaphore *wait_semaphores,
-                                                     unsigned n_wait_semaphores,
-                                                     unsigned image_index)
+static void upload_draw_data(struct swapchain_data *data,
+                             struct overlay_draw *draw,
+                             ImDrawData *draw_data)
 {
-   ImDrawData* draw_data = ImGui::GetDrawData();
    struct device_data *device_data = data->device;
 
-   if (!draw_data || draw_data->TotalVtxCount == 0 || get_params()->no_display)
-      return nullptr;
-
-   struct overlay_draw *draw = get_overlay_draw(data, image_index);
-
-   device_data->vtable.ResetCommandBuffer(draw->command_buffer, 0);
-
-   VkRenderPassBeginInfo render_pass_info = {};
-   render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-   render_pass_info.renderPass = data->render_pass;
-   render_pass_info.framebuffer = data->framebuffers[image_index];
-   render_pass_info.renderArea.extent.width = data->width;
-   render_pass_info.renderArea.extent.height = data->height;
-
-   VkCommandBufferBeginInfo buffer_begin_info = {};
-   buffer_begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-
-   device_data->vtable.BeginCommandBuffer(draw->command_buffer, &buffer_begin_info);
-
-   ensure_swapchain_fonts(data, draw->command_buffer);
+   /* Nothing to do if this image's buffers already hold the current draw
+    * data */
+   if (draw->uploaded_hud_build == data->hud_build)
+      return;
 
-   /* Bounce the image to display back to color attachment layout for
-    * rendering on top of it.
-    */
-   VkImageMemoryBarrier imb;
-   imb.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-   imb.pNext = nullptr;
-   imb.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-   imb.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-   imb.oldLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-   imb.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-   imb.image = data->images[image_index];
-   imb.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-   imb.subresourceRange.baseMipLevel = 0;
-   imb.subresourceRange.levelCount = 1;
-   imb.subresourceRange.baseArrayLayer = 0;
-   imb.subresourceRange.layerCount = 1;
-   imb.srcQueueFamilyIndex = present_queue->family_index;
-   imb.dstQueueFamilyIndex = device_data->graphic_queue->family_index;
-   device_data->vtable.CmdPipelineBarrier(draw->command_buffer,
-                                          VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT,
-                                          VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT,
-                                          0,          /* dependency flags */
-                                          0, nullptr, /* memory barriers */
-                                          0, nullptr, /* buffer memory barriers */
-                                          1, &imb);   /* image memory barriers */
+   /* Create/Resize vertex & index buffers */
+   size_t vertex_size = draw_data->TotalVtxCount * sizeof(ImDrawVert);
+   size_t index_size  = draw_data->TotalIdxCount * sizeof(ImDrawIdx);
+
+   if (draw->vertex_buffer_size < vertex_size) {
+      CreateOrResizeBuffer(device_data,
+                           &draw->vertex_buffer,
+                           &draw->vertex_buffer_mem,
+                           &draw->vertex_buffer_size,
+                           vertex_size,
+                           VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                           &draw->vertex_mapped);
+   }
 
-   device_data->vtable.CmdBeginRenderPass(draw->command_buffer, &render_pass_info,
-                                          VK_SUBPASS_CONTENTS_INLINE);
+   if (draw->index_buffer_size < index_size) {
+      CreateOrResizeBuffer(device_data,
+                           &draw->index_buffer,
+                           &draw->index_buffer_mem,
+                           &draw->index_buffer_size,
+                           index_size,
+                           VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+                           &draw->index_mapped);
+   }
 
-   /* Create/Resize vertex & index buffers */
-size_t vertex_size = draw_data->TotalVtxCount * sizeof(ImDrawVert);
-size_t index_size  = draw_data->TotalIdxCount * sizeof(ImDrawIdx);
+   /* Upload vertex & index data (persistent mapped) */
+   ImDrawVert* vtx_dst = static_cast<ImDrawVert*>(draw->vertex_mapped);
+   ImDrawIdx*  idx_dst = static_cast<ImDrawIdx*>(draw->index_mapped);
 
-if (draw->vertex_buffer_size < vertex_size) {
-   CreateOrResizeBuffer(device_data,
-                        &draw->vertex_buffer,
-                        &draw->vertex_buffer_mem,
-                        &draw->vertex_buffer_size,
-                        vertex_size,
-                        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-                        &draw->vertex_mapped);
-}
+   // 맵핑 실패 상태라면 그냥 그 프레임 HUD 스킵해도 됨
+   if (!vtx_dst || !idx_dst) {
+      SPDLOG_WARN("MangoHud: vertex/index buffer not mapped; skipping HUD draw");
+   } else {
+      for (int n = 0; n < draw_data->CmdListsCount; n++)
+      {
+         const ImDrawList* cmd_list = draw_data->CmdLists[n];
+         memcpy(vtx_dst, cmd_list->VtxBuffer.Data,
+                cmd_list->VtxBuffer.Size * sizeof(ImDrawVert));
+         memcpy(idx_dst, cmd_list->IdxBuffer.Data,
+                cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx));
+         vtx_dst += cmd_list->VtxBuffer.Size;
+         idx_dst += cmd_list->IdxBuffer.Size;
+      }
 
-if (draw->index_buffer_size < index_size) {
-   CreateOrResizeBuffer(device_data,
-                        &draw->index_buffer,
-                        &draw->index_buffer_mem,
-                        &draw->index_buffer_size,
-                        index_size,
-                        VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-                        &draw->index_mapped);
-}
-
-/* Upload vertex & index data (persistent mapped) */
-ImDrawVert* vtx_dst = static_cast<ImDrawVert*>(draw->vertex_mapped);
-ImDrawIdx*  idx_dst = static_cast<ImDrawIdx*>(draw->index_mapped);
-
-// 맵핑 실패 상태라면 그냥 그 프레임 HUD 스킵해도 됨
-if (!vtx_dst || !idx_dst) {
-   SPDLOG_WARN("MangoHud: vertex/index buffer not mapped; skipping HUD draw");
-} else {
-   for (int n = 0; n < draw_data->CmdListsCount; n++)
-   {
-      const ImDrawList* cmd_list = draw_data->CmdLists[n];
-      memcpy(vtx_dst, cmd_list->VtxBuffer.Data,
-             cmd_list->VtxBuffer.Size * sizeof(ImDrawVert));
-      memcpy(idx_dst, cmd_list->IdxBuffer.Data,
-             cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx));
-      vtx_dst += cmd_list->VtxBuffer.Size;
-      idx_dst += cmd_list->IdxBuffer.Size;
+      VkMappedMemoryRange range[2] = {};
+      range[0].sType  = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+      range[0].memory = draw->vertex_buffer_mem;
+      range[0].size   = VK_WHOLE_SIZE;
+      range[1].sType  = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+      range[1].memory = draw->index_buffer_mem;
+      range[1].size   = VK_WHOLE_SIZE;
+      VK_CHECK(device_data->vtable.FlushMappedMemoryRanges(device_data->device, 2, range));
+      // Unmap은 절대 하지 않는다.
+      draw->uploaded_hud_build = data->hud_build;
    }
-
-   VkMappedMemoryRange range[2] = {};
-   range[0].sType  = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-   range[0].memory = draw->vertex_buffer_mem;
-   range[0].size   = VK_WHOLE_SIZE;
-   range[1].sType  = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-   range[1].memory = draw->index_buffer_mem;
-   range[1].size   = VK_WHOLE_SIZE;
-   VK_CHECK(device_data->vtable.FlushMappedMemoryRanges(device_data->device, 2, range));
-   // Unmap은 절대 하지 않는다.
 }
 
+/* `target` is the part of the ImGui display the framebuffer covers: the
+ * whole swapchain image, or hud_image with its origin at hud_rect.offset.
+ */
+static void draw_imgui_lists(struct swapchain_data *data,
+                             struct overlay_draw *draw,
+                             ImDrawData *draw_data,
+                             const VkRect2D& target)
+{
+   struct device_data *device_data = data->device;
+
    /* Bind pipeline and descriptor sets */
    device_data->vtable.CmdBindPipeline(draw->command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, data->pipeline);
 
@@ -1106,8 +1373,8 @@ if (!vtx_dst || !idx_dst) {
    VkViewport viewport;
    viewport.x = 0;
    viewport.y = 0;
-   viewport.width = draw_data->DisplaySize.x;
-   viewport.height = draw_data->DisplaySize.y;
+   viewport.width = (float)target.extent.width;
+   viewport.height = (float)target.extent.height;
    viewport.minDepth = 0.0f;
    viewport.maxDepth = 1.0f;
    device_data->vtable.CmdSetViewport(draw->command_buffer, 0, 1, &viewport);
@@ -1115,16 +1382,15 @@ if (!vtx_dst || !idx_dst) {
 
    /* Setup scale and translation through push constants :
    *
-   * Our visible imgui space lies from draw_data->DisplayPos (top left) to
-   * draw_data->DisplayPos+data_data->DisplaySize (bottom right). DisplayMin
-   * is typically (0,0) for single viewport apps.
+   * Our visible imgui space lies from target.offset (top left) to
+   * target.offset+target.extent (bottom right).
    */
    float scale[2];
-   scale[0] = 2.0f / draw_data->DisplaySize.x;
-   scale[1] = 2.0f / draw_data->DisplaySize.y;
+   scale[0] = 2.0f / target.extent.width;
+   scale[1] = 2.0f / target.extent.height;
    float translate[2];
-   translate[0] = -1.0f - draw_data->DisplayPos.x * scale[0];
-   translate[1] = -1.0f - draw_data->DisplayPos.y * scale[1];
+   translate[0] = -1.0f - target.offset.x * scale[0];
+   translate[1] = -1.0f - target.offset.y * scale[1];
    device_data->vtable.CmdPushConstants(draw->command_buffer, data->pipeline_layout,
                                        VK_SHADER_STAGE_VERTEX_BIT,
                                        sizeof(float) * 0, sizeof(float) * 2, scale);
@@ -1132,10 +1398,24 @@ if (!vtx_dst || !idx_dst) {
                                        VK_SHADER_STAGE_VERTEX_BIT,
                                        sizeof(float) * 2, sizeof(float) * 2, translate);
 
+   float sdf[8] = {};
+   if (data->sw_stats.font_sdf) {
+      ImVec4 outline_color;
+      sdf[0] = font_sdf_spread;
+      sdf[1] = font_sdf_outline(device_data->instance->params, outline_color);
+      sdf[4] = outline_color.x;
+      sdf[5] = outline_color.y;
+      sdf[6] = outline_color.z;
+      sdf[7] = outline_color.w;
+   }
+   device_data->vtable.CmdPushConstants(draw->command_buffer, data->pipeline_layout,
+                                       VK_SHADER_STAGE_FRAGMENT_BIT,
+                                       sizeof(float) * 4, sizeof(sdf), sdf);
+
    // Render the command lists:
    int vtx_offset = 0;
    int idx_offset = 0;
-   ImVec2 display_pos = draw_data->DisplayPos;
+   ImVec2 display_pos((float)target.offset.x, (float)target.offset.y);
    for (int n = 0; n < draw_data->CmdListsCount; n++)
    {
       const ImDrawList* cmd_list = draw_data->CmdLists[n];
@@ -1162,6 +1442,455 @@ if (!vtx_dst || !idx_dst) {
       }
       vtx_offset += cmd_list->VtxBuffer.Size;
    }
+}
+
+/* hud_image keeps the HUD's coverage in its alpha channel. With fewer than
+ * 8 bits (A2R10G10B10 for HDR10, 565) the background and glyph edges would
+ * be rounded to a few levels, or made opaque.
+ */
+static bool format_has_8bit_alpha(VkFormat format)
+{
+   switch (format) {
+   case VK_FORMAT_R8G8B8A8_UNORM:
+   case VK_FORMAT_R8G8B8A8_SRGB:
+   case VK_FORMAT_B8G8R8A8_UNORM:
+   case VK_FORMAT_B8G8R8A8_SRGB:
+   case VK_FORMAT_A8B8G8R8_UNORM_PACK32:
+   case VK_FORMAT_A8B8G8R8_SRGB_PACK32:
+   case VK_FORMAT_R16G16B16A16_UNORM:
+   case VK_FORMAT_R16G16B16A16_SFLOAT:
+   case VK_FORMAT_R32G32B32A32_SFLOAT:
+      return true;
+   default:
+      return false;
+   }
+}
+
+/* Render pass for drawing the HUD once per build and compositing it on
+ * every present (hud_retained). hud_image has the swapchain format so
+ * data->pipeline can draw into it as well, see resize_hud_image().
+ */
+static bool setup_hud_image(struct swapchain_data *data)
+{
+   struct device_data *device_data = data->device;
+
+   if (data->hud_render_pass)
+      return true;
+   if (data->hud_image_failed)
+      return false;
+
+   if (!format_has_8bit_alpha(data->format)) {
+      SPDLOG_DEBUG("Swapchain format {} has no 8-bit alpha, drawing the HUD directly", (int)data->format);
+      data->hud_image_failed = true;
+      return false;
+   }
+
+   VkFormatProperties format_props;
+   device_data->instance->vtable.GetPhysicalDeviceFormatProperties(device_data->physical_device,
+                                                                   data->format, &format_props);
+   VkFormatFeatureFlags features = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT |
+                                   VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BLEND_BIT;
+   if ((format_props.optimalTilingFeatures & features) != features) {
+      SPDLOG_DEBUG("Swapchain format {} can't be sampled, drawing the HUD directly", (int)data->format);
+      data->hud_image_failed = true;
+      return false;
+   }
+
+   /* Cleared on every build and left ready for sampling. Previous frames may
+    * still be compositing the old contents, hence the incoming dependency.
+    */
+   VkAttachmentDescription attachment_desc = {};
+   attachment_desc.format = data->format;
+   attachment_desc.samples = VK_SAMPLE_COUNT_1_BIT;
+   attachment_desc.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+   attachment_desc.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+   attachment_desc.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+   attachment_desc.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+   attachment_desc.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+   attachment_desc.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+   VkAttachmentReference color_attachment = {};
+   color_attachment.attachment = 0;
+   color_attachment.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+   VkSubpassDescription subpass = {};
+   subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+   subpass.colorAttachmentCount = 1;
+   subpass.pColorAttachments = &color_attachment;
+   VkSubpassDependency dependencies[2] = {};
+   dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+   dependencies[0].dstSubpass = 0;
+   dependencies[0].srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+   dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+   dependencies[0].srcAccessMask = 0;
+   dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+   dependencies[1].srcSubpass = 0;
+   dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+   dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+   dependencies[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+   dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+   dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+   VkRenderPassCreateInfo render_pass_info = {};
+   render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+   render_pass_info.attachmentCount = 1;
+   render_pass_info.pAttachments = &attachment_desc;
+   render_pass_info.subpassCount = 1;
+   render_pass_info.pSubpasses = &subpass;
+   render_pass_info.dependencyCount = 2;
+   render_pass_info.pDependencies = dependencies;
+   VK_CHECK(device_data->vtable.CreateRenderPass(device_data->device,
+                                                 &render_pass_info,
+                                                 NULL, &data->hud_render_pass));
+
+   return true;
+}
+
+/* Draws may still use them until their fences signal, see
+ * release_retired_images() */
+static void retire_hud_image(struct swapchain_data *data)
+{
+   retired_image hud = {};
+   hud.image = data->hud_image;
+   hud.image_view = data->hud_image_view;
+   hud.mem = data->hud_mem;
+   hud.framebuffer = data->hud_framebuffer;
+   hud.buffer = data->quad_buffer;
+   hud.buffer_mem = data->quad_buffer_mem;
+   hud.descriptor_set = data->hud_descriptor_set;
+   hud.submits = data->draw_submits;
+   data->retired_images.push_back(hud);
+
+   data->hud_image = VK_NULL_HANDLE;
+   data->hud_image_view = VK_NULL_HANDLE;
+   data->hud_mem = VK_NULL_HANDLE;
+   data->hud_framebuffer = VK_NULL_HANDLE;
+   data->quad_buffer = VK_NULL_HANDLE;
+   data->quad_buffer_mem = VK_NULL_HANDLE;
+   data->quad_buffer_size = 0;
+   // freeing the memory unmaps it
+   data->quad_mapped = nullptr;
+   data->hud_descriptor_set = VK_NULL_HANDLE;
+}
+
+/* HUD size changes by a few pixels as values change, grow in steps */
+static const uint32_t hud_image_align = 64;
+
+static uint32_t hud_image_size(uint32_t size, uint32_t current, uint32_t max)
+{
+   size = std::max(size, 1u);
+   if (size <= current)
+      return current;
+   return std::min((size + hud_image_align - 1) & ~(hud_image_align - 1), max);
+}
+
+/* Makes hud_image big enough for `rect`, it only ever grows. Its top left
+ * texel is drawn at hud_rect.offset, see render_hud_image().
+ */
+static void resize_hud_image(struct swapchain_data *data, const VkRect2D& rect)
+{
+   struct device_data *device_data = data->device;
+
+   VkExtent2D extent;
+   extent.width = hud_image_size(rect.extent.width, data->hud_image_extent.width, data->width);
+   extent.height = hud_image_size(rect.extent.height, data->hud_image_extent.height, data->height);
+   if (data->hud_image && extent.width == data->hud_image_extent.width &&
+       extent.height == data->hud_image_extent.height)
+      return;
+
+   if (data->hud_image) {
+      SPDLOG_DEBUG("Growing HUD image to {}x{}", extent.width, extent.height);
+      // draws in flight keep compositing the old image
+      reserve_retired_set(data);
+      retire_hud_image(data);
+   }
+   data->hud_image_extent = extent;
+
+   data->hud_descriptor_set =
+      create_image_with_desc(data, extent.width, extent.height, data->format,
+                             data->hud_image, data->hud_mem, data->hud_image_view,
+                             VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT);
+
+   VkFramebufferCreateInfo fb_info = {};
+   fb_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+   fb_info.renderPass = data->hud_render_pass;
+   fb_info.attachmentCount = 1;
+   fb_info.pAttachments = &data->hud_image_view;
+   fb_info.width = extent.width;
+   fb_info.height = extent.height;
+   fb_info.layers = 1;
+   VK_CHECK(device_data->vtable.CreateFramebuffer(device_data->device, &fb_info,
+                                                  NULL, &data->hud_framebuffer));
+
+   /* One quad the size of the image, placed at hud_rect and cut to it by
+    * composite_hud_image(). Written once, so it can be shared by all in
+    * flight draws.
+    */
+   const float w = (float)extent.width, h = (float)extent.height;
+   const ImDrawVert quad_vtx[4] = {
+      { ImVec2(0, 0), ImVec2(0, 0), IM_COL32_WHITE },
+      { ImVec2(w, 0), ImVec2(1, 0), IM_COL32_WHITE },
+      { ImVec2(w, h), ImVec2(1, 1), IM_COL32_WHITE },
+      { ImVec2(0, h), ImVec2(0, 1), IM_COL32_WHITE },
+   };
+   const ImDrawIdx quad_idx[6] = { 0, 1, 2, 0, 2, 3 };
+   CreateOrResizeBuffer(device_data,
+                        &data->quad_buffer,
+                        &data->quad_buffer_mem,
+                        &data->quad_buffer_size,
+                        sizeof(quad_vtx) + sizeof(quad_idx),
+                        (VkBufferUsageFlagBits)(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+                                                VK_BUFFER_USAGE_INDEX_BUFFER_BIT),
+                        &data->quad_mapped);
+   memcpy(data->quad_mapped, quad_vtx, sizeof(quad_vtx));
+   memcpy((char *)data->quad_mapped + sizeof(quad_vtx), quad_idx, sizeof(quad_idx));
+   VkMappedMemoryRange range = {};
+   range.sType  = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+   range.memory = data->quad_buffer_mem;
+   range.size   = VK_WHOLE_SIZE;
+   VK_CHECK(device_data->vtable.FlushMappedMemoryRanges(device_data->device, 1, &range));
+}
+
+static void shutdown_hud_image(struct swapchain_data *data)
+{
+   struct device_data *device_data = data->device;
+
+   if (!data->hud_render_pass)
+      return;
+
+   if (data->quad_mapped)
+      device_data->vtable.UnmapMemory(device_data->device, data->quad_buffer_mem);
+   device_data->vtable.DestroyBuffer(device_data->device, data->quad_buffer, NULL);
+   device_data->vtable.FreeMemory(device_data->device, data->quad_buffer_mem, NULL);
+   device_data->vtable.DestroyFramebuffer(device_data->device, data->hud_framebuffer, NULL);
+   device_data->vtable.DestroyImageView(device_data->device, data->hud_image_view, NULL);
+   device_data->vtable.DestroyImage(device_data->device, data->hud_image, NULL);
+   device_data->vtable.FreeMemory(device_data->device, data->hud_mem, NULL);
+   device_data->vtable.DestroyRenderPass(device_data->device, data->hud_render_pass, NULL);
+}
+
+/* Everything ImGui drew is inside the windows' clip rectangles, the union
+ * of which is clamped to the swapchain. Empty if nothing is drawn.
+ */
+static VkRect2D draw_data_rect(struct swapchain_data *data, ImDrawData *draw_data)
+{
+   ImVec2 min(data->width, data->height), max(0, 0);
+   for (int n = 0; n < draw_data->CmdListsCount; n++) {
+      const ImDrawList* cmd_list = draw_data->CmdLists[n];
+      for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; cmd_i++) {
+         const ImVec4& clip = cmd_list->CmdBuffer[cmd_i].ClipRect;
+         min = ImVec2(std::min(min.x, clip.x), std::min(min.y, clip.y));
+         max = ImVec2(std::max(max.x, clip.z), std::max(max.y, clip.w + 1));
+      }
+   }
+   min = ImVec2(std::max(min.x, 0.f), std::max(min.y, 0.f));
+   max = ImVec2(std::min(max.x, (float)data->width), std::min(max.y, (float)data->height));
+
+   VkRect2D rect;
+   rect.offset.x = (int32_t)min.x;
+   rect.offset.y = (int32_t)min.y;
+   rect.extent.width = max.x > min.x ? (uint32_t)(max.x - min.x) : 0;
+   rect.extent.height = max.y > min.y ? (uint32_t)(max.y - min.y) : 0;
+   return rect;
+}
+
+/* Render passes only load, clear and store their render area, which may
+ * not be empty. A HUD drawing nothing still gets the top left pixel.
+ */
+static VkRect2D hud_render_area(const VkRect2D& rect)
+{
+   if (rect.extent.width && rect.extent.height)
+      return rect;
+
+   VkRect2D area = {};
+   area.extent.width = 1;
+   area.extent.height = 1;
+   return area;
+}
+
+/* Draws the current ImGui draw data into hud_image, outside of the
+ * swapchain render pass */
+static void render_hud_image(struct swapchain_data *data,
+                             struct overlay_draw *draw,
+                             ImDrawData *draw_data)
+{
+   struct device_data *device_data = data->device;
+
+   upload_draw_data(data, draw, draw_data);
+   data->hud_rect = draw_data_rect(data, draw_data);
+   resize_hud_image(data, data->hud_rect);
+
+   /* hud_rect.offset is the image's origin */
+   VkRect2D image_rect = {};
+   image_rect.extent = data->hud_rect.extent;
+
+   VkClearValue clear = {};
+   VkRenderPassBeginInfo render_pass_info = {};
+   render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+   render_pass_info.renderPass = data->hud_render_pass;
+   render_pass_info.framebuffer = data->hud_framebuffer;
+   render_pass_info.renderArea = hud_render_area(image_rect);
+   render_pass_info.clearValueCount = 1;
+   render_pass_info.pClearValues = &clear;
+   device_data->vtable.CmdBeginRenderPass(draw->command_buffer, &render_pass_info,
+                                          VK_SUBPASS_CONTENTS_INLINE);
+   VkRect2D target = {};
+   target.offset = data->hud_rect.offset;
+   target.extent = data->hud_image_extent;
+   draw_imgui_lists(data, draw, draw_data, target);
+   device_data->vtable.CmdEndRenderPass(draw->command_buffer);
+
+   data->hud_image_build = data->hud_build;
+}
+
+/* One textured quad over hud_rect, inside the swapchain render pass */
+static void composite_hud_image(struct swapchain_data *data,
+                                struct overlay_draw *draw)
+{
+   struct device_data *device_data = data->device;
+
+   if (!data->hud_rect.extent.width || !data->hud_rect.extent.height)
+      return;
+
+   device_data->vtable.CmdBindPipeline(draw->command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, data->composite_pipeline);
+   device_data->vtable.CmdBindDescriptorSets(draw->command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                             data->pipeline_layout, 0, 1, &data->hud_descriptor_set, 0, NULL);
+
+   VkDeviceSize vertex_offset = 0;
+   device_data->vtable.CmdBindVertexBuffers(draw->command_buffer, 0, 1, &data->quad_buffer, &vertex_offset);
+   device_data->vtable.CmdBindIndexBuffer(draw->command_buffer, data->quad_buffer,
+                                          4 * sizeof(ImDrawVert), VK_INDEX_TYPE_UINT16);
+
+   VkViewport viewport = {};
+   viewport.width = (float)data->width;
+   viewport.height = (float)data->height;
+   viewport.maxDepth = 1.0f;
+   device_data->vtable.CmdSetViewport(draw->command_buffer, 0, 1, &viewport);
+   device_data->vtable.CmdSetScissor(draw->command_buffer, 0, 1, &data->hud_rect);
+
+   float scale_translate[4] = {
+      2.0f / data->width, 2.0f / data->height,
+      -1.0f + 2.0f * data->hud_rect.offset.x / data->width,
+      -1.0f + 2.0f * data->hud_rect.offset.y / data->height
+   };
+   device_data->vtable.CmdPushConstants(draw->command_buffer, data->pipeline_layout,
+                                        VK_SHADER_STAGE_VERTEX_BIT,
+                                        0, sizeof(scale_translate), scale_translate);
+
+   device_data->vtable.CmdDrawIndexed(draw->command_buffer, 6, 1, 0, 0, 0);
+}
+
+/* Compositing only saves work while the HUD is reused. Graphs changing on
+ * every frame (frame_timing) rebuild it on most presents, where the extra
+ * pass costs more than drawing directly. Decided per window of presents,
+ * switching back only once rebuilds are rare again.
+ */
+static const uint32_t hud_direct_window = 120;
+
+static bool hud_image_pays_off(struct swapchain_data *data)
+{
+   if (data->hud_window_build != data->hud_build) {
+      data->hud_window_build = data->hud_build;
+      data->hud_window_builds++;
+   }
+
+   if (++data->hud_window_presents >= hud_direct_window) {
+      uint32_t builds = data->hud_window_builds;
+      bool direct = data->hud_direct ? builds * 4 > hud_direct_window :
+                                       builds * 2 > hud_direct_window;
+      if (direct != data->hud_direct)
+         SPDLOG_DEBUG("HUD rebuilt on {} of {} presents, {}", builds, hud_direct_window,
+                      direct ? "drawing it directly" : "compositing hud_image");
+      data->hud_direct = direct;
+      data->hud_window_presents = 0;
+      data->hud_window_builds = 0;
+   }
+
+   return !data->hud_direct;
+}
+
+static struct overlay_draw *render_swapchain_display(struct swapchain_data *data,
+                                                     struct queue_data *present_queue,
+                                                     const VkSemaphore *wait_semaphores,
+                                                     unsigned n_wait_semaphores,
+                                                     unsigned image_index)
+{
+   ImDrawData* draw_data = ImGui::GetDrawData();
+   struct device_data *device_data = data->device;
+
+   if (!draw_data || draw_data->TotalVtxCount == 0 || get_params()->no_display)
+      return nullptr;
+
+   struct overlay_draw *draw = get_overlay_draw(data);
+
+   /* Drawing on the present queue itself orders the overlay after the
+    * application's rendering, so a single submission is enough. Only when
+    * the present queue is from another family do we draw on our graphics
+    * queue and, if the application does not provide a semaphore to
+    * vkQueuePresent, insert our own cross engine synchronization
+    * semaphore.
+    */
+   struct queue_data *submit_queue =
+      present_queue->family_index == device_data->graphic_queue->family_index ?
+      present_queue : device_data->graphic_queue;
+
+   device_data->vtable.ResetCommandBuffer(draw->command_buffer, 0);
+
+   VkRenderPassBeginInfo render_pass_info = {};
+   render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+   render_pass_info.renderPass = data->render_pass;
+   render_pass_info.framebuffer = data->framebuffers[image_index];
+
+   VkCommandBufferBeginInfo buffer_begin_info = {};
+   buffer_begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+
+   device_data->vtable.BeginCommandBuffer(draw->command_buffer, &buffer_begin_info);
+
+   ensure_swapchain_fonts(data, draw->command_buffer, submit_queue->queue);
+
+   bool use_hud_image = get_params()->enabled[OVERLAY_PARAM_ENABLED_hud_retained] &&
+                        hud_image_pays_off(data) && setup_hud_image(data);
+   if (use_hud_image && data->hud_image_build != data->hud_build)
+      render_hud_image(data, draw, draw_data);
+
+   /* Bounce the image to display back to color attachment layout for
+    * rendering on top of it.
+    */
+   VkImageMemoryBarrier imb;
+   imb.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+   imb.pNext = nullptr;
+   imb.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+   imb.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+   imb.oldLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+   imb.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+   imb.image = data->images[image_index];
+   imb.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+   imb.subresourceRange.baseMipLevel = 0;
+   imb.subresourceRange.levelCount = 1;
+   imb.subresourceRange.baseArrayLayer = 0;
+   imb.subresourceRange.layerCount = 1;
+   imb.srcQueueFamilyIndex = present_queue->family_index;
+   imb.dstQueueFamilyIndex = device_data->graphic_queue->family_index;
+   device_data->vtable.CmdPipelineBarrier(draw->command_buffer,
+                                          VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT,
+                                          VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT,
+                                          0,          /* dependency flags */
+                                          0, nullptr, /* memory barriers */
+                                          0, nullptr, /* buffer memory barriers */
+                                          1, &imb);   /* image memory barriers */
+
+   /* Only load and store the pixels under the HUD */
+   render_pass_info.renderArea =
+      hud_render_area(use_hud_image ? data->hud_rect : draw_data_rect(data, draw_data));
+   device_data->vtable.CmdBeginRenderPass(draw->command_buffer, &render_pass_info,
+                                          VK_SUBPASS_CONTENTS_INLINE);
+
+   if (use_hud_image) {
+      composite_hud_image(data, draw);
+   } else {
+      VkRect2D target = {};
+      target.extent.width = data->width;
+      target.extent.height = data->height;
+      upload_draw_data(data, draw, draw_data);
+      draw_imgui_lists(data, draw, draw_data, target);
+   }
 
    device_data->vtable.CmdEndRenderPass(draw->command_buffer);
 
@@ -1195,12 +1924,10 @@ if (!vtx_dst || !idx_dst) {
 
    device_data->vtable.EndCommandBuffer(draw->command_buffer);
 
-   /* When presenting on a different queue than where we're drawing the
-    * overlay *AND* when the application does not provide a semaphore to
-    * vkQueuePresent, insert our own cross engine synchronization
-    * semaphore.
-    */
-   if (n_wait_semaphores == 0 && device_data->graphic_queue->queue != present_queue->queue) {
+   draw->submit = ++data->draw_submits;
+   draw->queue = submit_queue->queue;
+
+   if (n_wait_semaphores == 0 && submit_queue != present_queue) {
       VkPipelineStageFlags stages_wait = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
       VkSubmitInfo submit_info = {};
       submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
@@ -1208,7 +1935,7 @@ if (!vtx_dst || !idx_dst) {
       submit_info.pWaitDstStageMask = &stages_wait;
       submit_info.waitSemaphoreCount = 0;
       submit_info.signalSemaphoreCount = 1;
-      submit_info.pSignalSemaphores = &draw->cross_engine_semaphore;
+      submit_info.pSignalSemaphores = &data->cross_engine_semaphores[image_index];
 
       device_data->vtable.QueueSubmit(present_queue->queue, 1, &submit_info, VK_NULL_HANDLE);
 
@@ -1217,26 +1944,27 @@ if (!vtx_dst || !idx_dst) {
       submit_info.pWaitDstStageMask = &stages_wait;
       submit_info.pCommandBuffers = &draw->command_buffer;
       submit_info.waitSemaphoreCount = 1;
-      submit_info.pWaitSemaphores = &draw->cross_engine_semaphore;
+      submit_info.pWaitSemaphores = &data->cross_engine_semaphores[image_index];
       submit_info.signalSemaphoreCount = 1;
-      submit_info.pSignalSemaphores = &draw->semaphore;
+      submit_info.pSignalSemaphores = &data->present_semaphores[image_index];
 
       device_data->vtable.QueueSubmit(device_data->graphic_queue->queue, 1, &submit_info, draw->fence);
    } else {
       // wait in the fragment stage until the swapchain image is ready
-      std::vector<VkPipelineStageFlags> stages_wait(n_wait_semaphores, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+      if (data->wait_stages.size() < n_wait_semaphores)
+         data->wait_stages.resize(n_wait_semaphores, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
 
       VkSubmitInfo submit_info = {};
       submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
       submit_info.commandBufferCount = 1;
       submit_info.pCommandBuffers = &draw->command_buffer;
-      submit_info.pWaitDstStageMask = stages_wait.data();
+      submit_info.pWaitDstStageMask = data->wait_stages.data();
       submit_info.waitSemaphoreCount = n_wait_semaphores;
       submit_info.pWaitSemaphores = wait_semaphores;
       submit_info.signalSemaphoreCount = 1;
-      submit_info.pSignalSemaphores = &draw->semaphore;
+      submit_info.pSignalSemaphores = &data->present_semaphores[image_index];
 
-      device_data->vtable.QueueSubmit(device_data->graphic_queue->queue, 1, &submit_info, draw->fence);
+      device_data->vtable.QueueSubmit(submit_queue->queue, 1, &submit_info, draw->fence);
    }
 
    return draw;
@@ -1248,11 +1976,14 @@ static const uint32_t overlay_vert_spv[] = {
 static const uint32_t overlay_frag_spv[] = {
 #include "overlay.frag.spv.h"
 };
+static const uint32_t overlay_composite_frag_spv[] = {
+#include "overlay_composite.frag.spv.h"
+};
 
 static void setup_swapchain_data_pipeline(struct swapchain_data *data)
 {
    struct device_data *device_data = data->device;
-   VkShaderModule vert_module, frag_module;
+   VkShaderModule vert_module, frag_module, composite_frag_module;
 
    /* Create shader modules */
    VkShaderModuleCreateInfo vert_info = {};
@@ -1267,6 +1998,10 @@ static void setup_swapchain_data_pipeline(struct swapchain_data *data)
    frag_info.pCode = (uint32_t*)overlay_frag_spv;
    VK_CHECK(device_data->vtable.CreateShaderModule(device_data->device,
                                                    &frag_info, NULL, &frag_module));
+   frag_info.codeSize = sizeof(overlay_composite_frag_spv);
+   frag_info.pCode = overlay_composite_frag_spv;
+   VK_CHECK(device_data->vtable.CreateShaderModule(device_data->device,
+                                                   &frag_info, NULL, &composite_frag_module));
 
    /* Font sampler */
    VkSamplerCreateInfo sampler_info = {};
@@ -1286,10 +2021,12 @@ static void setup_swapchain_data_pipeline(struct swapchain_data *data)
    /* Descriptor pool */
    VkDescriptorPoolSize sampler_pool_size = {};
    sampler_pool_size.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-   sampler_pool_size.descriptorCount = 1;
+   /* font, hud_image and the retired images */
+   sampler_pool_size.descriptorCount = 2 + max_retired_images;
    VkDescriptorPoolCreateInfo desc_pool_info = {};
    desc_pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-   desc_pool_info.maxSets = 1;
+   desc_pool_info.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+   desc_pool_info.maxSets = 2 + max_retired_images;
    desc_pool_info.poolSizeCount = 1;
    desc_pool_info.pPoolSizes = &sampler_pool_size;
    VK_CHECK(device_data->vtable.CreateDescriptorPool(device_data->device,
@@ -1326,15 +2063,19 @@ static void setup_swapchain_data_pipeline(struct swapchain_data *data)
    /* Constants: we are using 'vec2 offset' and 'vec2 scale' instead of a full
     * 3d projection matrix
     */
-   VkPushConstantRange push_constants[1] = {};
+   VkPushConstantRange push_constants[2] = {};
    push_constants[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
    push_constants[0].offset = sizeof(float) * 0;
    push_constants[0].size = sizeof(float) * 4;
+   /* font_sdf: spread, outline thickness, padding, outline color */
+   push_constants[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+   push_constants[1].offset = sizeof(float) * 4;
+   push_constants[1].size = sizeof(float) * 8;
    VkPipelineLayoutCreateInfo layout_info = {};
    layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
    layout_info.setLayoutCount = 1;
    layout_info.pSetLayouts = &data->descriptor_layout;
-   layout_info.pushConstantRangeCount = 1;
+   layout_info.pushConstantRangeCount = 2;
    layout_info.pPushConstantRanges = push_constants;
    VK_CHECK(device_data->vtable.CreatePipelineLayout(device_data->device,
                                                      &layout_info,
@@ -1435,13 +2176,26 @@ static void setup_swapchain_data_pipeline(struct swapchain_data *data)
    info.pDynamicState = &dynamic_state;
    info.layout = data->pipeline_layout;
    info.renderPass = data->render_pass;
+   if (device_data->pipeline_cache == VK_NULL_HANDLE)
+      setup_pipeline_cache(device_data);
    VK_CHECK(
-      device_data->vtable.CreateGraphicsPipelines(device_data->device, VK_NULL_HANDLE,
+      device_data->vtable.CreateGraphicsPipelines(device_data->device, device_data->pipeline_cache,
                                                   1, &info,
                                                   NULL, &data->pipeline));
 
+   /* hud_image holds premultiplied colors: data->pipeline blending into a
+    * cleared image gives color * alpha */
+   stage[1].module = composite_frag_module;
+   color_attachment[0].srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+   VK_CHECK(
+      device_data->vtable.CreateGraphicsPipelines(device_data->device, device_data->pipeline_cache,
+                                                  1, &info,
+                                                  NULL, &data->composite_pipeline));
+   save_pipeline_cache(device_data);
+
    device_data->vtable.DestroyShaderModule(device_data->device, vert_module, NULL);
    device_data->vtable.DestroyShaderModule(device_data->device, frag_module, NULL);
+   device_data->vtable.DestroyShaderModule(device_data->device, composite_frag_module, NULL);
 
    check_fonts(data);
 
@@ -1624,6 +2378,18 @@ static void setup_swapchain_data(struct swapchain_data *data,
                                                      NULL, &data->framebuffers[i]));
    }
 
+   /* Present semaphores */
+   VkSemaphoreCreateInfo sem_info = {};
+   sem_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+   data->present_semaphores.resize(n_images);
+   data->cross_engine_semaphores.resize(n_images);
+   for (size_t i = 0; i < data->images.size(); i++) {
+      VK_CHECK(device_data->vtable.CreateSemaphore(device_data->device, &sem_info,
+                                                   NULL, &data->present_semaphores[i]));
+      VK_CHECK(device_data->vtable.CreateSemaphore(device_data->device, &sem_info,
+                                                   NULL, &data->cross_engine_semaphores[i]));
+   }
+
    /* Command buffer pool */
    VkCommandPoolCreateInfo cmd_buffer_pool_info = {};
    cmd_buffer_pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
@@ -1652,6 +2418,8 @@ static void shutdown_swapchain_data(struct swapchain_data *data)
 {
    struct device_data *device_data = data->device;
 
+   SPDLOG_DEBUG("Swapchain used {} overlay draws, waited for one {} times",
+                data->draws.size(), data->draw_waits);
    for (auto draw : data->draws) {
       if (!draw) continue;
    
@@ -1665,8 +2433,6 @@ static void shutdown_swapchain_data(struct swapchain_data *data)
          draw->index_mapped = nullptr;
       }
       device_data->vtable.FreeCommandBuffers(device_data->device, data->command_pool, 1, &draw->command_buffer);
-      device_data->vtable.DestroySemaphore(device_data->device, draw->cross_engine_semaphore, NULL);
-      device_data->vtable.DestroySemaphore(device_data->device, draw->semaphore, NULL);
       device_data->vtable.DestroyFence(device_data->device, draw->fence, NULL);
       device_data->vtable.DestroyBuffer(device_data->device, draw->vertex_buffer, NULL);
       device_data->vtable.DestroyBuffer(device_data->device, draw->index_buffer, NULL);
@@ -1678,17 +2444,28 @@ static void shutdown_swapchain_data(struct swapchain_data *data)
    for (size_t i = 0; i < data->images.size(); i++) {
       device_data->vtable.DestroyImageView(device_data->device, data->image_views[i], NULL);
       device_data->vtable.DestroyFramebuffer(device_data->device, data->framebuffers[i], NULL);
+      device_data->vtable.DestroySemaphore(device_data->device, data->present_semaphores[i], NULL);
+      device_data->vtable.DestroySemaphore(device_data->device, data->cross_engine_semaphores[i], NULL);
    }
 
    device_data->vtable.DestroyRenderPass(device_data->device, data->render_pass, NULL);
 
    device_data->vtable.DestroyCommandPool(device_data->device, data->command_pool, NULL);
 
+   shutdown_hud_image(data);
+
    device_data->vtable.DestroyPipeline(device_data->device, data->pipeline, NULL);
+   device_data->vtable.DestroyPipeline(device_data->device, data->composite_pipeline, NULL);
    device_data->vtable.DestroyPipelineLayout(device_data->device, data->pipeline_layout, NULL);
 
    device_data->vtable.DestroyDescriptorPool(device_data->device,
                                              data->descriptor_pool, NULL);
+   // their descriptor sets went with descriptor_pool
+   for (auto& retired : data->retired_images) {
+      retired.descriptor_set = VK_NULL_HANDLE;
+      destroy_retired_image(data, retired);
+   }
+   data->retired_images.clear();
    device_data->vtable.DestroyDescriptorSetLayout(device_data->device,
                                                   data->descriptor_layout, NULL);
 
@@ -1864,17 +2641,19 @@ static VkResult overlay_QueuePresentKHR(
       present_info.pSwapchains = &swapchain;
       present_info.pImageIndices = &image_index;
 
-#if defined(__ANDROID__)
-      if (device_data->android_gpu_ctx && i == 0) {
-         android_gpu_usage_on_present(
-            device_data->android_gpu_ctx,
-            queue,
-            queue_data->family_index,
-            &present_info,
-            i,
-            image_index);
+      if (i == 0) {
+         for (auto q : device_data->queues) {
+            if (!q->gpu_usage_ctx)
+               continue;
+            vk_gpu_usage_on_present(
+               q->gpu_usage_ctx,
+               q->queue,
+               q->family_index,
+               &present_info,
+               i,
+               image_index);
+         }
       }
-#endif
 
       struct overlay_draw *draw = before_present(swapchain_data,
                                                    queue_data,
@@ -1883,7 +2662,7 @@ static VkResult overlay_QueuePresentKHR(
                                                    image_index);
 
       if (draw) {
-         present_info.pWaitSemaphores = &draw->semaphore;
+         present_info.pWaitSemaphores = &swapchain_data->present_semaphores[image_index];
          present_info.waitSemaphoreCount = 1;
       }
 
@@ -1900,94 +2679,6 @@ static VkResult overlay_QueuePresentKHR(
    return result;
 }
 
-static VkResult overlay_BeginCommandBuffer(
-    VkCommandBuffer                             commandBuffer,
-    const VkCommandBufferBeginInfo*             pBeginInfo)
-{
-   struct command_buffer_data *cmd_buffer_data =
-      FIND(struct command_buffer_data, commandBuffer);
-   struct device_data *device_data = cmd_buffer_data->device;
-
-   /* Otherwise record a begin query as first command. */
-   VkResult result = device_data->vtable.BeginCommandBuffer(commandBuffer, pBeginInfo);
-
-   return result;
-}
-
-static VkResult overlay_EndCommandBuffer(
-    VkCommandBuffer                             commandBuffer)
-{
-   struct command_buffer_data *cmd_buffer_data =
-      FIND(struct command_buffer_data, commandBuffer);
-   struct device_data *device_data = cmd_buffer_data->device;
-
-   return device_data->vtable.EndCommandBuffer(commandBuffer);
-}
-
-static VkResult overlay_ResetCommandBuffer(
-    VkCommandBuffer                             commandBuffer,
-    VkCommandBufferResetFlags                   flags)
-{
-   struct command_buffer_data *cmd_buffer_data =
-      FIND(struct command_buffer_data, commandBuffer);
-   struct device_data *device_data = cmd_buffer_data->device;
-
-   return device_data->vtable.ResetCommandBuffer(commandBuffer, flags);
-}
-
-static void overlay_CmdExecuteCommands(
-    VkCommandBuffer                             commandBuffer,
-    uint32_t                                    commandBufferCount,
-    const VkCommandBuffer*                      pCommandBuffers)
-{
-   struct command_buffer_data *cmd_buffer_data =
-      FIND(struct command_buffer_data, commandBuffer);
-   struct device_data *device_data = cmd_buffer_data->device;
-
-   device_data->vtable.CmdExecuteCommands(commandBuffer, commandBufferCount, pCommandBuffers);
-}
-
-static VkResult overlay_AllocateCommandBuffers(
-   VkDevice                           device,
-   const VkCommandBufferAllocateInfo* pAllocateInfo,
-   VkCommandBuffer*                   pCommandBuffers)
-{
-   struct device_data *device_data = FIND(struct device_data, device);
-   VkResult result =
-      device_data->vtable.AllocateCommandBuffers(device, pAllocateInfo, pCommandBuffers);
-   if (result != VK_SUCCESS)
-      return result;
-
-   for (uint32_t i = 0; i < pAllocateInfo->commandBufferCount; i++) {
-      new_command_buffer_data(pCommandBuffers[i], pAllocateInfo->level,
-                              device_data);
-   }
-
-   return result;
-}
-
-static void overlay_FreeCommandBuffers(
-   VkDevice               device,
-   VkCommandPool          commandPool,
-   uint32_t               commandBufferCount,
-   const VkCommandBuffer* pCommandBuffers)
-{
-   struct device_data *device_data = FIND(struct device_data, device);
-   for (uint32_t i = 0; i < commandBufferCount; i++) {
-      struct command_buffer_data *cmd_buffer_data =
-         FIND(struct command_buffer_data, pCommandBuffers[i]);
-
-      /* It is legal to free a NULL command buffer*/
-      if (!cmd_buffer_data)
-         continue;
-
-      destroy_command_buffer_data(cmd_buffer_data);
-   }
-
-   device_data->vtable.FreeCommandBuffers(device, commandPool,
-                                          commandBufferCount, pCommandBuffers);
-}
-
 static VkResult overlay_QueueSubmit(
     VkQueue                                     queue,
     uint32_t                                    submitCount,
@@ -1997,20 +2688,18 @@ static VkResult overlay_QueueSubmit(
    struct queue_data *queue_data = FIND(struct queue_data, queue);
    struct device_data *device_data = queue_data->device;
 
-#if defined(__ANDROID__)
-   if (device_data->android_gpu_ctx &&
+   if (queue_data->gpu_usage_ctx &&
        submitCount > 0 &&
-       (queue_data->flags & VK_QUEUE_GRAPHICS_BIT) &&
        has_cmd_buffers(pSubmits, submitCount)) {
 
-      const uint64_t now = android_vk_now_ns();
+      const uint64_t now = gpu_usage_now_ns();
 
       // interval 당 "한 번만" 계측. 나머지는 패스스루.
-      if (android_vk_try_tick(device_data->android_vk_next_submit_sample_ns,
-                              device_data->android_vk_interval_ns,
-                              now)) {
-         return android_gpu_usage_queue_submit(
-             device_data->android_gpu_ctx,
+      if (gpu_usage_try_tick(queue_data->gpu_usage_next_submit_ns,
+                             device_data->gpu_usage_interval_ns,
+                             now)) {
+         return vk_gpu_usage_queue_submit(
+             queue_data->gpu_usage_ctx,
              queue,
              queue_data->family_index,
              submitCount,
@@ -2018,7 +2707,6 @@ static VkResult overlay_QueueSubmit(
              fence);
       }
    }
-#endif
 
    return device_data->vtable.QueueSubmit(queue, submitCount, pSubmits, fence);
 }
@@ -2032,19 +2720,17 @@ static VkResult overlay_QueueSubmit2(
    struct queue_data *queue_data = FIND(struct queue_data, queue);
    struct device_data *device_data = queue_data->device;
 
-#if defined(__ANDROID__)
-   if (device_data->android_gpu_ctx &&
+   if (queue_data->gpu_usage_ctx &&
        submitCount > 0 &&
-       (queue_data->flags & VK_QUEUE_GRAPHICS_BIT) &&
        has_cmd_buffers2(pSubmits, submitCount)) {
 
-      const uint64_t now = android_vk_now_ns();
+      const uint64_t now = gpu_usage_now_ns();
 
-      if (android_vk_try_tick(device_data->android_vk_next_submit_sample_ns,
-                              device_data->android_vk_interval_ns,
-                              now)) {
-         return android_gpu_usage_queue_submit2(
-             device_data->android_gpu_ctx,
+      if (gpu_usage_try_tick(queue_data->gpu_usage_next_submit_ns,
+                             device_data->gpu_usage_interval_ns,
+                             now)) {
+         return vk_gpu_usage_queue_submit2(
+             queue_data->gpu_usage_ctx,
              queue,
              queue_data->family_index,
              submitCount,
@@ -2052,7 +2738,6 @@ static VkResult overlay_QueueSubmit2(
              fence);
       }
    }
-#endif
 
    // 기본 패스스루: CreateDevice시 한 번만 resolve한 포인터 사용
    PFN_vkQueueSubmit2    pfn2    = device_data->real_QueueSubmit2;
@@ -2104,24 +2789,56 @@ static VkResult overlay_CreateDevice(
 
    bool can_get_driver_info = instance_data->api_version < VK_API_VERSION_1_1 ? false : true;
 
-   // VK_KHR_driver_properties became core in 1.2
+   // VK_KHR_driver_properties became core in 1.2. It only extends
+   // vkGetPhysicalDeviceProperties2, so it doesn't need enabling on the device.
    if (instance_data->api_version < VK_API_VERSION_1_2 && can_get_driver_info) {
       for (auto& extension : available_extensions) {
-         if (extension.extensionName == std::string(VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME)) {
-            for (auto& enabled : enabled_extensions) {
-               if (enabled == std::string(VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME))
-                  goto DONT;
-            }
-            enabled_extensions.push_back(VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME);
-            DONT:
+         if (extension.extensionName == std::string(VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME))
             goto FOUND;
-         }
       }
       can_get_driver_info = false;
       FOUND:;
    }
 
-   VkResult result = fpCreateDevice(physicalDevice, pCreateInfo, pAllocator, pDevice);
+   // GPU 타임스탬프를 CLOCK_MONOTONIC 으로 옮길 수 있으면 같이 켠다 (선택 사항)
+   bool gpu_usage_enabled = gpu_usage_read_enabled(instance_data->params);
+   bool can_calibrate = false;
+   if (gpu_usage_enabled) {
+      auto fpGetTimeDomains = (PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT)
+         fpGetInstanceProcAddr(instance_data->instance, "vkGetPhysicalDeviceCalibrateableTimeDomainsEXT");
+
+      bool has_ext = false;
+      for (auto& extension : available_extensions)
+         if (extension.extensionName == std::string(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME))
+            has_ext = true;
+
+      if (has_ext && fpGetTimeDomains) {
+         uint32_t domain_count = 0;
+         fpGetTimeDomains(physicalDevice, &domain_count, nullptr);
+         std::vector<VkTimeDomainEXT> domains(domain_count);
+         fpGetTimeDomains(physicalDevice, &domain_count, domains.data());
+
+         bool has_device = false, has_monotonic = false;
+         for (auto domain : domains) {
+            has_device |= domain == VK_TIME_DOMAIN_DEVICE_EXT;
+            has_monotonic |= domain == VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT;
+         }
+         can_calibrate = has_device && has_monotonic;
+      }
+
+      if (can_calibrate &&
+          std::find_if(enabled_extensions.begin(), enabled_extensions.end(), [](const char* ext) {
+             return ext == std::string(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+          }) == enabled_extensions.end())
+         enabled_extensions.push_back(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+   }
+
+   // Only differs from the application's list by calibrated timestamps
+   VkDeviceCreateInfo create_info = *pCreateInfo;
+   create_info.enabledExtensionCount = enabled_extensions.size();
+   create_info.ppEnabledExtensionNames = enabled_extensions.data();
+
+   VkResult result = fpCreateDevice(physicalDevice, &create_info, pAllocator, pDevice);
    if (result != VK_SUCCESS) return result;
 
    struct device_data *device_data = new_device_data(*pDevice, instance_data);
@@ -2136,85 +2853,43 @@ static VkResult overlay_CreateDevice(
    device_data->real_QueueSubmit2KHR =
       (PFN_vkQueueSubmit2KHR) fpGetDeviceProcAddr(*pDevice, "vkQueueSubmit2KHR");
 
-#if defined(__ANDROID__)
-{
-    // 0) 정책: 기본 OFF (kgsl 기본이면 Vulkan 계측은 진짜 fallback)
-   device_data->android_vk_gpu_usage_enabled = android_vk_read_enabled();
-   
-   if (!device_data->android_vk_gpu_usage_enabled) {
-       device_data->android_vk_interval_ns = 100000000ull; // 100ms (의미없지만 기본값)
-       device_data->android_gpu_ctx = nullptr;
-   } else {
-       device_data->android_vk_interval_ns = android_vk_read_interval_ns();
-   
-       AndroidVkGpuDispatch disp{};
-
-        disp.QueueSubmit            = device_data->vtable.QueueSubmit;
-        disp.QueueSubmit2           = device_data->real_QueueSubmit2;
-        disp.QueueSubmit2KHR        = device_data->real_QueueSubmit2KHR;
-
-        disp.CreateQueryPool        = device_data->vtable.CreateQueryPool;
-        disp.DestroyQueryPool       = device_data->vtable.DestroyQueryPool;
-        disp.GetQueryPoolResults    = device_data->vtable.GetQueryPoolResults;
-
-        disp.CreateCommandPool      = device_data->vtable.CreateCommandPool;
-        disp.DestroyCommandPool     = device_data->vtable.DestroyCommandPool;
-        disp.ResetCommandPool       = device_data->vtable.ResetCommandPool;
-        disp.AllocateCommandBuffers = device_data->vtable.AllocateCommandBuffers;
-        disp.FreeCommandBuffers     = device_data->vtable.FreeCommandBuffers;
-        disp.BeginCommandBuffer     = device_data->vtable.BeginCommandBuffer;
-        disp.EndCommandBuffer       = device_data->vtable.EndCommandBuffer;
-
-        disp.CmdWriteTimestamp      = device_data->vtable.CmdWriteTimestamp;
-        disp.CmdResetQueryPool      = device_data->vtable.CmdResetQueryPool;
-        disp.CmdPipelineBarrier     = device_data->vtable.CmdPipelineBarrier;
-
-        float ts_ns = device_data->properties.limits.timestampPeriod;
-
-        uint32_t ts_valid_bits = 0;
-        uint32_t qf_count = 0;
-        instance_data->vtable.GetPhysicalDeviceQueueFamilyProperties(
-            device_data->physical_device, &qf_count, nullptr);
-
-        if (qf_count > 0) {
-            std::vector<VkQueueFamilyProperties> qf(qf_count);
-            instance_data->vtable.GetPhysicalDeviceQueueFamilyProperties(
-                device_data->physical_device, &qf_count, qf.data());
-
-            // graphics 큐 우선
-            for (uint32_t i = 0; i < qf_count; ++i) {
-                if (qf[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) {
-                    ts_valid_bits = qf[i].timestampValidBits;
-                    if (ts_valid_bits) break;
-                }
-            }
-            if (!ts_valid_bits) {
-                for (uint32_t i = 0; i < qf_count; ++i) {
-                    if (qf[i].timestampValidBits) {
-                        ts_valid_bits = qf[i].timestampValidBits;
-                        break;
-                    }
-                }
-            }
-        }
+   device_data->gpu_usage_enabled = gpu_usage_enabled;
+   device_data->gpu_usage_ts_period_ns = device_data->properties.limits.timestampPeriod;
+   if (device_data->gpu_usage_enabled && device_data->gpu_usage_ts_period_ns <= 0.0f) {
+      SPDLOG_WARN("Vulkan GPU usage: timestamps unsupported (timestampPeriod={})",
+                  device_data->gpu_usage_ts_period_ns);
+      device_data->gpu_usage_enabled = false;
+   }
 
-        if (ts_ns <= 0.0f || !ts_valid_bits) {
-            SPDLOG_WARN(
-                "Android GPU usage: Vulkan timestamp backend requested but unsupported "
-                "(timestampPeriod={}, validBits={})",
-                ts_ns, ts_valid_bits);
-            device_data->android_gpu_ctx = nullptr;
-        } else {
-            device_data->android_gpu_ctx =
-                android_gpu_usage_create(device_data->physical_device,
-                                         device_data->device,
-                                         ts_ns,
-                                         ts_valid_bits,
-                                         disp);
-        }
-    }
-}
-#endif
+   if (device_data->gpu_usage_enabled) {
+      device_data->gpu_usage_interval_ns = gpu_usage_read_interval_ns();
+
+      VulkanGpuUsageDispatch& disp = device_data->gpu_usage_disp;
+      disp.QueueSubmit            = device_data->vtable.QueueSubmit;
+      disp.QueueSubmit2           = device_data->real_QueueSubmit2;
+      disp.QueueSubmit2KHR        = device_data->real_QueueSubmit2KHR;
+
+      disp.CreateQueryPool        = device_data->vtable.CreateQueryPool;
+      disp.DestroyQueryPool       = device_data->vtable.DestroyQueryPool;
+      disp.GetQueryPoolResults    = device_data->vtable.GetQueryPoolResults;
+      disp.DeviceWaitIdle         = device_data->vtable.DeviceWaitIdle;
+
+      disp.CreateCommandPool      = device_data->vtable.CreateCommandPool;
+      disp.DestroyCommandPool     = device_data->vtable.DestroyCommandPool;
+      disp.ResetCommandPool       = device_data->vtable.ResetCommandPool;
+      disp.AllocateCommandBuffers = device_data->vtable.AllocateCommandBuffers;
+      disp.BeginCommandBuffer     = device_data->vtable.BeginCommandBuffer;
+      disp.EndCommandBuffer       = device_data->vtable.EndCommandBuffer;
+
+      disp.CmdWriteTimestamp      = device_data->vtable.CmdWriteTimestamp;
+      disp.CmdResetQueryPool      = device_data->vtable.CmdResetQueryPool;
+
+      disp.GetPhysicalDeviceQueueFamilyProperties =
+         instance_data->vtable.GetPhysicalDeviceQueueFamilyProperties;
+      if (can_calibrate)
+         disp.GetCalibratedTimestamps = (PFN_vkGetCalibratedTimestampsEXT)
+            fpGetDeviceProcAddr(*pDevice, "vkGetCalibratedTimestampsEXT");
+   }
 
    VkLayerDeviceCreateInfo *load_data_info =
       get_device_chain_info(pCreateInfo, VK_LOADER_DATA_CALLBACK);
@@ -2244,15 +2919,12 @@ static void overlay_DestroyDevice(
 {
    struct device_data *device_data = FIND(struct device_data, device);
 
-#if defined(__ANDROID__)
-   if (device_data->android_gpu_ctx) {
-      android_gpu_usage_destroy(device_data->android_gpu_ctx);
-      device_data->android_gpu_ctx = nullptr;
-   }
-#endif
-
    if (!is_blacklisted())
       device_unmap_queues(device_data);
+   if (device_data->pipeline_cache != VK_NULL_HANDLE) {
+      save_pipeline_cache(device_data);
+      device_data->vtable.DestroyPipelineCache(device, device_data->pipeline_cache, NULL);
+   }
    device_data->vtable.DestroyDevice(device, pAllocator);
    destroy_device_data(device_data);
 }
@@ -2447,21 +3119,36 @@ extern "C" VK_LAYER_EXPORT VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL overlay_GetD
 extern "C" VK_LAYER_EXPORT VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL overlay_GetInstanceProcAddr(VkInstance instance,
                                                                                const char *funcName);
 
+/* Device entrypoints that only do work for some features. A device that
+ * doesn't use the feature gets the next layer's pointer from
+ * vkGetDeviceProcAddr, so those calls don't go through the layer at all.
+ */
+enum hook_feature {
+   HOOK_ALWAYS,
+   HOOK_GPU_USAGE,   // timestamp queries around submits, see vk_gpu_usage.h
+};
+
+static bool device_uses_feature(const struct device_data *device_data, hook_feature feature)
+{
+   switch (feature) {
+   case HOOK_GPU_USAGE:
+      return device_data->gpu_usage_enabled;
+   default:
+      return true;
+   }
+}
+
 static const struct {
    const char *name;
    void *ptr;
+   hook_feature feature;
 } name_to_funcptr_map[] = {
-   { "vkGetInstanceProcAddr", (void *) overlay_GetInstanceProcAddr },
-   { "vkGetDeviceProcAddr", (void *) overlay_GetDeviceProcAddr },
-#define ADD_HOOK(fn) { "vk" # fn, (void *) overlay_ ## fn }
-#define ADD_ALIAS_HOOK(alias, fn) { "vk" # alias, (void *) overlay_ ## fn }
-   ADD_HOOK(AllocateCommandBuffers),
-   ADD_HOOK(FreeCommandBuffers),
-   ADD_HOOK(ResetCommandBuffer),
-   ADD_HOOK(BeginCommandBuffer),
-   ADD_HOOK(EndCommandBuffer),
-   ADD_HOOK(CmdExecuteCommands),
-
+   { "vkGetInstanceProcAddr", (void *) overlay_GetInstanceProcAddr, HOOK_ALWAYS },
+   { "vkGetDeviceProcAddr", (void *) overlay_GetDeviceProcAddr, HOOK_ALWAYS },
+#define ADD_HOOK(fn) { "vk" # fn, (void *) overlay_ ## fn, HOOK_ALWAYS }
+#define ADD_ALIAS_HOOK(alias, fn) { "vk" # alias, (void *) overlay_ ## fn, HOOK_ALWAYS }
+#define ADD_FEATURE_HOOK(fn, feature) { "vk" # fn, (void *) overlay_ ## fn, feature }
+#define ADD_FEATURE_ALIAS_HOOK(alias, fn, feature) { "vk" # alias, (void *) overlay_ ## fn, feature }
 #ifdef VK_USE_PLATFORM_WAYLAND_KHR
    ADD_HOOK(CreateWaylandSurfaceKHR),
    ADD_HOOK(DestroySurfaceKHR),
@@ -2471,9 +3158,9 @@ static const struct {
    ADD_HOOK(DestroySwapchainKHR),
    ADD_HOOK(CreateSampler),
 
-   ADD_HOOK(QueueSubmit),
-   ADD_HOOK(QueueSubmit2),
-   ADD_ALIAS_HOOK(QueueSubmit2KHR, QueueSubmit2),
+   ADD_FEATURE_HOOK(QueueSubmit, HOOK_GPU_USAGE),
+   ADD_FEATURE_HOOK(QueueSubmit2, HOOK_GPU_USAGE),
+   ADD_FEATURE_ALIAS_HOOK(QueueSubmit2KHR, QueueSubmit2, HOOK_GPU_USAGE),
 
    ADD_HOOK(CreateDevice),
    ADD_HOOK(DestroyDevice),
@@ -2481,9 +3168,14 @@ static const struct {
    ADD_HOOK(CreateInstance),
    ADD_HOOK(DestroyInstance),
 #undef ADD_HOOK
+#undef ADD_ALIAS_HOOK
+#undef ADD_FEATURE_HOOK
+#undef ADD_FEATURE_ALIAS_HOOK
 };
 
-static void *find_ptr(const char *name)
+/* `device_data` is null when the device isn't known yet, every hook is
+ * returned then and checks its feature itself */
+static void *find_ptr(const char *name, const struct device_data *device_data = nullptr)
 {
    // 블랙리스트라면 필요한 최소 VK 엔트리만 노출
    if (is_blacklisted()) {
@@ -2498,8 +3190,12 @@ static void *find_ptr(const char *name)
    }
 
    for (uint32_t i = 0; i < ARRAY_SIZE(name_to_funcptr_map); i++) {
-      if (strcmp(name, name_to_funcptr_map[i].name) == 0)
-         return name_to_funcptr_map[i].ptr;
+      if (strcmp(name, name_to_funcptr_map[i].name) != 0)
+         continue;
+
+      if (device_data && !device_uses_feature(device_data, name_to_funcptr_map[i].feature))
+         return NULL;
+      return name_to_funcptr_map[i].ptr;
    }
 
    return NULL;
@@ -2509,12 +3205,12 @@ extern "C" VK_LAYER_EXPORT VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL overlay_GetD
                                                                              const char *funcName)
 {
    init_spdlog();
-   void *ptr = find_ptr(funcName);
+   struct device_data *device_data = dev ? FIND(struct device_data, dev) : NULL;
+   void *ptr = find_ptr(funcName, device_data);
    if (ptr) return reinterpret_cast<PFN_vkVoidFunction>(ptr);
 
    if (dev == NULL) return NULL;
 
-   struct device_data *device_data = FIND(struct device_data, dev);
    if (device_data->vtable.GetDeviceProcAddr == NULL) return NULL;
    return device_data->vtable.GetDeviceProcAddr(dev, funcName);
 }
@@ -0,0 +1,100 @@
+// Minimal libnvidia-ml.so replacement so the NVML code can be tested
+// through libnvml_loader without NVIDIA hardware.
+#include <cstring>
+#include <vector>
+#include "nvml.h"
+
+static std::vector<nvmlSample_t> samples[NVML_SAMPLINGTYPE_COUNT];
+static std::vector<nvmlProcessUtilizationSample_t> process_samples;
+static bool samples_supported = true;
+
+extern "C" {
+
+/* Test controls, looked up with dlsym() */
+void nvml_stub_set_samples(nvmlSamplingType_t type, const nvmlSample_t* s, unsigned int count) {
+    samples[type].assign(s, s + count);
+}
+
+void nvml_stub_set_process_samples(const nvmlProcessUtilizationSample_t* s, unsigned int count) {
+    process_samples.assign(s, s + count);
+}
+
+void nvml_stub_set_samples_supported(bool supported) {
+    samples_supported = supported;
+}
+
+nvmlReturn_t nvmlDeviceGetSamples(nvmlDevice_t device, nvmlSamplingType_t type, unsigned long long lastSeenTimeStamp,
+                                  nvmlValueType_t *sampleValType, unsigned int *sampleCount, nvmlSample_t *out) {
+    if (!samples_supported)
+        return NVML_ERROR_NOT_SUPPORTED;
+    if (!sampleCount || type >= NVML_SAMPLINGTYPE_COUNT)
+        return NVML_ERROR_INVALID_ARGUMENT;
+
+    std::vector<nvmlSample_t> newer;
+    for (const auto& s : samples[type])
+        if (s.timeStamp > lastSeenTimeStamp)
+            newer.push_back(s);
+
+    if (newer.empty())
+        return NVML_ERROR_NOT_FOUND;
+
+    *sampleValType = NVML_VALUE_TYPE_UNSIGNED_INT;
+    if (!out) {
+        *sampleCount = newer.size();
+        return NVML_SUCCESS;
+    }
+
+    if (*sampleCount == 0)
+        return NVML_ERROR_INVALID_ARGUMENT;
+
+    if (*sampleCount > newer.size())
+        *sampleCount = newer.size();
+    memcpy(out, newer.data(), *sampleCount * sizeof(*out));
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetProcessUtilization(nvmlDevice_t device, nvmlProcessUtilizationSample_t *utilization,
+                                             unsigned int *processSamplesCount, unsigned long long lastSeenTimeStamp) {
+    if (!samples_supported)
+        return NVML_ERROR_NOT_SUPPORTED;
+
+    std::vector<nvmlProcessUtilizationSample_t> newer;
+    for (const auto& s : process_samples)
+        if (s.timeStamp > lastSeenTimeStamp)
+            newer.push_back(s);
+
+    if (!utilization) {
+        *processSamplesCount = newer.size();
+        return newer.empty() ? NVML_SUCCESS : NVML_ERROR_INSUFFICIENT_SIZE;
+    }
+
+    if (*processSamplesCount < newer.size())
+        return NVML_ERROR_INSUFFICIENT_SIZE;
+
+    *processSamplesCount = newer.size();
+    memcpy(utilization, newer.data(), newer.size() * sizeof(*utilization));
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlInit_v2(void) { return NVML_SUCCESS; }
+nvmlReturn_t nvmlShutdown(void) { return NVML_SUCCESS; }
+const char* nvmlErrorString(nvmlReturn_t result) { return "stub"; }
+
+nvmlReturn_t nvmlDeviceGetCount_v2(unsigned int *deviceCount) { *deviceCount = 1; return NVML_SUCCESS; }
+nvmlReturn_t nvmlDeviceGetHandleByIndex_v2(unsigned int index, nvmlDevice_t *device) { *device = nullptr; return NVML_SUCCESS; }
+nvmlReturn_t nvmlDeviceGetHandleByPciBusId_v2(const char *pciBusId, nvmlDevice_t *device) { *device = nullptr; return NVML_SUCCESS; }
+nvmlReturn_t nvmlDeviceGetPciInfo_v3(nvmlDevice_t device, nvmlPciInfo_t *pci) { return NVML_ERROR_NOT_SUPPORTED; }
+
+nvmlReturn_t nvmlDeviceGetUtilizationRates(nvmlDevice_t device, nvmlUtilization_t *utilization) { return NVML_ERROR_NOT_SUPPORTED; }
+nvmlReturn_t nvmlDeviceGetTemperature(nvmlDevice_t device, nvmlTemperatureSensors_t sensorType, unsigned int *temp) { return NVML_ERROR_NOT_SUPPORTED; }
+nvmlReturn_t nvmlDeviceGetMemoryInfo(nvmlDevice_t device, nvmlMemory_t *memory) { return NVML_ERROR_NOT_SUPPORTED; }
+nvmlReturn_t nvmlDeviceGetClockInfo(nvmlDevice_t device, nvmlClockType_t type, unsigned int *clock) { return NVML_ERROR_NOT_SUPPORTED; }
+nvmlReturn_t nvmlDeviceGetPowerUsage(nvmlDevice_t device, unsigned int *power) { return NVML_ERROR_NOT_SUPPORTED; }
+nvmlReturn_t nvmlDeviceGetPowerManagementLimit(nvmlDevice_t device, unsigned int *limit) { return NVML_ERROR_NOT_SUPPORTED; }
+nvmlReturn_t nvmlDeviceGetCurrentClocksThrottleReasons(nvmlDevice_t device, unsigned long long *reasons) { return NVML_ERROR_NOT_SUPPORTED; }
+nvmlReturn_t nvmlDeviceGetFanSpeed(nvmlDevice_t device, unsigned int *speed) { return NVML_ERROR_NOT_SUPPORTED; }
+nvmlReturn_t nvmlDeviceGetGraphicsRunningProcesses(nvmlDevice_t device, unsigned int *infoCount, nvmlProcessInfo_t *infos) { return NVML_ERROR_NOT_SUPPORTED; }
+nvmlReturn_t nvmlUnitGetHandleByIndex(unsigned int index, nvmlUnit_t *unit) { return NVML_ERROR_NOT_SUPPORTED; }
+nvmlReturn_t nvmlUnitGetFanSpeedInfo(nvmlUnit_t unit, nvmlUnitFanSpeeds_t *fanSpeeds) { return NVML_ERROR_NOT_SUPPORTED; }
+
+}
@@ -0,0 +1,183 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+extern "C" {
+#include <cmocka.h>
+}
+#include "stdio.h"
+#include "../src/amdgpu.h"
+
+#define UNUSED(x) (void)(x)
+
+static size_t read_fixture(const char *path, uint8_t *buf, size_t size) {
+    FILE *f = fopen(path, "rb");
+    if (!f)
+        return 0;
+
+    size_t nread = fread(buf, 1, size, f);
+    fclose(f);
+    return nread;
+}
+
+static void test_amdgpu_get_accumulators(void **state) {
+    UNUSED(state);
+    uint8_t buf[sizeof(struct gpu_metrics_v3_0)];
+    struct amdgpu_accumulators acc;
+    size_t nread;
+
+    // DGPU: energy and timestamp are valid, activity accumulators are not
+    nread = read_fixture("./gpu_metrics", buf, sizeof(buf));
+    assert_true(amdgpu_get_accumulators(buf, nread, &acc));
+    assert_true(acc.has_energy);
+    assert_true(acc.energy == 3284043806ull);
+    assert_true(acc.timestamp_ns == 819432827879538ull);
+    assert_false(acc.has_gfx_activity);
+    assert_false(acc.has_mem_activity);
+    assert_false(acc.has_throttle_residency);
+
+    // v2 APU tables don't have any
+    nread = read_fixture("./gpu_metrics_apu", buf, sizeof(buf));
+    assert_false(amdgpu_get_accumulators(buf, nread, &acc));
+
+    // truncated table
+    nread = read_fixture("./gpu_metrics", buf, sizeof(buf));
+    assert_false(amdgpu_get_accumulators(buf, 16, &acc));
+
+    // no timestamp, the energy alone is useless
+    struct gpu_metrics_v1_3 *v1 = (struct gpu_metrics_v1_3 *)buf;
+    v1->system_clock_counter = UINT64_MAX;
+    assert_false(amdgpu_get_accumulators(buf, nread, &acc));
+    assert_false(acc.has_energy);
+}
+
+static void test_amdgpu_get_accumulators_v3(void **state) {
+    UNUSED(state);
+    struct gpu_metrics_v3_0 v3 {};
+    struct amdgpu_accumulators acc;
+
+    v3.common_header.format_revision = 3;
+    v3.system_clock_counter = 1'000'000'000;
+    v3.throttle_residency_prochot = UINT32_MAX;
+    v3.throttle_residency_spl = UINT32_MAX;
+    v3.throttle_residency_fppt = UINT32_MAX;
+    v3.throttle_residency_sppt = UINT32_MAX;
+    v3.throttle_residency_thm_core = UINT32_MAX;
+    v3.throttle_residency_thm_gfx = UINT32_MAX;
+    v3.throttle_residency_thm_soc = UINT32_MAX;
+
+    // none of the residency counters are implemented
+    assert_false(amdgpu_get_accumulators(&v3, sizeof(v3), &acc));
+    assert_false(acc.has_throttle_residency);
+
+    v3.throttle_residency_spl = 10;
+    v3.throttle_residency_thm_gfx = 20;
+    assert_true(amdgpu_get_accumulators(&v3, sizeof(v3), &acc));
+    assert_true(acc.has_throttle_residency);
+    assert_false(acc.has_energy);
+    assert_false(acc.has_gfx_activity);
+    assert_int_equal(acc.power_residency, 10);
+    assert_int_equal(acc.temp_residency, 20);
+}
+
+static void test_amdgpu_diff_accumulators(void **state) {
+    UNUSED(state);
+    uint8_t buf[sizeof(struct gpu_metrics_v3_0)];
+    struct amdgpu_accumulators prev, cur;
+    struct amdgpu_accumulated_metrics out;
+    size_t nread;
+
+    // 500ms apart, 33W average
+    nread = read_fixture("./gpu_metrics", buf, sizeof(buf));
+    assert_true(amdgpu_get_accumulators(buf, nread, &prev));
+    nread = read_fixture("./gpu_metrics_acc", buf, sizeof(buf));
+    assert_true(amdgpu_get_accumulators(buf, nread, &cur));
+
+    assert_true(amdgpu_diff_accumulators(&prev, &cur, &out));
+    assert_true(out.has_power);
+    assert_float_equal(out.average_power_w, 33, 0.01);
+    assert_false(out.has_gfx_load);
+    assert_false(out.has_mem_load);
+    assert_false(out.has_throttling);
+
+    // timestamp didn't advance
+    assert_false(amdgpu_diff_accumulators(&cur, &cur, &out));
+    assert_false(amdgpu_diff_accumulators(&cur, &prev, &out));
+
+    // activity accumulated over 1000ms, including a counter wrap
+    prev = {};
+    prev.timestamp_ns = 1'000'000'000;
+    prev.has_gfx_activity = prev.has_mem_activity = true;
+    prev.gfx_activity = UINT32_MAX - 9'999;
+    prev.mem_activity = 0;
+    cur = prev;
+    cur.timestamp_ns = 2'000'000'000;
+    cur.gfx_activity = 40'000;
+    cur.mem_activity = 25'000;
+    assert_true(amdgpu_diff_accumulators(&prev, &cur, &out));
+    assert_false(out.has_power);
+    assert_true(out.has_gfx_load);
+    assert_int_equal(out.gfx_load_percent, 50);
+    assert_true(out.has_mem_load);
+    assert_int_equal(out.mem_load_percent, 25);
+
+    // more than 100% means the firmware isn't accumulating what we expect,
+    // which doesn't affect the memory load
+    cur.gfx_activity = 500'000;
+    assert_true(amdgpu_diff_accumulators(&prev, &cur, &out));
+    assert_false(out.has_gfx_load);
+    assert_true(out.has_mem_load);
+
+    // throttle residency only advancing for the power limits
+    prev = {};
+    prev.timestamp_ns = 1'000'000'000;
+    prev.has_throttle_residency = true;
+    prev.power_residency = 100;
+    prev.temp_residency = 100;
+    cur = prev;
+    cur.timestamp_ns = 2'000'000'000;
+    cur.power_residency = 150;
+    assert_true(amdgpu_diff_accumulators(&prev, &cur, &out));
+    assert_true(out.has_throttling);
+    assert_true(out.is_power_throttled);
+    assert_false(out.is_temp_throttled);
+}
+
+// What a polling period on the dGPU fixture ends with: the polled load is
+// kept since there's no load accumulator, the power comes from the energy
+static void test_amdgpu_apply_accumulated(void **state) {
+    UNUSED(state);
+    uint8_t buf[sizeof(struct gpu_metrics_v3_0)];
+    struct amdgpu_accumulators prev, cur;
+    struct amdgpu_accumulated_metrics accumulated;
+    struct amdgpu_common_metrics metrics {};
+    size_t nread;
+
+    metrics.gpu_load_percent = 64;
+    metrics.mem_load_percent = 12;
+    metrics.average_gfx_power_w = 100;
+    metrics.is_power_throttled = true;
+
+    nread = read_fixture("./gpu_metrics", buf, sizeof(buf));
+    assert_true(amdgpu_get_accumulators(buf, nread, &prev));
+    nread = read_fixture("./gpu_metrics_acc", buf, sizeof(buf));
+    assert_true(amdgpu_get_accumulators(buf, nread, &cur));
+
+    assert_true(amdgpu_diff_accumulators(&prev, &cur, &accumulated));
+    amdgpu_apply_accumulated(&accumulated, &metrics);
+    assert_int_equal(metrics.gpu_load_percent, 64);
+    assert_int_equal(metrics.mem_load_percent, 12);
+    assert_float_equal(metrics.average_gfx_power_w, 33, 0.01);
+    assert_true(metrics.is_power_throttled);
+}
+
+const struct CMUnitTest amdgpu_accumulators_tests[] = {
+    cmocka_unit_test(test_amdgpu_get_accumulators),
+    cmocka_unit_test(test_amdgpu_get_accumulators_v3),
+    cmocka_unit_test(test_amdgpu_diff_accumulators),
+    cmocka_unit_test(test_amdgpu_apply_accumulated)
+};
+
+int main(void) {
+    return cmocka_run_group_tests(amdgpu_accumulators_tests, NULL, NULL);
+}
@@ -0,0 +1,297 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+extern "C" {
+#include <cmocka.h>
+}
+#include "stdio.h"
+#include <chrono>
+#include <fstream>
+#include <map>
+#include "../src/gpu_fdinfo.h"
+
+#define UNUSED(x) (void)(x)
+
+static const char *fdinfo_fixtures[] = {
+    "./fdinfo/amdgpu",
+    "./fdinfo/i915",
+    "./fdinfo/xe",
+    "./fdinfo/msm",
+    "./fdinfo/panfrost",
+};
+
+static std::string read_fixture(const char *path) {
+    std::ifstream f(path);
+    return std::string(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+}
+
+static void test_fdinfo_make_key(void **state) {
+    UNUSED(state);
+    fdinfo_key key;
+
+    key = fdinfo_make_key("drm-engine-gfx");
+    assert_int_equal(key.kind, FDINFO_ENGINE);
+    assert_string_equal(key.name.c_str(), "gfx");
+
+    key = fdinfo_make_key("drm-total-cycles-rcs");
+    assert_int_equal(key.kind, FDINFO_TOTAL_CYCLES);
+    assert_string_equal(key.name.c_str(), "rcs");
+
+    key = fdinfo_make_key("drm-total-vram0");
+    assert_int_equal(key.kind, FDINFO_TOTAL);
+    assert_string_equal(key.name.c_str(), "vram0");
+
+    assert_int_equal(fdinfo_make_key("EMPTY").kind, FDINFO_NONE);
+    assert_int_equal(fdinfo_make_key("drm-engine-").kind, FDINFO_NONE);
+}
+
+static void test_fdinfo_parse(void **state) {
+    UNUSED(state);
+    fdinfo_counters c;
+    std::string buf;
+
+    buf = read_fixture("./fdinfo/amdgpu");
+    fdinfo_parse(buf.data(), buf.size(), c);
+    assert_true(c.has_client_id);
+    assert_int_equal(c.client_id, 1234);
+    assert_true(c.value(FDINFO_ENGINE, "gfx") == 93582151326ull);
+    assert_true(c.value(FDINFO_MEMORY, "vram") == 1048576ull * 1024);
+    assert_true(c.value(FDINFO_MEMORY, "gtt") == 28672ull * 1024);
+    // vendor keys are skipped
+    assert_null(c.find(FDINFO_MEMORY, "visible-vram"));
+
+    buf = read_fixture("./fdinfo/i915");
+    fdinfo_parse(buf.data(), buf.size(), c);
+    assert_true(c.value(FDINFO_ENGINE, "render") == 25662044495ull);
+    assert_true(c.value(FDINFO_RESIDENT, "system0") == 152576ull * 1024);
+    assert_non_null(c.find(FDINFO_RESIDENT, "stolen-system0"));
+    assert_null(c.find(FDINFO_RESIDENT, "local0"));
+
+    buf = read_fixture("./fdinfo/xe");
+    fdinfo_parse(buf.data(), buf.size(), c);
+    assert_int_equal(c.client_id, 42);
+    assert_int_equal(c.value(FDINFO_CYCLES, "rcs"), 28257900);
+    assert_true(c.value(FDINFO_TOTAL_CYCLES, "rcs") == 7655183225ull);
+    assert_true(c.value(FDINFO_RESIDENT, "vram0") == 786432ull * 1024);
+    assert_true(c.value(FDINFO_TOTAL, "gtt") == 9476ull * 1024);
+
+    buf = read_fixture("./fdinfo/msm");
+    fdinfo_parse(buf.data(), buf.size(), c);
+    assert_true(c.value(FDINFO_ENGINE, "gpu") == 8127361520ull);
+    assert_true(c.value(FDINFO_CYCLES, "gpu") == 4712369841ull);
+
+    buf = read_fixture("./fdinfo/panfrost");
+    fdinfo_parse(buf.data(), buf.size(), c);
+    assert_int_equal(c.value(FDINFO_ENGINE, "fragment"), 1683473960);
+    assert_int_equal(c.value(FDINFO_ENGINE, "vertex-tiler"), 324897163);
+    assert_int_equal(c.value(FDINFO_CURFREQ, "fragment"), 600000000);
+    assert_true(c.value(FDINFO_RESIDENT, "memory") == 14384ull * 1024);
+
+    // truncated read, last line is cut in the middle of the value
+    buf = read_fixture("./fdinfo/amdgpu");
+    fdinfo_parse(buf.data(), buf.find("drm-engine-dma") + 18, c);
+    assert_int_equal(c.value(FDINFO_ENGINE, "dma"), 11);
+
+    fdinfo_parse("", 0, c);
+    assert_false(c.has_client_id);
+    assert_true(c.counters.empty());
+}
+
+// The parser used before, kept here to compare against
+static void parse_fdinfo_map(std::istream& in, std::map<std::string, std::string>& out) {
+    for (std::string line; std::getline(in, line);) {
+        size_t colon = line.find(":");
+
+        if (line[0] == ' ' || line[0] == '\t')
+            continue;
+
+        if (colon == std::string::npos || colon + 2 >= line.length())
+            continue;
+
+        auto key = line.substr(0, line.find(":"));
+        auto val = line.substr(key.length() + 2);
+        out[key] = val;
+    }
+}
+
+static void test_fdinfo_parse_benchmark(void **state) {
+    UNUSED(state);
+    using namespace std::chrono;
+    const int iterations = 20000;
+
+    for (auto path : fdinfo_fixtures) {
+        std::string buf = read_fixture(path);
+        fdinfo_counters c;
+        std::map<std::string, std::string> m;
+
+        auto start = steady_clock::now();
+        for (int i = 0; i < iterations; i++)
+            fdinfo_parse(buf.data(), buf.size(), c);
+        auto typed = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+
+        start = steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            std::istringstream in(buf);
+            m.clear();
+            parse_fdinfo_map(in, m);
+        }
+        auto map = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+
+        printf("%-20s typed: %6lld ns/parse, map: %6lld ns/parse\n", path,
+               (long long)(typed / iterations), (long long)(map / iterations));
+        assert_false(c.counters.empty());
+    }
+}
+
+static void write_file(const std::string& path, const std::string& content) {
+    std::ofstream f(path, std::ios::trunc);
+    f << content;
+}
+
+static std::string xe_fdinfo(uint64_t rcs, uint64_t vcs, uint64_t total,
+                             uint64_t client_id = 42) {
+    std::ostringstream out;
+    out << "drm-driver:\txe\n"
+        << "drm-client-id:\t" << client_id << "\n"
+        << "drm-pdev:\t0000:03:00.0\n"
+        << "drm-resident-vram0:\t1024 KiB\n"
+        << "drm-cycles-rcs:\t" << rcs << "\n"
+        << "drm-total-cycles-rcs:\t" << total << "\n"
+        << "drm-cycles-vcs:\t" << vcs << "\n"
+        << "drm-total-cycles-vcs:\t" << total << "\n"
+        << "drm-engine-capacity-vcs:\t2\n";
+    return out.str();
+}
+
+static void test_fdinfo_engine_loads(void **state) {
+    UNUSED(state);
+    char root_template[] = "/tmp/mangohud-fdinfo-XXXXXX";
+    std::string root = mkdtemp(root_template);
+    std::string proc = root + "/" + std::to_string(getpid());
+
+    mkdir(proc.c_str(), 0755);
+    mkdir((proc + "/fd").c_str(), 0755);
+    mkdir((proc + "/fdinfo").c_str(), 0755);
+
+    // fd 3 is our client, fd 4 the same client again, fd 5 not a DRM fd
+    assert_int_equal(symlink("/dev/dri/renderD128", (proc + "/fd/3").c_str()), 0);
+    assert_int_equal(symlink("/dev/dri/renderD128", (proc + "/fd/4").c_str()), 0);
+    assert_int_equal(symlink("/tmp/file", (proc + "/fd/5").c_str()), 0);
+    write_file(proc + "/fdinfo/3", xe_fdinfo(1000, 0, 10000));
+    write_file(proc + "/fdinfo/4", xe_fdinfo(1000, 0, 10000));
+    write_file(proc + "/fdinfo/5", "pos:\t0\n");
+
+    GPU_fdinfo fdinfo("xe", "0000:03:00.0", "", true, root);
+    struct gpu_metrics metrics {};
+
+    assert_float_equal(fdinfo.amdgpu_helper_get_proc_vram(), 1.f / 1024, 0.00001);
+    fdinfo.get_engine_loads(&metrics);
+    assert_int_equal(metrics.engine_count, 2);
+    assert_string_equal(metrics.engine_load[0].name, "rcs");
+    assert_int_equal(metrics.engine_load[0].engine_class, GPU_ENGINE_RENDER);
+    assert_int_equal(metrics.engine_load[0].load, 0);
+
+    // rcs busy for half of the period, one of the two vcs engines fully busy
+    write_file(proc + "/fdinfo/3", xe_fdinfo(1500, 1000, 11000));
+    fdinfo.amdgpu_helper_get_proc_vram();
+    fdinfo.get_engine_loads(&metrics);
+    assert_int_equal(metrics.engine_count, 2);
+    assert_string_equal(metrics.engine_load[0].name, "rcs");
+    assert_int_equal(metrics.engine_load[0].load, 50);
+    assert_string_equal(metrics.engine_load[1].name, "vcs");
+    assert_int_equal(metrics.engine_load[1].engine_class, GPU_ENGINE_VIDEO);
+    assert_int_equal(metrics.engine_load[1].load, 50);
+
+    // new client shows up after the initial scan with a lot of busy time
+    // from before, only what it adds from its second read counts
+    assert_int_equal(symlink("/dev/dri/renderD128", (proc + "/fd/6").c_str()), 0);
+    write_file(proc + "/fdinfo/6", xe_fdinfo(5'000'000, 0, 12000, 43));
+    write_file(proc + "/fdinfo/3", xe_fdinfo(2000, 1000, 12000));
+    assert_float_equal(fdinfo.amdgpu_helper_get_proc_vram(), 2.f / 1024, 0.00001);
+    fdinfo.get_engine_loads(&metrics);
+    assert_string_equal(metrics.engine_load[0].name, "rcs");
+    assert_int_equal(metrics.engine_load[0].load, 50);
+
+    write_file(proc + "/fdinfo/6", xe_fdinfo(5'000'250, 0, 13000, 43));
+    write_file(proc + "/fdinfo/3", xe_fdinfo(2000, 1000, 13000));
+    fdinfo.amdgpu_helper_get_proc_vram();
+    fdinfo.get_engine_loads(&metrics);
+    assert_int_equal(metrics.engine_load[0].load, 25);
+
+    // fd 6 gets closed and its number reused by a plain file, while fd 5
+    // now is a DRM client. fd 5 is neither a hole nor above the highest fd,
+    // only the full rescan the reuse triggers finds it.
+    unlink((proc + "/fd/5").c_str());
+    unlink((proc + "/fd/6").c_str());
+    assert_int_equal(symlink("/dev/dri/renderD128", (proc + "/fd/5").c_str()), 0);
+    assert_int_equal(symlink("/tmp/file", (proc + "/fd/6").c_str()), 0);
+    write_file(proc + "/fdinfo/5", xe_fdinfo(0, 0, 13000, 44));
+    write_file(proc + "/fdinfo/6", "pos:\t0\n");
+    assert_float_equal(fdinfo.amdgpu_helper_get_proc_vram(), 1.f / 1024, 0.00001);
+    assert_float_equal(fdinfo.amdgpu_helper_get_proc_vram(), 2.f / 1024, 0.00001);
+    assert_float_equal(fdinfo.amdgpu_helper_get_proc_vram(), 2.f / 1024, 0.00001);
+
+    ghc::filesystem::remove_all(root);
+}
+
+static void test_intel_gt(void **state) {
+    UNUSED(state);
+    const uint64_t ms = 1'000'000;
+    char root_template[] = "/tmp/mangohud-gt-XXXXXX";
+    std::string root = mkdtemp(root_template);
+
+    std::string i915 = root + "/i915/gt/gt0";
+    ghc::filesystem::create_directories(i915);
+    write_file(i915 + "/rps_act_freq_mhz", "650\n");
+    write_file(i915 + "/rps_cur_freq_mhz", "1100\n");
+    write_file(i915 + "/rc6_residency_ms", "10000\n");
+
+    intel_gt gt("i915", i915);
+    assert_int_equal(gt.actual_freq(), 650);
+    assert_int_equal(gt.requested_freq(), 1100);
+    assert_int_equal(gt.idle_residency(1000 * ms), -1);
+
+    // 250ms of RC6 in the next 500ms
+    write_file(i915 + "/rc6_residency_ms", "10250\n");
+    assert_int_equal(gt.idle_residency(1500 * ms), 50);
+    write_file(i915 + "/rc6_residency_ms", "10750\n");
+    assert_int_equal(gt.idle_residency(2000 * ms), 100);
+    write_file(i915 + "/rps_act_freq_mhz", "1100\n");
+    assert_int_equal(gt.actual_freq(), 1100);
+
+    // xe keeps the same counters under freq0 and gtidle
+    std::string xe = root + "/xe/tile0/gt0";
+    ghc::filesystem::create_directories(xe + "/freq0");
+    ghc::filesystem::create_directories(xe + "/gtidle");
+    write_file(xe + "/freq0/act_freq", "300\n");
+    write_file(xe + "/freq0/cur_freq", "2050\n");
+    write_file(xe + "/gtidle/idle_residency_ms", "5\n");
+
+    intel_gt xe_gt("xe", xe);
+    assert_int_equal(xe_gt.actual_freq(), 300);
+    assert_int_equal(xe_gt.requested_freq(), 2050);
+    xe_gt.idle_residency(1000 * ms);
+    write_file(xe + "/gtidle/idle_residency_ms", "105\n");
+    assert_int_equal(xe_gt.idle_residency(2000 * ms), 10);
+
+    // nothing exposed, older kernels or discrete cards without RC6
+    intel_gt missing("xe", root + "/none");
+    assert_false(missing.has_idle_residency());
+    assert_int_equal(missing.requested_freq(), -1);
+    assert_int_equal(missing.idle_residency(1000 * ms), -1);
+
+    ghc::filesystem::remove_all(root);
+}
+
+const struct CMUnitTest fdinfo_tests[] = {
+    cmocka_unit_test(test_fdinfo_make_key),
+    cmocka_unit_test(test_fdinfo_parse),
+    cmocka_unit_test(test_fdinfo_parse_benchmark),
+    cmocka_unit_test(test_fdinfo_engine_loads),
+    cmocka_unit_test(test_intel_gt)
+};
+
+int main(void) {
+    return cmocka_run_group_tests(fdinfo_tests, NULL, NULL);
+}
@@ -0,0 +1,281 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+extern "C" {
+#include <cmocka.h>
+}
+#include "stdio.h"
+#include <thread>
+#include <vector>
+#include "../src/gpu_metrics_util.h"
+
+#define UNUSED(x) (void)(x)
+
+static void fill_metrics(struct gpu_metrics& m, int value) {
+    m.load = value;
+    m.temp = value;
+    m.powerUsage = value;
+    m.throttle_status = value;
+    m.apu_core_count = value;
+    for (auto& t : m.apu_core_temp)
+        t = value;
+    for (auto& c : m.apu_core_clock)
+        c = value;
+    for (auto& e : m.engine_load)
+        e.load = value;
+}
+
+static bool metrics_consistent(const struct gpu_metrics& m) {
+    int value = m.load;
+
+    if (m.temp != value || m.powerUsage != value ||
+        m.throttle_status != static_cast<uint64_t>(value) || m.apu_core_count != value)
+        return false;
+
+    for (auto t : m.apu_core_temp)
+        if (t != value)
+            return false;
+
+    for (auto c : m.apu_core_clock)
+        if (c != value)
+            return false;
+
+    for (auto& e : m.engine_load)
+        if (e.load != value)
+            return false;
+
+    return true;
+}
+
+static void test_metrics_snapshot_initial(void **state) {
+    UNUSED(state);
+    metrics_snapshot<gpu_metrics> snapshot;
+    struct gpu_metrics m = snapshot.load();
+
+    assert_int_equal(m.load, 0);
+    assert_int_equal(m.mem_load, -1);
+    assert_int_equal(snapshot.version(), 1);
+
+    fill_metrics(m, 42);
+    snapshot.store(m);
+    assert_int_equal(snapshot.version(), 2);
+    assert_int_equal(snapshot.load().load, 42);
+    assert_true(metrics_consistent(snapshot.load()));
+}
+
+// One sampler publishing as fast as it can while the HUD, logger and
+// others read, none of them may ever see a half written snapshot
+static void test_metrics_snapshot_stress(void **state) {
+    UNUSED(state);
+    const int stores = 200000;
+    const int readers = 4;
+
+    metrics_snapshot<gpu_metrics> snapshot;
+    std::atomic<bool> done {false};
+    std::atomic<int> torn {0};
+    std::atomic<int> went_back {0};
+    std::vector<std::thread> threads;
+
+    for (int r = 0; r < readers; r++) {
+        threads.emplace_back([&]() {
+            int last = 0;
+
+            while (!done) {
+                auto m = snapshot.load();
+
+                if (!metrics_consistent(m))
+                    torn++;
+
+                if (m.load < last)
+                    went_back++;
+
+                last = m.load;
+            }
+        });
+    }
+
+    struct gpu_metrics m;
+    for (int i = 1; i <= stores; i++) {
+        fill_metrics(m, i);
+        snapshot.store(m);
+    }
+
+    done = true;
+    for (auto& t : threads)
+        t.join();
+
+    assert_int_equal(torn, 0);
+    assert_int_equal(went_back, 0);
+    assert_int_equal(snapshot.load().load, stores);
+}
+
+static void back_off(adaptive_sampler& sampler, const sampler_reading& reading) {
+    for (int update = 0; update < 10; update++) {
+        for (size_t i = 0; i < sampler.samples_per_update(); i++)
+            sampler.add_sample(reading);
+        sampler.end_update();
+    }
+}
+
+static void test_adaptive_sampler(void **state) {
+    UNUSED(state);
+    adaptive_sampler sampler;
+    const sampler_reading flat { 50, 100, 60, 0 };
+
+    assert_int_equal(sampler.poll_period_ms(), METRICS_POLLING_PERIOD_MS);
+    assert_int_equal(sampler.samples_per_update(), METRICS_SAMPLE_COUNT);
+
+    // flat readings back off until there is one read per update
+    back_off(sampler, flat);
+    assert_int_equal(sampler.poll_period_ms(), METRICS_UPDATE_PERIOD_MS);
+    assert_int_equal(sampler.samples_per_update(), 1);
+    assert_float_equal(sampler.rate_hz(), 2, 0.001);
+
+    // a load transition goes back to full rate
+    sampler.add_sample({ 95, 100, 60, 0 });
+    assert_true(sampler.end_update());
+    assert_int_equal(sampler.poll_period_ms(), METRICS_POLLING_PERIOD_MS);
+
+    // noisy load stays at full rate
+    for (size_t i = 0; i < sampler.samples_per_update(); i++)
+        sampler.add_sample({ i % 2 ? 80.f : 100.f, 100, 60, 0 });
+    assert_false(sampler.end_update());
+
+    // so does a power or temperature jump with a flat load
+    back_off(sampler, flat);
+    sampler.add_sample({ 50, 150, 60, 0 });
+    assert_true(sampler.end_update());
+    back_off(sampler, flat);
+    sampler.add_sample({ 50, 100, 70, 0 });
+    assert_true(sampler.end_update());
+
+    // the throttle bits are only OR'ed at full rate
+    back_off(sampler, flat);
+    sampler.add_sample({ 50, 100, 60, 1 });
+    assert_true(sampler.end_update());
+    back_off(sampler, { 50, 100, 60, 1 });
+    assert_int_equal(sampler.poll_period_ms(), METRICS_POLLING_PERIOD_MS);
+
+    // and the period they clear in too
+    for (size_t i = 0; i < sampler.samples_per_update(); i++)
+        sampler.add_sample(flat);
+    assert_false(sampler.end_update());
+    back_off(sampler, flat);
+    assert_int_equal(sampler.poll_period_ms(), METRICS_UPDATE_PERIOD_MS);
+
+    // longer fps_sampling_period never needs more than METRICS_SAMPLE_COUNT samples
+    sampler.set_update_period_ms(2000);
+    assert_int_equal(sampler.update_period_ms(), 2000);
+    sampler.add_sample({ 95, 100, 60, 0 });
+    sampler.end_update();
+    assert_int_equal(sampler.samples_per_update(), METRICS_SAMPLE_COUNT);
+
+    sampler.set_update_period_ms(0);
+    assert_int_equal(sampler.update_period_ms(), METRICS_POLLING_PERIOD_MS);
+    assert_int_equal(sampler.samples_per_update(), 1);
+
+    // the requested period is only picked up by the sampler thread
+    sampler.request_update_period_ms(1000);
+    assert_int_equal(sampler.update_period_ms(), METRICS_POLLING_PERIOD_MS);
+    sampler.apply_requested_period();
+    assert_int_equal(sampler.update_period_ms(), 1000);
+}
+
+static void test_sample_age(void **state) {
+    UNUSED(state);
+    struct gpu_metrics m;
+
+    assert_int_equal(m.timestamp_ns, 0);
+    assert_float_equal(sample_age_ms(5'000'000'000, m.timestamp_ns), -1, 0.001);
+
+    m.timestamp_ns = 4'750'000'000;
+    assert_float_equal(sample_age_ms(5'000'000'000, m.timestamp_ns), 250, 0.001);
+
+    // stamped by the sampler after the reader took its time
+    assert_float_equal(sample_age_ms(4'700'000'000, m.timestamp_ns), 0, 0.001);
+
+    metrics_snapshot<gpu_metrics> snapshot;
+    snapshot.store(m);
+    assert_true(snapshot.load().timestamp_ns == 4'750'000'000);
+}
+
+static void test_throttling_episodes(void **state) {
+    UNUSED(state);
+    const uint64_t ms = 1'000'000;
+    Throttling thr;
+    struct gpu_metrics m;
+
+    thr.update();
+    assert_false(thr.power_throttling());
+
+    m.is_power_throttled = true;
+    thr.set_reasons(gpu_throttle_reasons(m), 1000 * ms);
+    thr.update();
+    thr.update();
+    assert_true(thr.power_throttling());
+    assert_false(thr.thermal_throttling());
+
+    // the open episode counts up to the time it is read at
+    throttle_episodes power = thr.episodes(THROTTLE_POWER, 1800 * ms);
+    assert_int_equal(power.count, 1);
+    assert_true(power.throttled);
+    assert_true(power.total_ns == 800 * ms);
+    throttle_episodes log_start = power;
+
+    m.is_power_throttled = false;
+    m.is_temp_throttled = true;
+    thr.set_reasons(gpu_throttle_reasons(m), 2000 * ms);
+    thr.update();
+
+    m.is_power_throttled = true;
+    thr.set_reasons(gpu_throttle_reasons(m), 3000 * ms);
+    thr.update();
+    thr.update();
+
+    power = thr.episodes(THROTTLE_POWER, 3500 * ms);
+    assert_int_equal(power.count, 2);
+    assert_true(power.total_ns == 1500 * ms);
+    assert_int_equal(thr.episodes(THROTTLE_THERMAL, 3500 * ms).count, 1);
+    assert_int_equal(thr.episodes(THROTTLE_CURRENT, 3500 * ms).count, 0);
+
+    // a log started in the middle of the first episode
+    throttle_episodes since = throttle_episodes_since(log_start, power);
+    assert_int_equal(since.count, 2);
+    assert_true(since.total_ns == 700 * ms);
+
+    // history wraps around without losing track of the throttled entries
+    thr.set_reasons(0, 4000 * ms);
+    for (int i = 0; i < Throttling::history_size - 1; i++)
+        thr.update();
+    assert_true(thr.power_throttling());
+    assert_float_equal(thr.power[thr.history_offset], 0.1f, 0.001);
+    thr.update();
+    assert_false(thr.power_throttling());
+    assert_false(thr.thermal_throttling());
+
+    // an episode between two HUD updates is counted and graphed
+    thr.set_reasons(1 << THROTTLE_POWER, 5000 * ms);
+    thr.set_reasons(0, 5010 * ms);
+    power = thr.episodes(THROTTLE_POWER, 6000 * ms);
+    assert_int_equal(power.count, 3);
+    assert_false(power.throttled);
+    assert_true(power.total_ns == 2010 * ms);
+    thr.update();
+    assert_true(thr.power_throttling());
+    thr.update();
+    assert_float_equal(thr.power[(thr.history_offset + Throttling::history_size - 1) % Throttling::history_size],
+                       0.0f, 0.001);
+}
+
+const struct CMUnitTest gpu_metrics_tests[] = {
+    cmocka_unit_test(test_metrics_snapshot_initial),
+    cmocka_unit_test(test_metrics_snapshot_stress),
+    cmocka_unit_test(test_adaptive_sampler),
+    cmocka_unit_test(test_sample_age),
+    cmocka_unit_test(test_throttling_episodes)
+};
+
+int main(void) {
+    return cmocka_run_group_tests(gpu_metrics_tests, NULL, NULL);
+}
@@ -0,0 +1,208 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+extern "C" {
+#include <cmocka.h>
+}
+#include "stdio.h"
+#include <dlfcn.h>
+#include "../src/nvml_samples.h"
+
+#define UNUSED(x) (void)(x)
+
+static const char *stub_path = "./libnvidia-ml-stub.so";
+
+static void* stub_sym(const char *name) {
+    void *handle = dlopen(stub_path, RTLD_LAZY | RTLD_NOLOAD);
+    assert_non_null(handle);
+    void *sym = dlsym(handle, name);
+    dlclose(handle);
+    assert_non_null(sym);
+    return sym;
+}
+
+static void set_samples(nvmlSamplingType_t type, const nvmlSample_t* s, unsigned int count) {
+    auto fn = reinterpret_cast<void (*)(nvmlSamplingType_t, const nvmlSample_t*, unsigned int)>(
+        stub_sym("nvml_stub_set_samples"));
+    fn(type, s, count);
+}
+
+static void set_process_samples(const nvmlProcessUtilizationSample_t* s, unsigned int count) {
+    auto fn = reinterpret_cast<void (*)(const nvmlProcessUtilizationSample_t*, unsigned int)>(
+        stub_sym("nvml_stub_set_process_samples"));
+    fn(s, count);
+}
+
+static void set_samples_supported(bool supported) {
+    auto fn = reinterpret_cast<void (*)(bool)>(stub_sym("nvml_stub_set_samples_supported"));
+    fn(supported);
+}
+
+static nvmlSample_t sample(unsigned long long ts, unsigned int value) {
+    nvmlSample_t s {};
+    s.timeStamp = ts;
+    s.sampleValue.uiVal = value;
+    return s;
+}
+
+static void test_nvml_read_samples(void **state) {
+    auto nvml = static_cast<libnvml_loader*>(*state);
+    unsigned long long last_seen = 0;
+    nvml_sample_stats stats;
+
+    // a short burst between two polls still shows up
+    nvmlSample_t burst[] = { sample(100, 10), sample(200, 100), sample(300, 10), sample(400, 0) };
+    set_samples(NVML_GPU_UTILIZATION_SAMPLES, burst, 4);
+
+    assert_int_equal(nvml_read_samples(*nvml, nullptr, NVML_GPU_UTILIZATION_SAMPLES, last_seen, stats), NVML_SUCCESS);
+    assert_int_equal(stats.count, 4);
+    assert_float_equal(stats.avg, 30, 0.001);
+    assert_float_equal(stats.max, 100, 0.001);
+    assert_true(last_seen == 400);
+
+    // nothing new since the last read
+    assert_int_equal(nvml_read_samples(*nvml, nullptr, NVML_GPU_UTILIZATION_SAMPLES, last_seen, stats), NVML_ERROR_NOT_FOUND);
+    assert_true(last_seen == 400);
+
+    nvmlSample_t more[] = { sample(300, 10), sample(400, 0), sample(500, 60), sample(600, 80) };
+    set_samples(NVML_GPU_UTILIZATION_SAMPLES, more, 4);
+    assert_int_equal(nvml_read_samples(*nvml, nullptr, NVML_GPU_UTILIZATION_SAMPLES, last_seen, stats), NVML_SUCCESS);
+    assert_int_equal(stats.count, 2);
+    assert_float_equal(stats.avg, 70, 0.001);
+    assert_true(last_seen == 600);
+
+    // other sampling types keep their own buffer
+    unsigned long long clock_seen = 0;
+    nvmlSample_t clocks[] = { sample(150, 1500), sample(250, 1900) };
+    set_samples(NVML_PROCESSOR_CLK_SAMPLES, clocks, 2);
+    assert_int_equal(nvml_read_samples(*nvml, nullptr, NVML_PROCESSOR_CLK_SAMPLES, clock_seen, stats), NVML_SUCCESS);
+    assert_float_equal(stats.avg, 1700, 0.001);
+}
+
+static void test_nvml_update_sample_buffer(void **state) {
+    auto nvml = static_cast<libnvml_loader*>(*state);
+    nvml_sample_buffer load {NVML_MEMORY_UTILIZATION_SAMPLES};
+    const uint64_t s = 1'000'000'000;
+
+    nvmlSample_t samples[] = { sample(100, 20), sample(200, 40) };
+    set_samples(NVML_MEMORY_UTILIZATION_SAMPLES, samples, 2);
+    assert_true(nvml_update_sample_buffer(*nvml, nullptr, load, 10 * s));
+    assert_float_equal(load.avg, 30, 0.001);
+
+    // the driver hasn't sampled again yet
+    assert_true(nvml_update_sample_buffer(*nvml, nullptr, load, 10 * s + s / 2));
+    assert_float_equal(load.avg, 30, 0.001);
+
+    // or stopped sampling, the instant value is shown instead
+    assert_false(nvml_update_sample_buffer(*nvml, nullptr, load, 12 * s));
+    assert_float_equal(load.avg, -1, 0.001);
+
+    nvmlSample_t more[] = { sample(300, 50) };
+    set_samples(NVML_MEMORY_UTILIZATION_SAMPLES, more, 1);
+    assert_true(nvml_update_sample_buffer(*nvml, nullptr, load, 13 * s));
+    assert_float_equal(load.avg, 50, 0.001);
+}
+
+static void test_nvml_sample_buffer_unsupported(void **state) {
+    auto nvml = static_cast<libnvml_loader*>(*state);
+    nvml_sample_buffer load {NVML_MEMORY_UTILIZATION_SAMPLES};
+    nvml_sample_buffer clock {NVML_PROCESSOR_CLK_SAMPLES};
+
+    set_samples_supported(false);
+    assert_false(nvml_update_sample_buffer(*nvml, nullptr, load, 1));
+    assert_false(load.supported);
+    set_samples_supported(true);
+
+    // only the sampling type that failed is disabled
+    nvmlSample_t clocks[] = { sample(100, 1500) };
+    set_samples(NVML_PROCESSOR_CLK_SAMPLES, clocks, 1);
+    assert_true(nvml_update_sample_buffer(*nvml, nullptr, clock, 1));
+    assert_float_equal(clock.avg, 1500, 0.001);
+
+    nvmlSample_t samples[] = { sample(100, 20) };
+    set_samples(NVML_MEMORY_UTILIZATION_SAMPLES, samples, 1);
+    assert_false(nvml_update_sample_buffer(*nvml, nullptr, load, 1));
+}
+
+static void test_nvml_read_process_load(void **state) {
+    auto nvml = static_cast<libnvml_loader*>(*state);
+    unsigned long long last_seen = 0;
+    nvml_process_load load;
+
+    assert_int_equal(nvml_read_process_load(*nvml, nullptr, 42, last_seen, load), NVML_ERROR_NOT_FOUND);
+    assert_int_equal(load.sm, -1);
+
+    nvmlProcessUtilizationSample_t procs[3] {};
+    procs[0].pid = 42; procs[0].timeStamp = 100; procs[0].smUtil = 35; procs[0].memUtil = 12;
+    procs[1].pid = 7;  procs[1].timeStamp = 120; procs[1].smUtil = 60; procs[1].memUtil = 30;
+    procs[2].pid = 42; procs[2].timeStamp = 110; procs[2].smUtil = 40; procs[2].memUtil = 10;
+    set_process_samples(procs, 3);
+
+    // only the game's share of the GPU, not the whole device
+    assert_int_equal(nvml_read_process_load(*nvml, nullptr, 42, last_seen, load), NVML_SUCCESS);
+    assert_int_equal(load.sm, 40);
+    assert_int_equal(load.mem, 12);
+    assert_true(last_seen == 120);
+
+    // no new sample keeps the last reading
+    assert_int_equal(nvml_read_process_load(*nvml, nullptr, 42, last_seen, load), NVML_ERROR_NOT_FOUND);
+    assert_int_equal(load.sm, 40);
+
+    // another process busy, the game idle
+    procs[0].timeStamp = 50;
+    procs[1].timeStamp = 200;
+    procs[2].timeStamp = 60;
+    set_process_samples(procs, 3);
+    assert_int_equal(nvml_read_process_load(*nvml, nullptr, 42, last_seen, load), NVML_SUCCESS);
+    assert_int_equal(load.sm, 0);
+    assert_int_equal(load.mem, 0);
+    assert_true(last_seen == 200);
+}
+
+static void test_nvml_missing_symbols(void **state) {
+    auto nvml = static_cast<libnvml_loader*>(*state);
+    auto get_samples = nvml->nvmlDeviceGetSamples;
+    auto get_process_utilization = nvml->nvmlDeviceGetProcessUtilization;
+    unsigned long long last_seen = 0;
+    nvml_sample_stats stats;
+    nvml_process_load load;
+
+    // older drivers, the backend falls back to the instant values
+    nvml->nvmlDeviceGetSamples = nullptr;
+    nvml->nvmlDeviceGetProcessUtilization = nullptr;
+    assert_int_equal(nvml_read_samples(*nvml, nullptr, NVML_GPU_UTILIZATION_SAMPLES, last_seen, stats), NVML_ERROR_NOT_SUPPORTED);
+    assert_int_equal(nvml_read_process_load(*nvml, nullptr, 42, last_seen, load), NVML_ERROR_NOT_SUPPORTED);
+    assert_int_equal(load.sm, -1);
+
+    nvml->nvmlDeviceGetSamples = get_samples;
+    nvml->nvmlDeviceGetProcessUtilization = get_process_utilization;
+}
+
+static int setup(void **state) {
+    auto nvml = new libnvml_loader(stub_path);
+    if (!nvml->IsLoaded()) {
+        fprintf(stderr, "failed to load %s\n", stub_path);
+        delete nvml;
+        return -1;
+    }
+    *state = nvml;
+    return 0;
+}
+
+static int teardown(void **state) {
+    delete static_cast<libnvml_loader*>(*state);
+    return 0;
+}
+
+const struct CMUnitTest nvml_tests[] = {
+    cmocka_unit_test(test_nvml_read_samples),
+    cmocka_unit_test(test_nvml_update_sample_buffer),
+    cmocka_unit_test(test_nvml_sample_buffer_unsupported),
+    cmocka_unit_test(test_nvml_read_process_load),
+    cmocka_unit_test(test_nvml_missing_symbols)
+};
+
+int main(void) {
+    return cmocka_run_group_tests(nvml_tests, setup, teardown);
+}
@@ -0,0 +1,208 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+extern "C" {
+#include <cmocka.h>
+}
+#include "stdio.h"
+#include <chrono>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "../src/vk_object_map.h"
+
+#define UNUSED(x) (void)(x)
+
+// handles look like heap pointers
+static uint64_t handle(int i) {
+    return 0x7f0000001000ull + uint64_t(i) * 0x40;
+}
+
+static void *data_of(int i) {
+    return reinterpret_cast<void *>(uintptr_t(i + 1) * 8);
+}
+
+static void test_object_map_basic(void **state) {
+    UNUSED(state);
+    vk_object_map map(16);
+
+    assert_null(map.find(0));
+    assert_null(map.find(handle(1)));
+
+    // enough to go through a few rebuilds
+    for (int i = 0; i < 1000; i++)
+        map.insert(handle(i), data_of(i));
+    assert_int_equal(map.size(), 1000);
+
+    for (int i = 0; i < 1000; i++)
+        assert_true(map.find(handle(i)) == data_of(i));
+
+    for (int i = 0; i < 1000; i += 2)
+        map.erase(handle(i));
+    assert_int_equal(map.size(), 500);
+
+    for (int i = 0; i < 1000; i++)
+        assert_true(map.find(handle(i)) == (i % 2 ? data_of(i) : nullptr));
+
+    // drivers hand the same handle out again after a destroy
+    map.insert(handle(0), data_of(5000));
+    assert_true(map.find(handle(0)) == data_of(5000));
+    map.insert(handle(0), data_of(6000));
+    assert_true(map.find(handle(0)) == data_of(6000));
+    assert_int_equal(map.size(), 501);
+
+    map.erase(handle(0));
+    map.erase(handle(0));
+    map.erase(handle(2000));
+    assert_int_equal(map.size(), 500);
+}
+
+// Command buffers being allocated and freed by one thread while others
+// keep looking up their queues: the queues must always be found
+static void test_object_map_churn(void **state) {
+    UNUSED(state);
+    const int queues = 8;
+    const int readers = 4;
+    vk_object_map map(16);
+    std::atomic<bool> done {false};
+    std::atomic<int> missing {0};
+    std::atomic<int> wrong {0};
+    std::vector<std::thread> threads;
+
+    for (int q = 0; q < queues; q++)
+        map.insert(handle(q), data_of(q));
+
+    for (int r = 0; r < readers; r++) {
+        threads.emplace_back([&, r]() {
+            while (!done.load(std::memory_order_relaxed)) {
+                for (int q = 0; q < queues; q++) {
+                    void *data = map.find(handle(q));
+                    if (!data)
+                        missing++;
+                    else if (data != data_of(q))
+                        wrong++;
+                }
+                // freed command buffers are either gone or still theirs
+                int cb = 1000 + (r * 7919) % 20000;
+                void *data = map.find(handle(cb));
+                if (data && data != data_of(cb))
+                    wrong++;
+            }
+        });
+    }
+
+    for (int round = 0; round < 20; round++) {
+        for (int i = 1000; i < 21000; i++)
+            map.insert(handle(i), data_of(i));
+        for (int i = 1000; i < 21000; i++)
+            map.erase(handle(i));
+    }
+    done = true;
+
+    for (auto& t : threads)
+        t.join();
+
+    assert_int_equal(missing.load(), 0);
+    assert_int_equal(wrong.load(), 0);
+    assert_int_equal(map.size(), queues);
+
+    // nobody is looking anything up anymore, the next write frees them all
+    map.erase(handle(queues));
+    assert_int_equal(map.table_count(), 1);
+}
+
+// Command buffers allocated and freed every frame for hours: the tables
+// replaced along the way must not pile up
+static void test_object_map_reclaim(void **state) {
+    UNUSED(state);
+    const int live = 150;
+    vk_object_map map(16);
+
+    for (int i = 0; i < live; i++)
+        map.insert(handle(i), data_of(i));
+
+    for (int i = 0; i < 1000000; i++) {
+        int cb = live + i;
+        map.insert(handle(cb), data_of(cb));
+        map.erase(handle(cb));
+        if (i % 100000 == 0)
+            assert_true(map.table_count() <= 2);
+    }
+    assert_true(map.table_count() <= 2);
+    assert_int_equal(map.size(), live);
+    for (int i = 0; i < live; i++)
+        assert_true(map.find(handle(i)) == data_of(i));
+}
+
+// Several threads submitting, each looking up its queue and command
+// buffers, as the layer does for every vkQueueSubmit
+template <typename Find>
+static long long lookups_per_thread_ns(int thread_count, int iterations, Find find) {
+    std::vector<std::thread> threads;
+    std::atomic<int> ready {0};
+    std::atomic<bool> go {false};
+    std::atomic<long long> total_ns {0};
+
+    for (int t = 0; t < thread_count; t++) {
+        threads.emplace_back([&, t]() {
+            ready++;
+            while (!go)
+                ;
+            auto start = std::chrono::steady_clock::now();
+            uintptr_t sum = 0;
+            for (int i = 0; i < iterations; i++)
+                sum += reinterpret_cast<uintptr_t>(find(handle(t * 64 + i % 64)));
+            auto end = std::chrono::steady_clock::now();
+            total_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+            assert_true(sum != 0);
+        });
+    }
+
+    while (ready != thread_count)
+        ;
+    go = true;
+    for (auto& t : threads)
+        t.join();
+
+    return total_ns / thread_count / iterations;
+}
+
+static void test_object_map_benchmark(void **state) {
+    UNUSED(state);
+    const int iterations = 200000;
+    const int max_threads = 8;
+
+    std::mutex lock;
+    std::unordered_map<uint64_t, void *> locked_map;
+    vk_object_map map;
+
+    for (int i = 0; i < max_threads * 64; i++) {
+        locked_map[handle(i)] = data_of(i);
+        map.insert(handle(i), data_of(i));
+    }
+
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        long long locked = lookups_per_thread_ns(threads, iterations, [&](uint64_t key) {
+            std::lock_guard<std::mutex> lk(lock);
+            return locked_map[key];
+        });
+        long long lock_free = lookups_per_thread_ns(threads, iterations, [&](uint64_t key) {
+            return map.find(key);
+        });
+
+        printf("%d submit threads: mutex: %4lld ns/lookup, vk_object_map: %4lld ns/lookup\n",
+               threads, locked, lock_free);
+    }
+}
+
+const struct CMUnitTest object_map_tests[] = {
+    cmocka_unit_test(test_object_map_basic),
+    cmocka_unit_test(test_object_map_churn),
+    cmocka_unit_test(test_object_map_reclaim),
+    cmocka_unit_test(test_object_map_benchmark)
+};
+
+int main(void) {
+    return cmocka_run_group_tests(object_map_tests, NULL, NULL);
+}